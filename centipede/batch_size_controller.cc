@@ -0,0 +1,54 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./centipede/batch_size_controller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/log/check.h"
+#include "absl/time/time.h"
+
+namespace centipede {
+
+BatchSizeController::BatchSizeController(size_t initial_batch_size,
+                                         size_t max_batch_size,
+                                         absl::Duration target_time)
+    : max_batch_size_{max_batch_size},
+      target_time_{target_time},
+      batch_size_{initial_batch_size} {
+  CHECK_GE(initial_batch_size, 1);
+  CHECK_LE(initial_batch_size, max_batch_size);
+  CHECK_GE(target_time, absl::ZeroDuration());
+}
+
+void BatchSizeController::Observe(size_t num_inputs, absl::Duration time) {
+  if (target_time_ == absl::ZeroDuration() || num_inputs == 0) return;
+  // Never let the average drop to zero, which means "no observations".
+  const absl::Duration time_per_input = std::max(
+      time / static_cast<int64_t>(num_inputs), absl::Nanoseconds(1));
+  time_per_input_ = time_per_input_ == absl::ZeroDuration()
+                        ? time_per_input
+                        : (time_per_input_ * 3 + time_per_input) / 4;
+  const double ideal_batch_size =
+      absl::FDivDuration(target_time_, time_per_input_);
+  const double new_batch_size = std::clamp(
+      ideal_batch_size, batch_size_ / 2.0, batch_size_ * 2.0);
+  batch_size_ =
+      std::clamp<size_t>(std::llround(new_batch_size), 1, max_batch_size_);
+}
+
+}  // namespace centipede
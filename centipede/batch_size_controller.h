@@ -0,0 +1,56 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CENTIPEDE_BATCH_SIZE_CONTROLLER_H_
+#define THIRD_PARTY_CENTIPEDE_BATCH_SIZE_CONTROLLER_H_
+
+#include <cstddef>
+
+#include "absl/time/time.h"
+
+namespace centipede {
+
+// Picks the number of inputs per batch so that executing a batch takes about
+// `target_time` of wall time. Cheap targets get larger batches, amortizing the
+// fixed cost of a batch (process start-up, shared memory setup, etc.), and
+// slow targets get smaller ones, staying away from `--timeout_per_batch`.
+//
+// The batch size is derived from a moving average of the observed wall time
+// per input, and changes by at most 2x per observation to dampen the noise.
+class BatchSizeController {
+ public:
+  // Starts with `initial_batch_size` and keeps the batch size in
+  // [1, `max_batch_size`]. With a zero `target_time`, the batch size stays at
+  // `initial_batch_size`.
+  BatchSizeController(size_t initial_batch_size, size_t max_batch_size,
+                      absl::Duration target_time);
+
+  // Returns the number of inputs to put in the next batch.
+  size_t batch_size() const { return batch_size_; }
+
+  // Adjusts the batch size after a batch of `num_inputs` took `time` to run.
+  void Observe(size_t num_inputs, absl::Duration time);
+
+ private:
+  const size_t max_batch_size_;
+  const absl::Duration target_time_;
+  size_t batch_size_;
+  // The moving average of the wall time per input, or zero before the first
+  // observation.
+  absl::Duration time_per_input_ = absl::ZeroDuration();
+};
+
+}  // namespace centipede
+
+#endif  // THIRD_PARTY_CENTIPEDE_BATCH_SIZE_CONTROLLER_H_
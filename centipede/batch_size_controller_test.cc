@@ -0,0 +1,87 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./centipede/batch_size_controller.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace centipede {
+namespace {
+
+// Returns the wall time of a batch of `num_inputs` for a target with a fixed
+// cost of `overhead` per batch and `time_per_input` per input.
+absl::Duration BatchTime(size_t num_inputs, absl::Duration overhead,
+                         absl::Duration time_per_input) {
+  return overhead + time_per_input * static_cast<int64_t>(num_inputs);
+}
+
+TEST(BatchSizeControllerTest, KeepsBatchSizeWithoutTargetTime) {
+  BatchSizeController controller{/*initial_batch_size=*/100,
+                                 /*max_batch_size=*/1000,
+                                 /*target_time=*/absl::ZeroDuration()};
+  controller.Observe(100, absl::Milliseconds(1));
+  controller.Observe(100, absl::Seconds(100));
+  EXPECT_EQ(controller.batch_size(), 100);
+}
+
+TEST(BatchSizeControllerTest, GrowsBatchesOfCheapInputs) {
+  BatchSizeController controller{/*initial_batch_size=*/100,
+                                 /*max_batch_size=*/100000,
+                                 /*target_time=*/absl::Seconds(1)};
+  for (int i = 0; i < 50; ++i) {
+    const size_t batch_size = controller.batch_size();
+    controller.Observe(batch_size,
+                       BatchTime(batch_size, absl::Milliseconds(100),
+                                 absl::Microseconds(100)));
+  }
+  // 100ms + 9000 * 100us = 1s.
+  EXPECT_NEAR(controller.batch_size(), 9000, 100);
+}
+
+TEST(BatchSizeControllerTest, ShrinksBatchesOfSlowInputs) {
+  BatchSizeController controller{/*initial_batch_size=*/1000,
+                                 /*max_batch_size=*/1000,
+                                 /*target_time=*/absl::Seconds(10)};
+  size_t prev_batch_size = controller.batch_size();
+  for (int i = 0; i < 50; ++i) {
+    const size_t batch_size = controller.batch_size();
+    controller.Observe(batch_size, BatchTime(batch_size, absl::ZeroDuration(),
+                                             absl::Milliseconds(500)));
+    // Changes by at most 2x per batch.
+    EXPECT_GE(controller.batch_size() * 2, prev_batch_size);
+    prev_batch_size = controller.batch_size();
+  }
+  EXPECT_EQ(controller.batch_size(), 20);
+}
+
+TEST(BatchSizeControllerTest, StaysWithinBounds) {
+  BatchSizeController controller{/*initial_batch_size=*/10,
+                                 /*max_batch_size=*/50,
+                                 /*target_time=*/absl::Seconds(1)};
+  for (int i = 0; i < 10; ++i) {
+    controller.Observe(controller.batch_size(), absl::Nanoseconds(1));
+  }
+  EXPECT_EQ(controller.batch_size(), 50);
+  for (int i = 0; i < 20; ++i) {
+    controller.Observe(controller.batch_size(), absl::Hours(1));
+  }
+  EXPECT_EQ(controller.batch_size(), 1);
+}
+
+}  // namespace
+}  // namespace centipede
@@ -14,11 +14,13 @@
 
 #include "./centipede/binary_info.h"
 
+#include <cstddef>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/log/check.h"
@@ -27,8 +29,10 @@
 #include "absl/strings/str_split.h"
 #include "./centipede/command.h"
 #include "./centipede/control_flow.h"
+#include "./centipede/logging.h"
 #include "./centipede/pc_info.h"
 #include "./centipede/remote_file.h"
+#include "./centipede/symbol_table.h"
 #include "./centipede/util.h"
 
 namespace centipede {
@@ -36,11 +40,56 @@ namespace centipede {
 namespace {
 constexpr std::string_view kSymbolTableFileName = "symbol-table";
 constexpr std::string_view kPCTableFileName = "pc-table";
+
+// Reads the symbol table written by `WriteSymbolTable()` from `path`.
+SymbolTable ReadSymbolTable(std::string_view path) {
+  std::string symbol_table_contents;
+  RemoteFileGetContents(std::filesystem::path(path), symbol_table_contents);
+  std::istringstream symbol_table_stream(symbol_table_contents);
+  SymbolTable symbols;
+  symbols.ReadFromLLVMSymbolizer(symbol_table_stream);
+  return symbols;
+}
+
+// Writes `symbols` to `path`.
+void WriteSymbolTable(const SymbolTable &symbols, std::string_view path) {
+  std::ostringstream symbol_table_stream;
+  symbols.WriteToLLVMSymbolizer(symbol_table_stream);
+  RemoteFileSetContents(std::filesystem::path(path), symbol_table_stream.str());
+}
+
+// Reads into `symbols` the symbol table cached at `cache_path`. Returns false
+// if there is no cached symbol table with `num_pcs` symbols.
+bool ReadSymbolTableCache(std::string_view cache_path, size_t num_pcs,
+                          SymbolTable &symbols) {
+  if (!RemotePathExists(cache_path)) return false;
+  SymbolTable cached_symbols = ReadSymbolTable(cache_path);
+  if (cached_symbols.size() != num_pcs) {
+    LOG(WARNING) << "Ignoring the cached symbol table of a different size: "
+                 << VV(cache_path) << VV(cached_symbols.size()) << VV(num_pcs);
+    return false;
+  }
+  symbols = std::move(cached_symbols);
+  return true;
+}
+
+// Caches `symbols` at `cache_path`. Writes to a temporary file first, so that
+// concurrent readers never see a partially written symbol table.
+void WriteSymbolTableCache(const SymbolTable &symbols,
+                           std::string_view cache_path) {
+  RemoteMkdir(std::filesystem::path(cache_path).parent_path().string());
+  const std::string tmp_cache_path =
+      ProcessAndThreadUniqueID(absl::StrCat(cache_path, ".tmp."));
+  WriteSymbolTable(symbols, tmp_cache_path);
+  RemotePathRename(tmp_cache_path, cache_path);
+}
+
 }  // namespace
 
 void BinaryInfo::InitializeFromSanCovBinary(
     std::string_view binary_path_with_args, std::string_view objdump_path,
-    std::string_view symbolizer_path, std::string_view tmp_dir_path) {
+    std::string_view symbolizer_path, std::string_view tmp_dir_path,
+    std::string_view symbol_table_cache_path) {
   if (binary_path_with_args.empty()) {
     // This usually happens in tests.
     LOG(INFO) << __func__ << ": binary_path_with_args is empty";
@@ -113,20 +162,25 @@ void BinaryInfo::InitializeFromSanCovBinary(
 
   // Load symbols, if there is a PC table.
   if (!pc_table.empty()) {
-    ScopedFile sym_tmp1_path(tmp_dir_path, "symbols_tmp1");
-    ScopedFile sym_tmp2_path(tmp_dir_path, "symbols_tmp2");
-    symbols.GetSymbolsFromBinary(pc_table, dso_table, symbolizer_path,
-                                 tmp_dir_path);
+    if (!symbol_table_cache_path.empty() &&
+        ReadSymbolTableCache(symbol_table_cache_path, pc_table.size(),
+                             symbols)) {
+      LOG(INFO) << "Read cached symbols from: " << symbol_table_cache_path;
+      return;
+    }
+    const bool symbolized = symbols.GetSymbolsFromBinary(
+        pc_table, dso_table, symbolizer_path, tmp_dir_path);
+    // Don't cache unknown symbols, which a later symbolization may resolve.
+    if (symbolized && !symbol_table_cache_path.empty()) {
+      WriteSymbolTableCache(symbols, symbol_table_cache_path);
+    }
   }
 }
 
 void BinaryInfo::Read(std::string_view dir) {
-  std::string symbol_table_contents;
   // TODO(b/295978603): move calculation of paths into WorkDir class.
-  RemoteFileGetContents(std::filesystem::path(dir).append(kSymbolTableFileName),
-                        symbol_table_contents);
-  std::istringstream symbol_table_stream(symbol_table_contents);
-  symbols.ReadFromLLVMSymbolizer(symbol_table_stream);
+  symbols = ReadSymbolTable(
+      std::filesystem::path(dir).append(kSymbolTableFileName).string());
 
   std::string pc_table_contents;
   RemoteFileGetContents(std::filesystem::path(dir).append(kPCTableFileName),
@@ -136,11 +190,10 @@ void BinaryInfo::Read(std::string_view dir) {
 }
 
 void BinaryInfo::Write(std::string_view dir) {
-  std::ostringstream symbol_table_stream;
-  symbols.WriteToLLVMSymbolizer(symbol_table_stream);
   // TODO(b/295978603): move calculation of paths into WorkDir class.
-  RemoteFileSetContents(std::filesystem::path(dir).append(kSymbolTableFileName),
-                        symbol_table_stream.str());
+  WriteSymbolTable(
+      symbols,
+      std::filesystem::path(dir).append(kSymbolTableFileName).string());
 
   std::ostringstream pc_table_stream;
   WritePcTable(pc_table, pc_table_stream);
@@ -41,10 +41,16 @@ struct BinaryInfo {
   // possibly with space-separated arguments.
   // * `objdump_path` and `symbolizer_path` are paths to respective tools.
   // * `tmp_dir_path` is a path to a temp dir, that must exist.
-  void InitializeFromSanCovBinary(std::string_view binary_path_with_args,
-                                  std::string_view objdump_path,
-                                  std::string_view symbolizer_path,
-                                  std::string_view tmp_dir_path);
+  // * `symbol_table_cache_path`, if not empty, is a path where the symbols are
+  // cached for the binary, in the same format as `Write`. The symbols are read
+  // from there if it exists, skipping the symbolization, and written there
+  // otherwise. The path must be unique to the binary's contents (e.g. contain
+  // its hash), so that all the processes fuzzing the binary, including the
+  // later ones, share one symbolization.
+  void InitializeFromSanCovBinary(
+      std::string_view binary_path_with_args, std::string_view objdump_path,
+      std::string_view symbolizer_path, std::string_view tmp_dir_path,
+      std::string_view symbol_table_cache_path = "");
 
   // Serialize `this` within the given `dir`.
   void Write(std::string_view dir);
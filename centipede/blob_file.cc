@@ -14,6 +14,12 @@
 
 #include "./centipede/blob_file.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -49,14 +55,17 @@ namespace {
 //  `testing::status::StatusIs` instead of direct `absl::Status` comparisons).
 
 // Simple implementations of `BlobFileReader` / `BlobFileWriter` based on
-// `PackBytesForAppendFile()` / `UnpackBytesFromAppendFile()`.
+// `PackBytesForAppendFile()` / `UnpackSpansFromAppendFile()`.
 // We expect to eventually replace this code with something more robust,
 // and efficient, e.g. possibly https://github.com/google/riegeli.
 // But the current implementation is fully functional.
 class SimpleBlobFileReader : public BlobFileReader {
  public:
+  explicit SimpleBlobFileReader(bool map_local_files)
+      : map_local_files_(map_local_files) {}
+
   ~SimpleBlobFileReader() override {
-    if (file_ && !closed_) {
+    if (opened_ && !closed_) {
       // Virtual resolution is off in dtors, so use a specific Close().
       CHECK_OK(SimpleBlobFileReader::Close());
     }
@@ -64,44 +73,103 @@ class SimpleBlobFileReader : public BlobFileReader {
 
   absl::Status Open(std::string_view path) override {
     if (closed_) return absl::FailedPreconditionError("already closed");
-    if (file_) return absl::FailedPreconditionError("already open");
-    file_ = RemoteFileOpen(path, "r");
-    if (file_ == nullptr) return absl::UnknownError("can't open file");
-    // Read the entire file at once.
-    // It may be useful to read the file in chunks, but if we are going
-    // to migrate to something else, it's not important here.
-    ByteArray raw_bytes;
-    RemoteFileRead(file_, raw_bytes);
-    RemoteFileClose(file_);  // close the file here, we won't need it.
-    UnpackBytesFromAppendFile(raw_bytes, &unpacked_blobs_);
+    if (opened_) return absl::FailedPreconditionError("already open");
+    // If allowed, map local files into memory: the blobs are then handed out
+    // directly from the mapping. Anything else is read entirely at once.
+    if (!map_local_files_ || !MapLocalFile(path)) {
+      RemoteFile *file = RemoteFileOpen(path, "r");
+      if (file == nullptr) return absl::UnknownError("can't open file");
+      RemoteFileRead(file, contents_);
+      RemoteFileClose(file);  // close the file here, we won't need it.
+      data_ = contents_;
+    }
+    opened_ = true;
+    UnpackSpansFromAppendFile(data_, blobs_);
     return absl::OkStatus();
   }
 
   absl::Status Read(ByteSpan &blob) override {
     if (closed_) return absl::FailedPreconditionError("already closed");
-    if (!file_) return absl::FailedPreconditionError("was not open");
-    if (next_to_read_blob_index_ == unpacked_blobs_.size())
+    if (!opened_) return absl::FailedPreconditionError("was not open");
+    if (next_to_read_blob_index_ == blobs_.size())
       return absl::OutOfRangeError("no more blobs");
-    if (next_to_read_blob_index_ != 0)  // Clear the previous blob to save RAM.
-      unpacked_blobs_[next_to_read_blob_index_ - 1].clear();
-    blob = ByteSpan(unpacked_blobs_[next_to_read_blob_index_]);
+    blob = blobs_[next_to_read_blob_index_];
     ++next_to_read_blob_index_;
     return absl::OkStatus();
   }
 
+  absl::Status ReadBatch(std::vector<ByteSpan> &blobs,
+                         size_t max_blobs) override {
+    if (closed_) return absl::FailedPreconditionError("already closed");
+    if (!opened_) return absl::FailedPreconditionError("was not open");
+    if (next_to_read_blob_index_ == blobs_.size())
+      return absl::OutOfRangeError("no more blobs");
+    const size_t num_blobs =
+        std::min(max_blobs, blobs_.size() - next_to_read_blob_index_);
+    const auto first = blobs_.begin() + next_to_read_blob_index_;
+    blobs.assign(first, first + num_blobs);
+    next_to_read_blob_index_ += num_blobs;
+    return absl::OkStatus();
+  }
+
+  absl::Status SeekToBlob(size_t index) override {
+    if (closed_) return absl::FailedPreconditionError("already closed");
+    if (!opened_) return absl::FailedPreconditionError("was not open");
+    if (index > blobs_.size()) return absl::OutOfRangeError("no such blob");
+    next_to_read_blob_index_ = index;
+    return absl::OkStatus();
+  }
+
   // Closes the file (it must be open).
   absl::Status Close() override {
     if (closed_) return absl::FailedPreconditionError("already closed");
-    if (!file_) return absl::FailedPreconditionError("was not open");
+    if (!opened_) return absl::FailedPreconditionError("was not open");
     closed_ = true;
-    // Nothing to do here, we've already closed the underlying file (in Open()).
+    // We've already closed the underlying file (in Open()): just release the
+    // contents.
+    blobs_ = {};
+    data_ = {};
+    contents_ = {};
+    if (mapping_ != nullptr) {
+      PCHECK(munmap(mapping_, mapping_size_) == 0);
+      mapping_ = nullptr;
+    }
     return absl::OkStatus();
   }
 
  private:
-  RemoteFile *file_ = nullptr;
+  // Maps `path` into `data_` if it is a non-empty local file. Returns false if
+  // the file can't be mapped. The caller guarantees that the file isn't
+  // truncated while mapped (see `DefaultBlobFileReaderFactory()`): reading a
+  // truncated part of the mapping raises SIGBUS rather than an error.
+  bool MapLocalFile(std::string_view path) {
+    const int fd = open(std::string{path}.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st = {};
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+    // The blobs are located by a pass over the file, then read in order.
+    madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+    mapping_ = mapping;
+    mapping_size_ = st.st_size;
+    data_ = {static_cast<const uint8_t *>(mapping), mapping_size_};
+    return true;
+  }
+
+  const bool map_local_files_;
+  bool opened_ = false;
   bool closed_ = false;
-  std::vector<ByteArray> unpacked_blobs_;
+  // The file contents, either mapped or read into `contents_`.
+  void *mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  ByteArray contents_;
+  ByteSpan data_;
+  // The blobs in `data_`.
+  std::vector<ByteSpan> blobs_;
   size_t next_to_read_blob_index_ = 0;
 };
 
@@ -119,9 +187,15 @@ class SimpleBlobFileWriter : public BlobFileWriter {
     CHECK(mode == "w" || mode == "a") << VV(mode);
     if (closed_) return absl::FailedPreconditionError("already closed");
     if (file_) return absl::FailedPreconditionError("already open");
+    // The blobs written by this writer will be indexed by a footer written in
+    // Close() (see `PackAppendFileIndex()`), with offsets relative to the
+    // beginning of the file.
+    segment_begin_ =
+        (mode == "a" && RemotePathExists(path)) ? RemoteFileGetSize(path) : 0;
     file_ = RemoteFileOpen(path, mode.data());
     if (file_ == nullptr) return absl::UnknownError("can't open file");
     RemoteFileSetWriteBufferSize(file_, kMaxBufferedBytes);
+    next_blob_offset_ = segment_begin_;
     return absl::OkStatus();
   }
 
@@ -131,6 +205,8 @@ class SimpleBlobFileWriter : public BlobFileWriter {
     ByteArray packed = PackBytesForAppendFile(blob);
     RemoteFileAppend(file_, packed);
     RemoteFileFlush(file_);
+    blob_offsets_.push_back(next_blob_offset_);
+    next_blob_offset_ += packed.size();
     return absl::OkStatus();
   }
 
@@ -138,6 +214,10 @@ class SimpleBlobFileWriter : public BlobFileWriter {
     if (closed_) return absl::FailedPreconditionError("already closed");
     if (!file_) return absl::FailedPreconditionError("was not open");
     closed_ = true;
+    if (!blob_offsets_.empty()) {
+      RemoteFileAppend(file_,
+                       PackAppendFileIndex(segment_begin_, blob_offsets_));
+    }
     RemoteFileClose(file_);
     return absl::OkStatus();
   }
@@ -148,12 +228,20 @@ class SimpleBlobFileWriter : public BlobFileWriter {
 
   RemoteFile *file_ = nullptr;
   bool closed_ = false;
+  // The offsets in the file of the first and the next blob written by this
+  // writer, and of all the blobs written by this writer.
+  uint64_t segment_begin_ = 0;
+  uint64_t next_blob_offset_ = 0;
+  std::vector<uint64_t> blob_offsets_;
 };
 
 // Implementation of `BlobFileReader` that can read files written in legacy or
 // Riegeli (https://github.com/google/riegeli) format.
 class DefaultBlobFileReader : public BlobFileReader {
  public:
+  explicit DefaultBlobFileReader(bool map_local_files)
+      : map_local_files_(map_local_files) {}
+
   ~DefaultBlobFileReader() override {
     // Virtual resolution is off in dtors, so use a specific Close().
     CHECK_OK(DefaultBlobFileReader::Close());
@@ -176,7 +264,7 @@ class DefaultBlobFileReader : public BlobFileReader {
     riegeli_reader_.Reset(riegeli::kClosed);
 #endif  // CENTIPEDE_DISABLE_RIEGELI
 
-    legacy_reader_ = std::make_unique<SimpleBlobFileReader>();
+    legacy_reader_ = std::make_unique<SimpleBlobFileReader>(map_local_files_);
     if (absl::Status s = legacy_reader_->Open(path); !s.ok()) {
       legacy_reader_ = nullptr;
       return s;
@@ -206,6 +294,17 @@ class DefaultBlobFileReader : public BlobFileReader {
 #endif  // CENTIPEDE_DISABLE_RIEGELI
   }
 
+  absl::Status ReadBatch(std::vector<ByteSpan> &blobs,
+                         size_t max_blobs) override {
+    if (legacy_reader_) return legacy_reader_->ReadBatch(blobs, max_blobs);
+    return BlobFileReader::ReadBatch(blobs, max_blobs);
+  }
+
+  absl::Status SeekToBlob(size_t index) override {
+    if (legacy_reader_) return legacy_reader_->SeekToBlob(index);
+    return BlobFileReader::SeekToBlob(index);
+  }
+
   absl::Status Close() override {
 #ifdef CENTIPEDE_DISABLE_RIEGELI
     legacy_reader_ = nullptr;
@@ -240,6 +339,7 @@ class DefaultBlobFileReader : public BlobFileReader {
   }
 
  private:
+  const bool map_local_files_;
   std::unique_ptr<SimpleBlobFileReader> legacy_reader_ = nullptr;
 #ifndef CENTIPEDE_DISABLE_RIEGELI
   riegeli::RecordReader<std::unique_ptr<riegeli::Reader>> riegeli_reader_{
@@ -407,8 +507,22 @@ class RiegeliWriter : public BlobFileWriter {
 
 }  // namespace
 
-std::unique_ptr<BlobFileReader> DefaultBlobFileReaderFactory() {
-  return std::make_unique<DefaultBlobFileReader>();
+absl::Status BlobFileReader::ReadBatch(std::vector<ByteSpan> &blobs,
+                                       size_t max_blobs) {
+  CHECK_GT(max_blobs, 0);
+  ByteSpan blob;
+  if (absl::Status s = Read(blob); !s.ok()) return s;
+  blobs.assign(1, blob);
+  return absl::OkStatus();
+}
+
+absl::Status BlobFileReader::SeekToBlob(size_t index) {
+  return absl::UnimplementedError("seeking is not supported");
+}
+
+std::unique_ptr<BlobFileReader> DefaultBlobFileReaderFactory(
+    bool map_local_files) {
+  return std::make_unique<DefaultBlobFileReader>(map_local_files);
 }
 
 std::unique_ptr<BlobFileWriter> DefaultBlobFileWriterFactory(bool riegeli) {
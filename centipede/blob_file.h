@@ -26,8 +26,10 @@
 #ifndef THIRD_PARTY_CENTIPEDE_BLOB_FILE_H_
 #define THIRD_PARTY_CENTIPEDE_BLOB_FILE_H_
 
+#include <cstddef>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "./centipede/defs.h"
@@ -57,6 +59,22 @@ class BlobFileReader {
   // Returns absl::OutOfRangeError when there are no more blobs to read.
   virtual absl::Status Read(ByteSpan &blob) = 0;
 
+  // Reads up to `max_blobs` next blobs from an open file into `blobs`,
+  // replacing its previous contents. Implementations must ensure that the
+  // memory wrapped by `blobs` remains valid until the next Read(),
+  // ReadBatch(), SeekToBlob() or Close() call. Implementations may return
+  // fewer blobs than available: the default implementation returns one blob
+  // read by Read().
+  // Returns absl::OutOfRangeError when there are no more blobs to read.
+  virtual absl::Status ReadBatch(std::vector<ByteSpan> &blobs,
+                                 size_t max_blobs);
+
+  // Makes the next read from an open file start at the blob number `index`
+  // (0-based). Returns absl::OutOfRangeError if the file has fewer than
+  // `index` blobs, and absl::UnimplementedError if the implementation can't
+  // seek (the default).
+  virtual absl::Status SeekToBlob(size_t index);
+
   // Closes the previously opened file, if any.
   virtual absl::Status Close() = 0;
 };
@@ -92,8 +110,16 @@ class BlobFileWriter {
 
 // Creates a new object of a default implementation of BlobFileReader.
 // The current default implementation supports reading files in the bespoke
-// legacy or Riegeli (https://github.com/google/riegeli) format.
-std::unique_ptr<BlobFileReader> DefaultBlobFileReaderFactory();
+// legacy or Riegeli (https://github.com/google/riegeli) format. Only legacy
+// files support SeekToBlob().
+//
+// If `map_local_files` is `true`, local legacy files are memory-mapped, and
+// their blobs are returned without copying. Pass it only for files that are
+// never truncated while they may be read, e.g. that writers only append to:
+// reading a mapped file that got truncated raises SIGBUS instead of returning
+// an error. Otherwise, files are read into memory on Open().
+std::unique_ptr<BlobFileReader> DefaultBlobFileReaderFactory(
+    bool map_local_files = false);
 
 // Creates a new object of a default implementation of BlobFileWriter.
 // If `riegeli` is `true`, the implementation uses Riegeli
@@ -12,10 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "absl/base/nullability.h"
 #include "absl/flags/flag.h"
@@ -113,18 +115,22 @@ void Convert(               //
   CHECK_OK(out_writer->Open(out, "w")) << VV(out);
   RPROF_SNAPSHOT_AND_LOG("Opened --out");
 
-  // Read and write blobs one-by-one.
+  // Read blobs in batches and write them one-by-one.
 
-  ByteSpan blob;
+  std::vector<ByteSpan> blobs;
   absl::Status read_status = absl::OkStatus();
   StatsLogger stats_logger{
       absl::Seconds(ABSL_VLOG_IS_ON(1) ? 20 : 60),
       FUNCTION_LEVEL_RPROF_NAME,
   };
-  while ((read_status = in_reader->Read(blob)).ok()) {
-    CHECK_OK(out_writer->Write(blob));
-    stats_logger.UpdateStats(blob);
-    stats_logger.MaybeLogIfTime();
+  constexpr size_t kMaxBlobsPerReadBatch = 10000;
+  while ((read_status = in_reader->ReadBatch(blobs, kMaxBlobsPerReadBatch))
+             .ok()) {
+    for (ByteSpan blob : blobs) {
+      CHECK_OK(out_writer->Write(blob));
+      stats_logger.UpdateStats(blob);
+      stats_logger.MaybeLogIfTime();
+    }
   }
   stats_logger.Log();
   CHECK(read_status.ok() || absl::IsOutOfRange(read_status)) << VV(read_status);
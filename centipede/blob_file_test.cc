@@ -14,9 +14,11 @@
 
 #include "./centipede/blob_file.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -35,9 +37,9 @@ class BlobFile : public testing::TestWithParam<bool> {};
 
 // Tests correct way of using a BlobFile, and that files written in both formats
 // can be appropriately detected and read.
-void TestOneBlobFile(std::unique_ptr<BlobFileReader> (*ReaderFactory)(),
+void TestOneBlobFile(std::unique_ptr<BlobFileReader> (*ReaderFactory)(bool),
                      std::unique_ptr<BlobFileWriter> (*WriterFactory)(bool),
-                     bool riegeli) {
+                     bool riegeli, bool map_local_files) {
   ByteArray input1{1, 2, 3};
   ByteArray input2{4, 5};
   ByteArray input3{6, 7, 8, 9};
@@ -56,7 +58,7 @@ void TestOneBlobFile(std::unique_ptr<BlobFileReader> (*ReaderFactory)(),
 
   // Read the blobs back.
   {
-    auto reader = ReaderFactory();
+    auto reader = ReaderFactory(map_local_files);
     EXPECT_OK(reader->Open(path));
     EXPECT_OK(reader->Read(blob));
     EXPECT_EQ(input1, blob);
@@ -76,7 +78,7 @@ void TestOneBlobFile(std::unique_ptr<BlobFileReader> (*ReaderFactory)(),
 
   // Re-read the file, expect to see all 3 blobs.
   {
-    auto reader = ReaderFactory();
+    auto reader = ReaderFactory(map_local_files);
     EXPECT_OK(reader->Open(path));
     EXPECT_OK(reader->Read(blob));
     EXPECT_EQ(input1, blob);
@@ -98,7 +100,7 @@ void TestOneBlobFile(std::unique_ptr<BlobFileReader> (*ReaderFactory)(),
 
   // Re-read the file, expect to see the single new blob.
   {
-    auto reader = ReaderFactory();
+    auto reader = ReaderFactory(map_local_files);
     EXPECT_OK(reader->Open(path));
     EXPECT_OK(reader->Read(blob));
     EXPECT_EQ(input4, blob);
@@ -108,8 +110,10 @@ void TestOneBlobFile(std::unique_ptr<BlobFileReader> (*ReaderFactory)(),
 }
 
 TEST_P(BlobFile, DefaultTest) {
-  TestOneBlobFile(&DefaultBlobFileReaderFactory, &DefaultBlobFileWriterFactory,
-                  GetParam());
+  for (bool map_local_files : {false, true}) {
+    TestOneBlobFile(&DefaultBlobFileReaderFactory,
+                    &DefaultBlobFileWriterFactory, GetParam(), map_local_files);
+  }
 }
 
 // An Open() failure should not interfere with future proper functioning.
@@ -147,7 +151,7 @@ TEST_P(BlobFile, CloseReaderAfterFileRemovalTest) {
   ASSERT_OK(appender->Write(input));
   ASSERT_OK(appender->Close());
 
-  auto reader = DefaultBlobFileReaderFactory();
+  auto reader = DefaultBlobFileReaderFactory(/*map_local_files=*/true);
   ByteSpan blob;
   ASSERT_OK(reader->Open(path));
   ASSERT_OK(reader->Read(blob));
@@ -155,13 +159,58 @@ TEST_P(BlobFile, CloseReaderAfterFileRemovalTest) {
   EXPECT_OK(reader->Close());
 }
 
+TEST_P(BlobFile, ReadBatchAndSeekToBlob) {
+  const bool riegeli = GetParam();
+  const std::string path = TempFilePath();
+  std::vector<ByteArray> inputs;
+  // Write the blobs in two appending sessions.
+  for (size_t session = 0; session < 2; ++session) {
+    auto appender = DefaultBlobFileWriterFactory(riegeli);
+    ASSERT_OK(appender->Open(path, "a"));
+    for (size_t i = 0; i < 10; ++i) {
+      inputs.push_back(ByteArray(i, session));
+      ASSERT_OK(appender->Write(inputs.back()));
+    }
+    ASSERT_OK(appender->Close());
+  }
+
+  auto reader = DefaultBlobFileReaderFactory(/*map_local_files=*/true);
+  ASSERT_OK(reader->Open(path));
+  std::vector<ByteSpan> blobs;
+  std::vector<ByteArray> read_inputs;
+  while (reader->ReadBatch(blobs, /*max_blobs=*/3).ok()) {
+    EXPECT_LE(blobs.size(), 3);
+    EXPECT_FALSE(blobs.empty());
+    for (ByteSpan blob : blobs) {
+      read_inputs.emplace_back(blob.begin(), blob.end());
+    }
+  }
+  EXPECT_EQ(read_inputs, inputs);
+
+  ByteSpan blob;
+  if (riegeli) {
+    EXPECT_TRUE(absl::IsUnimplemented(reader->SeekToBlob(0)));
+  } else {
+    ASSERT_OK(reader->SeekToBlob(13));
+    ASSERT_OK(reader->Read(blob));
+    EXPECT_EQ(inputs[13], blob);
+    ASSERT_OK(reader->SeekToBlob(0));
+    ASSERT_OK(reader->ReadBatch(blobs, /*max_blobs=*/100));
+    EXPECT_EQ(blobs.size(), inputs.size());
+    ASSERT_OK(reader->SeekToBlob(inputs.size()));
+    EXPECT_EQ(reader->Read(blob), absl::OutOfRangeError("no more blobs"));
+    EXPECT_TRUE(absl::IsOutOfRange(reader->SeekToBlob(inputs.size() + 1)));
+  }
+  EXPECT_OK(reader->Close());
+}
+
 // Tests incorrect ways of using a BlobFileReader/BlobFileWriter.
-void TestIncorrectUsage(std::unique_ptr<BlobFileReader> (*ReaderFactory)(),
+void TestIncorrectUsage(std::unique_ptr<BlobFileReader> (*ReaderFactory)(bool),
                         std::unique_ptr<BlobFileWriter> (*WriterFactory)(bool),
                         bool riegeli) {
   const std::string invalid_path = "/DOES/NOT/EXIST";
   const auto path = TempFilePath();
-  auto reader = ReaderFactory();
+  auto reader = ReaderFactory(/*map_local_files=*/false);
   auto appender = WriterFactory(riegeli);
 
   // Open invalid file path.
@@ -51,17 +51,17 @@
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <functional>
+#include <future>  // NOLINT(build/c++11)
 #include <iostream>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
-#include "absl/base/attributes.h"
-#include "absl/base/const_init.h"  // NOLINT
 #include "absl/base/nullability.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -71,27 +71,31 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
-#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "./centipede/binary_info.h"
 #include "./centipede/blob_file.h"
 #include "./centipede/centipede_callbacks.h"
 #include "./centipede/command.h"
 #include "./centipede/control_flow.h"
 #include "./centipede/corpus_io.h"
+#include "./centipede/corpus_store.h"
 #include "./centipede/coverage.h"
 #include "./centipede/defs.h"
 #include "./centipede/early_exit.h"
 #include "./centipede/environment.h"
+#include "./centipede/execution_metadata.h"
 #include "./centipede/feature.h"
 #include "./centipede/feature_set.h"
 #include "./centipede/logging.h"
 #include "./centipede/mutation_input.h"
 #include "./centipede/remote_file.h"
+#include "./centipede/remote_file_reader.h"
 #include "./centipede/runner_result.h"
 #include "./centipede/rusage_profiler.h"
 #include "./centipede/rusage_stats.h"
+#include "./centipede/shared_coverage.h"
 #include "./centipede/stats.h"
 #include "./centipede/util.h"
 #include "./centipede/workdir.h"
@@ -100,14 +104,36 @@ namespace centipede {
 
 using perf::RUsageProfiler;
 
-Centipede::Centipede(const Environment &env, CentipedeCallbacks &user_callbacks,
-                     const BinaryInfo &binary_info,
-                     CoverageLogger &coverage_logger, std::atomic<Stats> &stats)
+namespace {
+
+// With --target_batch_time_ms, the batches grow to at most this many times
+// --batch_size.
+constexpr size_t kMaxBatchSizeGrowth = 10;
+
+}  // namespace
+
+Centipede::Centipede(
+    const Environment &env, CentipedeCallbacks &user_callbacks,
+    const BinaryInfo &binary_info, CoverageLogger &coverage_logger,
+    std::atomic<Stats> &stats,
+    absl::Nullable<CentipedeCallbacksFactory *> callbacks_factory,
+    absl::Nullable<SharedCoverage *> shared_coverage,
+    size_t shared_coverage_index,
+    absl::Nullable<ShardLoadBudget *> shard_load_budget)
     : env_(env),
       user_callbacks_(user_callbacks),
       rng_(env_.seed),
+      shared_coverage_(shared_coverage),
+      shared_coverage_index_(shared_coverage_index),
       // TODO(kcc): [impl] find a better way to compute frequency_threshold.
-      fs_(env_.feature_frequency_threshold, env_.MakeDomainDiscardMask()),
+      own_fs_(shared_coverage == nullptr
+                  ? std::make_unique<FeatureSet>(
+                        env_.feature_frequency_threshold,
+                        env_.MakeDomainDiscardMask(),
+                        env_.use_sparse_feature_set)
+                  : nullptr),
+      fs_(shared_coverage == nullptr ? *own_fs_
+                                     : shared_coverage->feature_set()),
       coverage_frontier_(binary_info),
       binary_info_(binary_info),
       pc_table_(binary_info_.pc_table),
@@ -115,6 +141,12 @@ Centipede::Centipede(const Environment &env, CentipedeCallbacks &user_callbacks,
       function_filter_(env_.function_filter, symbols_),
       coverage_logger_(coverage_logger),
       stats_(stats),
+      own_shard_load_budget_(shard_load_budget == nullptr
+                                 ? std::make_unique<ShardLoadBudget>(
+                                       env_.shard_load_memory_budget_mb << 20)
+                                 : nullptr),
+      shard_load_budget_(shard_load_budget == nullptr ? *own_shard_load_budget_
+                                                      : *shard_load_budget),
       input_filter_path_(std::filesystem::path(TemporaryLocalDirPath())
                              .append("filter-input")),
       input_filter_cmd_(env_.input_filter, {input_filter_path_}, {/*env*/},
@@ -126,8 +158,28 @@ Centipede::Centipede(const Environment &env, CentipedeCallbacks &user_callbacks,
               : RUsageProfiler::kMetricsOff,
           /*raii_actions=*/RUsageProfiler::kRaiiOff,
           /*location=*/{__FILE__, __LINE__},
-          /*description=*/"Engine") {
+          /*description=*/"Engine"),
+      corpus_store_(env_.use_corpus_store
+                        ? std::make_unique<CorpusStore>(
+                              CorpusStore::DirForCorpusFile(
+                                  wd_.CorpusFiles().MyShardPath()))
+                        : nullptr),
+      binary_exec_times_(1 + env_.extra_binaries.size()),
+      batch_size_controller_(
+          /*initial_batch_size=*/env_.batch_size,
+          /*max_batch_size=*/env_.batch_size * kMaxBatchSizeGrowth,
+          /*target_time=*/absl::Milliseconds(env_.target_batch_time_ms)) {
   CHECK(env_.seed) << "env_.seed must not be zero";
+  if (shared_coverage_ != nullptr) {
+    CHECK_LT(shared_coverage_index_, shared_coverage_->num_instances());
+  }
+  if (callbacks_factory != nullptr && env_.parallel_extra_binaries) {
+    for (size_t i = 0; i < env_.extra_binaries.size(); ++i) {
+      extra_binary_callbacks_.push_back(
+          std::make_unique<ThreadedCentipedeCallbacks>(*callbacks_factory,
+                                                       env_));
+    }
+  }
   if (!env_.input_filter.empty() && env_.fork_server)
     input_filter_cmd_.StartForkServer(TemporaryLocalDirPath(), "input_filter");
 }
@@ -155,6 +207,11 @@ void Centipede::CorpusFromFiles(const Environment &env, std::string_view dir) {
   size_t inputs_added = 0;
   size_t inputs_ignored = 0;
   const auto corpus_files = WorkDir{env}.CorpusFiles();
+  // The number of input files to read concurrently and to read ahead of the
+  // input being added.
+  constexpr int kMaxReadThreads = 16;
+  constexpr size_t kReadahead = 64;
+  AsyncRemoteFileReader file_reader{kMaxReadThreads};
   for (size_t shard = 0; shard < env.total_shards; shard++) {
     const std::string corpus_path = corpus_files.ShardPath(shard);
     size_t num_shard_bytes = 0;
@@ -166,24 +223,34 @@ void Centipede::CorpusFromFiles(const Environment &env, std::string_view dir) {
       reader->Open(corpus_path).IgnoreError();
       ByteSpan blob;
       while (reader->Read(blob).ok()) {
-        existing_hashes.insert(Hash(blob));
+        std::string hash = GetCorpusStoreRefHash(blob);
+        existing_hashes.insert(hash.empty() ? Hash(blob) : std::move(hash));
       }
     }
     // Add inputs to the current shard, if the shard doesn't have them already.
+    std::optional<CorpusStore> corpus_store;
+    if (env.use_corpus_store) {
+      corpus_store.emplace(CorpusStore::DirForCorpusFile(corpus_path));
+    }
     auto appender = DefaultBlobFileWriterFactory(env.riegeli);
     CHECK_OK(appender->Open(corpus_path, "a"))
         << "Failed to open corpus file: " << corpus_path;
     ByteArray shard_data;
-    for (const auto &path : sharded_paths[shard]) {
-      std::string input;
-      RemoteFileGetContents(path, input);
-      if (input.empty() || existing_hashes.contains(Hash(input))) {
-        ++inputs_ignored;
-        continue;
-      }
-      CHECK_OK(appender->Write(ByteArray{input.begin(), input.end()}));
-      ++inputs_added;
-    }
+    // Every input is in its own file: read many of them ahead of the one being
+    // added, to hide the latency of the reads.
+    ReadRemoteFilesWithReadahead(
+        file_reader, sharded_paths[shard], kReadahead,
+        [&](size_t, RemoteFileContents input) {
+          if (!input.has_value() || input->empty() ||
+              existing_hashes.contains(Hash(*input))) {
+            ++inputs_ignored;
+            return;
+          }
+          CHECK_OK(appender->Write(corpus_store.has_value()
+                                       ? corpus_store->Put(*input)
+                                       : *input));
+          ++inputs_added;
+        });
     LOG(INFO) << VV(shard) << VV(inputs_added) << VV(inputs_ignored)
               << VV(num_shard_bytes) << VV(shard_data.size());
   }
@@ -285,6 +352,20 @@ void Centipede::UpdateAndMaybeLogStats(std::string_view log_type,
   os << " exec/s: "
      << (execs_per_sec < 1.0 ? execs_per_sec : std::round(execs_per_sec));
   os << " mb: " << (rusage_memory.mem_rss >> 20);
+  if (env_.target_batch_time_ms != 0) {
+    os << " batch: " << batch_size_controller_.batch_size();
+  }
+  if (!env_.extra_binaries.empty() && num_batches_ != 0) {
+    // The average wall time per batch, overall and in every binary.
+    auto batch_ms = [this](absl::Duration total) {
+      return absl::ToInt64Milliseconds(total / num_batches_);
+    };
+    os << " batch-ms: " << batch_ms(batch_exec_time_) << " (";
+    for (size_t i = 0; i < binary_exec_times_.size(); ++i) {
+      os << (i == 0 ? "" : "/") << batch_ms(binary_exec_times_[i]);
+    }
+    os << ")";
+  }
   LOG(INFO) << os.str();
 }
 
@@ -321,39 +402,16 @@ bool Centipede::ExecuteAndReportCrash(std::string_view binary,
 // In the worst case, the number of such synthetic features is a square of
 // the number of regular features, which may not scale.
 // For now, we only treat pairs of PCs as features, which is still quadratic
-// by the number of PCs. But in moderate-sized programs this may be tolerable.
+// by the number of PCs. But in moderate-sized programs this may be tolerable,
+// and --max_pc_pairs_per_input bounds the work per input for the others.
 //
 // Rationale: if two different parts of the target are exercised simultaneously,
 // this may create interesting behaviour that is hard to capture with regular
 // control flow (or other) features.
 size_t Centipede::AddPcPairFeatures(FeatureVec &fv) {
-  // Using a scratch vector to avoid allocations.
-  auto &pcs = add_pc_pair_scratch_;
-  pcs.clear();
-
-  size_t num_pcs = pc_table_.size();
-  size_t num_added_pairs = 0;
-
-  // Collect PCs from fv.
-  for (auto feature : fv) {
-    if (feature_domains::kPCs.Contains(feature))
-      pcs.push_back(ConvertPCFeatureToPcIndex(feature));
-  }
-
-  // The quadratic loop: iterate all PC pairs (!!).
-  for (size_t i = 0, n = pcs.size(); i < n; ++i) {
-    size_t pc1 = pcs[i];
-    for (size_t j = i + 1; j < n; ++j) {
-      size_t pc2 = pcs[j];
-      feature_t f = feature_domains::kPCPair.ConvertToMe(
-          ConvertPcPairToNumber(pc1, pc2, num_pcs));
-      // If we have seen this pair at least once, ignore it.
-      if (fs_.Frequency(f) != 0) continue;
-      fv.push_back(f);
-      ++num_added_pairs;
-    }
-  }
-  return num_added_pairs;
+  return centipede::AddPcPairFeatures(fs_, pc_table_.size(),
+                                      env_.max_pc_pairs_per_input, fv,
+                                      add_pc_pair_scratch_);
 }
 
 bool Centipede::RunBatch(
@@ -361,16 +419,41 @@ bool Centipede::RunBatch(
     absl::Nullable<BlobFileWriter *> corpus_file,
     absl::Nullable<BlobFileWriter *> features_file,
     absl::Nullable<BlobFileWriter *> unconditional_features_file) {
+  const absl::Time batch_start = absl::Now();
+  // Start the extra binaries first, so that they run concurrently with
+  // env_.binary, if possible.
+  std::vector<BatchResult> extra_batch_results(env_.extra_binaries.size());
+  std::vector<std::future<bool>> extra_successes;
+  for (size_t i = 0; i < extra_binary_callbacks_.size(); ++i) {
+    extra_successes.push_back(extra_binary_callbacks_[i]->ExecuteAsync(
+        env_.extra_binaries[i], input_vec, extra_batch_results[i]));
+  }
+
   BatchResult batch_result;
   bool success = ExecuteAndReportCrash(env_.binary, input_vec, batch_result);
   CHECK_EQ(input_vec.size(), batch_result.results().size());
-
-  for (const auto &extra_binary : env_.extra_binaries) {
-    BatchResult extra_batch_result;
-    success =
-        ExecuteAndReportCrash(extra_binary, input_vec, extra_batch_result) &&
-        success;
+  binary_exec_times_[0] += absl::Now() - batch_start;
+
+  for (size_t i = 0; i < env_.extra_binaries.size(); ++i) {
+    const std::string &extra_binary = env_.extra_binaries[i];
+    if (extra_successes.empty()) {
+      const absl::Time start = absl::Now();
+      success = ExecuteAndReportCrash(extra_binary, input_vec,
+                                      extra_batch_results[i]) &&
+                success;
+      binary_exec_times_[1 + i] += absl::Now() - start;
+      continue;
+    }
+    // Joined in order; crashes are reported with `user_callbacks_`.
+    if (!extra_successes[i].get()) {
+      ReportCrash(extra_binary, input_vec, extra_batch_results[i]);
+      success = false;
+    }
+    binary_exec_times_[1 + i] = extra_binary_callbacks_[i]->execution_time();
   }
+  batch_exec_time_ += absl::Now() - batch_start;
+  ++num_batches_;
+
   if (!success && env_.exit_on_crash) {
     LOG(INFO) << "--exit_on_crash is enabled; exiting soon";
     RequestEarlyExit(EXIT_FAILURE);
@@ -400,9 +483,13 @@ bool Centipede::RunBatch(
       if (function_filter_passed) {
         corpus_.Add(input_vec[i], fv, batch_result.results()[i].metadata(), fs_,
                     coverage_frontier_);
+        MaybePublishCorpusInput(input_vec[i], fv,
+                                batch_result.results()[i].metadata());
       }
       if (corpus_file != nullptr) {
-        CHECK_OK(corpus_file->Write(input_vec[i]));
+        CHECK_OK(corpus_file->Write(corpus_store_ != nullptr
+                                        ? corpus_store_->Put(input_vec[i])
+                                        : input_vec[i]));
       }
       if (!env_.corpus_dir.empty() && !env_.corpus_dir[0].empty()) {
         WriteToLocalHashedFileInDir(env_.corpus_dir[0], input_vec[i]);
@@ -418,13 +505,55 @@ bool Centipede::RunBatch(
 // TODO(kcc): [impl] don't reread the same corpus twice.
 void Centipede::LoadShard(const Environment &load_env, size_t shard_index,
                           bool rerun) {
+  LoadShards(load_env, {shard_index},
+             rerun ? std::optional<size_t>{shard_index} : std::nullopt);
+}
+
+void Centipede::LoadAllShardsInRandomOrder(const Environment &load_env,
+                                           bool rerun_my_shard) {
+  // TODO(ussuri): It seems logical to reset `corpus_` before this, but
+  //  that broke `ShardsAndDistillTest` in testing/centipede_test.cc.
+  //  Investigate.
+  std::vector<size_t> shard_idxs(env_.total_shards);
+  std::iota(shard_idxs.begin(), shard_idxs.end(), 0);
+  std::shuffle(shard_idxs.begin(), shard_idxs.end(), rng_);
+  LoadShards(load_env, shard_idxs,
+             rerun_my_shard ? std::optional<size_t>{env_.my_shard_index}
+                            : std::nullopt);
+}
+
+void Centipede::LoadShards(const Environment &load_env,
+                           absl::Span<const size_t> shard_indices,
+                           std::optional<size_t> shard_index_to_rerun) {
+  const WorkDir wd{load_env};
+  std::vector<ShardPaths> shard_paths;
+  shard_paths.reserve(shard_indices.size());
+  for (size_t shard_index : shard_indices) {
+    shard_paths.push_back({
+        /*corpus_path=*/wd.CorpusFiles().ShardPath(shard_index),
+        /*features_path=*/wd.FeaturesFiles().ShardPath(shard_index),
+    });
+  }
+  size_t num_shards_loaded = 0;
+  ReadShardsInParallel(
+      shard_paths, env_.shard_load_parallelism, shard_load_budget_,
+      [&](size_t i, ShardInputsAndFeatures inputs_and_features) {
+        const size_t shard_index = shard_indices[i];
+        MergeShard(shard_index, std::move(inputs_and_features),
+                   /*rerun=*/shard_index == shard_index_to_rerun);
+        LOG_IF(INFO, (++num_shards_loaded % 100) == 0) << VV(num_shards_loaded);
+      });
+}
+
+void Centipede::MergeShard(size_t shard_index,
+                           ShardInputsAndFeatures inputs_and_features,
+                           bool rerun) {
   VLOG(1) << "Loading shard " << shard_index
           << (rerun ? " with rerunning" : " without rerunning");
   size_t num_added_inputs = 0;
   size_t num_skipped_inputs = 0;
   std::vector<ByteArray> inputs_to_rerun;
-  auto input_features_callback = [&](ByteArray input,
-                                     FeatureVec input_features) {
+  for (auto &[input, input_features] : inputs_and_features) {
     if (EarlyExitRequested()) return;
     if (input_features.empty()) {
       if (rerun) {
@@ -440,25 +569,13 @@ void Centipede::LoadShard(const Environment &load_env, size_t shard_index,
         fs_.IncrementFrequencies(input_features);
         // TODO(kcc): cmp_args are currently not saved to disk and not reloaded.
         corpus_.Add(input, input_features, {}, fs_, coverage_frontier_);
+        MaybePublishCorpusInput(input, input_features, {});
         ++num_added_inputs;
       } else {
         VLOG(10) << "Skipping input: " << Hash(input);
         ++num_skipped_inputs;
       }
     }
-  };
-
-  // See serialize_shard_loads on why we may want to serialize shard loads.
-  // TODO(kcc): remove serialize_shard_loads when LoadShards() uses less RAM.
-  const WorkDir wd{load_env};
-  const std::string corpus_path = wd.CorpusFiles().ShardPath(shard_index);
-  const std::string features_path = wd.FeaturesFiles().ShardPath(shard_index);
-  if (env_.serialize_shard_loads) {
-    ABSL_CONST_INIT static absl::Mutex load_shard_mu{absl::kConstInit};
-    absl::MutexLock lock(&load_shard_mu);
-    ReadShard(corpus_path, features_path, input_features_callback);
-  } else {
-    ReadShard(corpus_path, features_path, input_features_callback);
   }
 
   VLOG(1) << "Loaded shard " << shard_index << ": added " << num_added_inputs
@@ -468,22 +585,6 @@ void Centipede::LoadShard(const Environment &load_env, size_t shard_index,
   if (!inputs_to_rerun.empty()) Rerun(inputs_to_rerun);
 }
 
-void Centipede::LoadAllShardsInRandomOrder(const Environment &load_env,
-                                           bool rerun_my_shard) {
-  // TODO(ussuri): It seems logical to reset `corpus_` before this, but
-  //  that broke `ShardsAndDistillTest` in testing/centipede_test.cc.
-  //  Investigate.
-  std::vector<size_t> shard_idxs(env_.total_shards);
-  std::iota(shard_idxs.begin(), shard_idxs.end(), 0);
-  std::shuffle(shard_idxs.begin(), shard_idxs.end(), rng_);
-  size_t num_shards_loaded = 0;
-  for (size_t shard_idx : shard_idxs) {
-    const bool rerun = rerun_my_shard && shard_idx == env_.my_shard_index;
-    LoadShard(load_env, shard_idx, rerun);
-    LOG_IF(INFO, (++num_shards_loaded % 100) == 0) << VV(num_shards_loaded);
-  }
-}
-
 void Centipede::Rerun(std::vector<ByteArray> &to_rerun) {
   if (to_rerun.empty()) return;
   auto features_file_path = wd_.FeaturesFiles().ShardPath(env_.my_shard_index);
@@ -633,7 +734,9 @@ void Centipede::MergeFromOtherCorpus(std::string_view merge_from_dir,
     CHECK_OK(
         appender->Open(wd_.CorpusFiles().ShardPath(env_.my_shard_index), "a"));
     for (size_t idx = initial_corpus_size; idx < new_corpus_size; ++idx) {
-      CHECK_OK(appender->Write(corpus_.Get(idx)));
+      const ByteArray &input = corpus_.Get(idx);
+      CHECK_OK(appender->Write(
+          corpus_store_ != nullptr ? corpus_store_->Put(input) : input));
     }
     LOG(INFO) << "Merge: " << (new_corpus_size - initial_corpus_size)
               << " new inputs added";
@@ -692,6 +795,24 @@ void Centipede::LoadSeedInputs() {
   }
 }
 
+void Centipede::MaybePublishCorpusInput(const ByteArray &input,
+                                        const FeatureVec &fv,
+                                        const ExecutionMetadata &metadata) {
+  if (shared_coverage_ == nullptr) return;
+  shared_coverage_->Publish(
+      shared_coverage_index_,
+      {.data = input, .features = fv, .metadata = metadata});
+}
+
+void Centipede::AddPublishedInputsToCorpus() {
+  if (shared_coverage_ == nullptr) return;
+  for (const auto &published :
+       shared_coverage_->TakePublished(shared_coverage_index_)) {
+    corpus_.Add(published->data, published->features, published->metadata,
+                fs_, coverage_frontier_);
+  }
+}
+
 void Centipede::FuzzingLoop() {
   LOG(INFO) << "Shard: " << env_.my_shard_index << "/" << env_.total_shards
             << " " << TemporaryLocalDirPath() << " "
@@ -735,16 +856,14 @@ void Centipede::FuzzingLoop() {
   fuzz_start_time_ = absl::Now();
   num_runs_ = 0;
 
-  // num_runs / batch_size, rounded up.
-  size_t number_of_batches = env_.num_runs / env_.batch_size;
-  if (env_.num_runs % env_.batch_size != 0) ++number_of_batches;
   size_t new_runs = 0;
   size_t corpus_size_at_last_prune = corpus_.NumActive();
-  for (size_t batch_index = 0; batch_index < number_of_batches; batch_index++) {
+  for (size_t batch_index = 0; new_runs < env_.num_runs; batch_index++) {
     if (EarlyExitRequested()) break;
-    CHECK_LT(new_runs, env_.num_runs);
+    AddPublishedInputsToCorpus();
     auto remaining_runs = env_.num_runs - new_runs;
-    auto batch_size = std::min(env_.batch_size, remaining_runs);
+    auto batch_size =
+        std::min(batch_size_controller_.batch_size(), remaining_runs);
     std::vector<MutationInputRef> mutation_inputs;
     std::vector<ByteArray> mutants;
     mutation_inputs.reserve(env_.mutate_batch_size);
@@ -757,9 +876,17 @@ void Centipede::FuzzingLoop() {
     }
 
     user_callbacks_.Mutate(mutation_inputs, batch_size, mutants);
+    const absl::Time batch_start = absl::Now();
+    const int num_crashes_before_batch = num_crashes_;
     bool gained_new_coverage =
         RunBatch(mutants, corpus_file.get(), features_file.get(), nullptr);
-    new_runs += mutants.size();
+    // A crash cuts the batch short, so its time says little about the inputs.
+    if (num_crashes_ == num_crashes_before_batch) {
+      batch_size_controller_.Observe(mutants.size(), absl::Now() - batch_start);
+    }
+    // Count the requested runs even if the mutator produced fewer mutants, so
+    // that the loop always terminates.
+    new_runs += batch_size;
 
     if (gained_new_coverage) {
       UpdateAndMaybeLogStats("new-feature", 1);
@@ -785,7 +912,7 @@ void Centipede::FuzzingLoop() {
     if (env_.prune_frequency != 0 &&
         corpus_.NumActive() >
             corpus_size_at_last_prune + env_.prune_frequency) {
-      if (env_.use_coverage_frontier) coverage_frontier_.Compute(corpus_);
+      if (env_.use_coverage_frontier) coverage_frontier_.Update(corpus_);
       corpus_.Prune(fs_, coverage_frontier_, env_.max_corpus_size, rng_);
       corpus_size_at_last_prune = corpus_.NumActive();
     }
@@ -17,26 +17,34 @@
 
 #include <atomic>
 #include <cstddef>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "absl/base/nullability.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "./centipede/batch_size_controller.h"
 #include "./centipede/binary_info.h"
 #include "./centipede/blob_file.h"
 #include "./centipede/centipede_callbacks.h"
 #include "./centipede/command.h"
 #include "./centipede/control_flow.h"
 #include "./centipede/corpus.h"
+#include "./centipede/corpus_io.h"
+#include "./centipede/corpus_store.h"
 #include "./centipede/coverage.h"
 #include "./centipede/defs.h"
 #include "./centipede/environment.h"
+#include "./centipede/execution_metadata.h"
 #include "./centipede/feature.h"
 #include "./centipede/feature_set.h"
 #include "./centipede/pc_info.h"
 #include "./centipede/runner_result.h"
 #include "./centipede/rusage_profiler.h"
+#include "./centipede/shared_coverage.h"
 #include "./centipede/stats.h"
 #include "./centipede/symbol_table.h"
 #include "./centipede/workdir.h"
@@ -46,9 +54,26 @@ namespace centipede {
 // The main fuzzing class.
 class Centipede {
  public:
+  // If `callbacks_factory` is not null and `env.parallel_extra_binaries` is
+  // set, it is used to create separate callbacks that execute
+  // `env.extra_binaries` concurrently with `env.binary`. Each of them is used
+  // by a thread of its own, but they all run concurrently with
+  // `user_callbacks`, so the callbacks must not share unsynchronized state.
+  // If `shared_coverage` is not null, this object is its instance
+  // `shared_coverage_index`: it uses the shared feature set, and exchanges the
+  // inputs added to the corpus with the other instances.
+  // If `shard_load_budget` is not null, it limits the memory of the shards
+  // loaded by this object together with the other users of the budget, e.g.
+  // the other instances in this process. Otherwise, this object uses a budget
+  // of its own, of `env.shard_load_memory_budget_mb`.
   Centipede(const Environment &env, CentipedeCallbacks &user_callbacks,
             const BinaryInfo &binary_info, CoverageLogger &coverage_logger,
-            std::atomic<Stats> &stats);
+            std::atomic<Stats> &stats,
+            absl::Nullable<CentipedeCallbacksFactory *> callbacks_factory =
+                nullptr,
+            absl::Nullable<SharedCoverage *> shared_coverage = nullptr,
+            size_t shared_coverage_index = 0,
+            absl::Nullable<ShardLoadBudget *> shard_load_budget = nullptr);
   virtual ~Centipede() = default;
 
   // Non-copyable and non-movable.
@@ -95,6 +120,25 @@ class Centipede {
   // `env_`.
   void LoadAllShardsInRandomOrder(const Environment &load_env,
                                   bool rerun_my_shard);
+  // Loads the shards `shard_indices` from `load_env.workdir`, reading them in
+  // parallel (see `ReadShardsInParallel()`) and merging them into the corpus
+  // in the given order. Re-runs the inputs without features of the shard
+  // `shard_index_to_rerun`, if any.
+  void LoadShards(const Environment &load_env,
+                  absl::Span<const size_t> shard_indices,
+                  std::optional<size_t> shard_index_to_rerun);
+  // Merges the inputs and features of the already read shard `shard_index`
+  // into the corpus. See `LoadShard()` for `rerun`.
+  void MergeShard(size_t shard_index,
+                  ShardInputsAndFeatures inputs_and_features, bool rerun);
+  // Makes an input just added to corpus_ available to the other instances
+  // sharing shared_coverage_, if any.
+  void MaybePublishCorpusInput(const ByteArray &input, const FeatureVec &fv,
+                               const ExecutionMetadata &metadata);
+  // Adds the inputs published by the other instances sharing
+  // shared_coverage_, if any, to corpus_. Their features are already counted
+  // in the shared fs_.
+  void AddPublishedInputsToCorpus();
   // Runs all inputs from `to_rerun`, adds their features to the features file
   // of env_.my_shard_index, adds interesting inputs to the corpus.
   void Rerun(std::vector<ByteArray> &to_rerun);
@@ -175,7 +219,13 @@ class Centipede {
   // the fuzzing performance.
   absl::Time fuzz_start_time_ = absl::InfiniteFuture();
 
-  FeatureSet fs_;
+  // If not null, the coverage shared with other instances in this process,
+  // and the index of this instance there.
+  absl::Nullable<SharedCoverage *> const shared_coverage_;
+  const size_t shared_coverage_index_;
+  // fs_ is either own_fs_ or the feature set of shared_coverage_.
+  std::unique_ptr<FeatureSet> own_fs_;
+  FeatureSet &fs_;
   Corpus corpus_;
   CoverageFrontier coverage_frontier_;
   size_t num_runs_ = 0;  // counts executed inputs
@@ -197,6 +247,11 @@ class Centipede {
   // Statistics of the current run.
   std::atomic<Stats> &stats_;
 
+  // shard_load_budget_ is either own_shard_load_budget_ or the budget passed
+  // to the constructor.
+  std::unique_ptr<ShardLoadBudget> own_shard_load_budget_;
+  ShardLoadBudget &shard_load_budget_;
+
   // Counts the number of crashes reported so far.
   int num_crashes_ = 0;
 
@@ -209,6 +264,24 @@ class Centipede {
 
   // Resource usage stats collection & reporting.
   perf::RUsageProfiler rusage_profiler_;
+
+  // If env_.use_corpus_store, the store that the inputs added to the corpus
+  // are written to; the corpus files then get only references to them.
+  std::unique_ptr<CorpusStore> corpus_store_;
+
+  // The callbacks executing env_.extra_binaries[i] concurrently with
+  // env_.binary, if any.
+  std::vector<std::unique_ptr<ThreadedCentipedeCallbacks>>
+      extra_binary_callbacks_;
+  // The number of batches executed by RunBatch(), the total wall time spent
+  // executing them in all the binaries, and the total wall time spent in
+  // every binary: env_.binary followed by env_.extra_binaries.
+  size_t num_batches_ = 0;
+  absl::Duration batch_exec_time_;
+  std::vector<absl::Duration> binary_exec_times_;
+
+  // Picks the number of mutants per batch in FuzzingLoop().
+  BatchSizeController batch_size_controller_;
 };
 
 }  // namespace centipede
@@ -46,8 +46,16 @@
 namespace centipede {
 
 void CentipedeCallbacks::PopulateBinaryInfo(BinaryInfo &binary_info) {
+  // The symbols are cached in the coverage dir of the workdir, which is keyed
+  // by `env_.binary_hash`, so that all the shards and the restarts symbolize
+  // the binary only once without hashing it again.
+  const std::string symbol_table_cache_path =
+      env_.workdir.empty() || env_.binary_hash.empty()
+          ? ""
+          : WorkDir{env_}.SymbolTableCachePath();
   binary_info.InitializeFromSanCovBinary(
-      env_.coverage_binary, env_.objdump_path, env_.symbolizer_path, temp_dir_);
+      env_.coverage_binary, env_.objdump_path, env_.symbolizer_path, temp_dir_,
+      symbol_table_cache_path);
   // Check the PC table.
   if (binary_info.pc_table.empty()) {
     if (env_.require_pc_table) {
@@ -142,7 +150,9 @@ Command &CentipedeCallbacks::GetOrCreateCommandForBinary(
       /*err=*/execute_log_path_,
       /*timeout=*/amortized_timeout,
       /*temp_file_path=*/temp_input_file_path_));
-  if (env_.fork_server) cmd.StartForkServer(temp_dir_, Hash(binary));
+  if (env_.fork_server) {
+    cmd.StartForkServer(temp_dir_, Hash(binary), env_.persistent_mode);
+  }
 
   return cmd;
 }
@@ -362,4 +372,31 @@ size_t CentipedeCallbacks::LoadDictionary(std::string_view dictionary_path) {
   return unpacked_dictionary.size();
 }
 
+ThreadedCentipedeCallbacks::ThreadedCentipedeCallbacks(
+    CentipedeCallbacksFactory &factory, const Environment &env)
+    : factory_(factory) {
+  thread_
+      .Submit([this, &env] {
+        // `CentipedeCallbacks` expects the thread's temporary dir to exist.
+        CreateLocalDirRemovedAtExit(TemporaryLocalDirPath());
+        callbacks_ = factory_.create(env);
+      })
+      .get();
+}
+
+ThreadedCentipedeCallbacks::~ThreadedCentipedeCallbacks() {
+  thread_.Submit([this] { factory_.destroy(callbacks_); }).get();
+}
+
+std::future<bool> ThreadedCentipedeCallbacks::ExecuteAsync(
+    std::string_view binary, const std::vector<ByteArray> &inputs,
+    BatchResult &batch_result) {
+  return thread_.Submit([this, binary, &inputs, &batch_result] {
+    const absl::Time start = absl::Now();
+    const bool success = callbacks_->Execute(binary, inputs, batch_result);
+    execution_time_ += absl::Now() - start;
+    return success;
+  });
+}
+
 }  // namespace centipede
@@ -17,12 +17,14 @@
 
 #include <cstddef>
 #include <filesystem>  // NOLINT
+#include <future>  // NOLINT(build/c++11)
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "absl/base/nullability.h"
 #include "absl/log/check.h"
+#include "absl/time/time.h"
 #include "./centipede/binary_info.h"
 #include "./centipede/byte_array_mutator.h"
 #include "./centipede/command.h"
@@ -32,6 +34,7 @@
 #include "./centipede/mutation_input.h"
 #include "./centipede/runner_result.h"
 #include "./centipede/shared_memory_blob_sequence.h"
+#include "./centipede/thread_pool.h"
 #include "./centipede/util.h"
 
 namespace centipede {
@@ -221,6 +224,40 @@ class ScopedCentipedeCallbacks {
   CentipedeCallbacks *callbacks_;
 };
 
+// Owns a `CentipedeCallbacks` object created by `factory` on a dedicated
+// thread, and executes binaries with it on that thread. The temporary dir,
+// the shared memory blob sequences and the fork servers of the callbacks are
+// all unique to that thread, so several such objects can execute binaries
+// concurrently with each other and with the calling thread.
+class ThreadedCentipedeCallbacks {
+ public:
+  ThreadedCentipedeCallbacks(CentipedeCallbacksFactory &factory,
+                             const Environment &env);
+  ~ThreadedCentipedeCallbacks();
+
+  ThreadedCentipedeCallbacks(const ThreadedCentipedeCallbacks &) = delete;
+  ThreadedCentipedeCallbacks &operator=(const ThreadedCentipedeCallbacks &) =
+      delete;
+
+  // Starts `CentipedeCallbacks::Execute(binary, inputs, batch_result)` on the
+  // dedicated thread and returns a future for its result. `inputs` and
+  // `batch_result` must stay alive until the future is ready.
+  std::future<bool> ExecuteAsync(std::string_view binary,
+                                 const std::vector<ByteArray> &inputs,
+                                 BatchResult &batch_result);
+
+  // Returns the total wall time spent in `Execute()` so far. Must not be
+  // called while an `ExecuteAsync()` is in flight.
+  absl::Duration execution_time() const { return execution_time_; }
+
+ private:
+  CentipedeCallbacksFactory &factory_;
+  CentipedeCallbacks *callbacks_ = nullptr;
+  absl::Duration execution_time_;
+  // Destroyed first, joining the thread.
+  ThreadPool thread_{1};
+};
+
 }  // namespace centipede
 
 #endif  // THIRD_PARTY_CENTIPEDE_CENTIPEDE_CALLBACKS_H_
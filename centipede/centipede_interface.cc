@@ -51,6 +51,7 @@
 #include "./centipede/centipede_callbacks.h"
 #include "./centipede/command.h"
 #include "./centipede/corpus_io.h"
+#include "./centipede/corpus_store.h"
 #include "./centipede/coverage.h"
 #include "./centipede/defs.h"
 #include "./centipede/distill.h"
@@ -61,6 +62,7 @@
 #include "./centipede/pc_info.h"
 #include "./centipede/remote_file.h"
 #include "./centipede/runner_result.h"
+#include "./centipede/shared_coverage.h"
 #include "./centipede/stats.h"
 #include "./centipede/util.h"
 #include "./centipede/workdir.h"
@@ -121,7 +123,7 @@ int ForEachBlob(const Environment &env) {
     ByteSpan blob;
     while (blob_reader->Read(blob) == absl::OkStatus()) {
       ByteArray bytes;
-      bytes.insert(bytes.begin(), blob.data(), blob.end());
+      if (!ResolveCorpusBlob(arg, blob, bytes)) continue;
       // TODO(kcc): [impl] add a variant of WriteToLocalFile that accepts Span.
       WriteToLocalFile(tmpfile, bytes);
       std::string command_line = absl::StrReplaceAll(
@@ -234,8 +236,20 @@ int Fuzz(const Environment &env, const BinaryInfo &binary_info,
                            std::ref(stats_thread_continue_running),
                            std::ref(stats_vec), std::ref(envs));
 
+  // With --shared_coverage, the threads share one feature set and exchange the
+  // inputs they add to their corpora.
+  std::unique_ptr<SharedCoverage> shared_coverage;
+  if (env.shared_coverage && env.num_threads > 1) {
+    shared_coverage = std::make_unique<SharedCoverage>(
+        env.feature_frequency_threshold, env.MakeDomainDiscardMask(),
+        env.num_threads);
+  }
+  // The threads load shards under one memory budget: see
+  // --shard_load_memory_budget_mb.
+  ShardLoadBudget shard_load_budget{env.shard_load_memory_budget_mb << 20};
+
   auto fuzzing_worker = [&](Environment &my_env, std::atomic<Stats> &stats,
-                            bool create_tmpdir) {
+                            size_t thread_idx, bool create_tmpdir) {
     if (create_tmpdir) CreateLocalDirRemovedAtExit(TemporaryLocalDirPath());
     my_env.UpdateForExperiment();
     my_env.seed = GetRandomSeed(env.seed);  // uses TID, call in this thread.
@@ -245,7 +259,8 @@ int Fuzz(const Environment &env, const BinaryInfo &binary_info,
 
     ScopedCentipedeCallbacks scoped_callbacks(callbacks_factory, my_env);
     Centipede centipede(my_env, *scoped_callbacks.callbacks(), binary_info,
-                        coverage_logger, stats);
+                        coverage_logger, stats, &callbacks_factory,
+                        shared_coverage.get(), thread_idx, &shard_load_budget);
     centipede.FuzzingLoop();
   };
 
@@ -257,7 +272,8 @@ int Fuzz(const Environment &env, const BinaryInfo &binary_info,
     //
     // Here, the fuzzing worker should not re-create the tmpdir since the path
     // is thread-local and it has been created in the current function.
-    fuzzing_worker(envs[0], stats_vec[0], /*create_tmpdir=*/false);
+    fuzzing_worker(envs[0], stats_vec[0], /*thread_idx=*/0,
+                   /*create_tmpdir=*/false);
   } else {
     std::vector<std::thread> fuzzing_worker_threads(env.num_threads);
     for (size_t thread_idx = 0; thread_idx < env.num_threads; thread_idx++) {
@@ -265,7 +281,8 @@ int Fuzz(const Environment &env, const BinaryInfo &binary_info,
       my_env.my_shard_index = env.my_shard_index + thread_idx;
       fuzzing_worker_threads[thread_idx] =
           std::thread(fuzzing_worker, std::ref(my_env),
-                      std::ref(stats_vec[thread_idx]), /*create_tmpdir=*/true);
+                      std::ref(stats_vec[thread_idx]), thread_idx,
+                      /*create_tmpdir=*/true);
     }
     for (size_t thread_idx = 0; thread_idx < env.num_threads; thread_idx++) {
       fuzzing_worker_threads[thread_idx].join();
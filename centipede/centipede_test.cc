@@ -20,6 +20,7 @@
 #include <filesystem>  // NOLINT
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <set>
 #include <string>
 #include <string_view>
@@ -28,11 +29,14 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
 #include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "./centipede/centipede_callbacks.h"
 #include "./centipede/centipede_default_callbacks.h"
 #include "./centipede/centipede_interface.h"
@@ -624,6 +628,7 @@ class ExtraBinariesMock : public CentipedeCallbacks {
   // On certain combinations of {binary,input} returns false.
   bool Execute(std::string_view binary, const std::vector<ByteArray> &inputs,
                BatchResult &batch_result) override {
+    executed_binaries_.insert(std::string(binary));
     bool res = true;
     for (const auto &input : inputs) {
       if (input.size() != 1) continue;
@@ -645,42 +650,91 @@ class ExtraBinariesMock : public CentipedeCallbacks {
     }
   }
 
+  const std::set<std::string> &executed_binaries() const {
+    return executed_binaries_;
+  }
+
  private:
   size_t number_of_mutations_ = 0;
+  std::set<std::string> executed_binaries_;
+};
+
+// Creates a separate ExtraBinariesMock for every thread that asks for one.
+class ExtraBinariesMockFactory : public CentipedeCallbacksFactory {
+ public:
+  absl::Nonnull<CentipedeCallbacks *> create(const Environment &env) override {
+    absl::MutexLock lock(&mu_);
+    return mocks_.emplace_back(std::make_unique<ExtraBinariesMock>(env)).get();
+  }
+  void destroy(CentipedeCallbacks *cb) override {}
+
+  // Returns the binaries executed by every mock created so far.
+  std::vector<std::set<std::string>> GetExecutedBinaries() {
+    absl::MutexLock lock(&mu_);
+    std::vector<std::set<std::string>> executed_binaries;
+    for (const auto &mock : mocks_) {
+      executed_binaries.push_back(mock->executed_binaries());
+    }
+    return executed_binaries;
+  }
+
+ private:
+  absl::Mutex mu_;
+  std::vector<std::unique_ptr<ExtraBinariesMock>> mocks_ ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace
 
-// Tests --extra_binaries.
+// Tests --extra_binaries, with and without --parallel_extra_binaries.
 // Executes one main binary (--binary) and 3 extra ones (--extra_binaries).
 // Expects the main binary and two extra ones to generate one crash each.
 TEST(Centipede, ExtraBinaries) {
-  TempDir tmp_dir{test_info_->name()};
-  Environment env;
-  env.workdir = tmp_dir.path();
-  env.num_runs = 100;
-  env.batch_size = 10;
-  env.log_level = 1;
-  env.binary = "b1";
-  env.extra_binaries = {"b2", "b3", "b4"};
-  env.require_pc_table = false;  // No PC table here.
-  ExtraBinariesMock mock(env);
-  MockFactory factory(mock);
-  CentipedeMain(env, factory);
+  for (bool parallel_extra_binaries : {false, true}) {
+    TempDir tmp_dir{test_info_->name(),
+                    parallel_extra_binaries ? "parallel" : "sequential"};
+    Environment env;
+    env.workdir = tmp_dir.path();
+    env.num_runs = 100;
+    env.batch_size = 10;
+    env.log_level = 1;
+    env.binary = "b1";
+    env.extra_binaries = {"b2", "b3", "b4"};
+    env.parallel_extra_binaries = parallel_extra_binaries;
+    env.require_pc_table = false;  // No PC table here.
+    ExtraBinariesMockFactory factory;
+    CentipedeMain(env, factory);
 
-  // Verify that we see the expected crashes.
-  // The "crashes" dir must contain 3 crashy inputs, one for each binary.
-  // We simply match their file names, because they are hashes of the contents.
-  std::vector<std::string> found_crash_file_names;
-  auto crashes_dir_path = WorkDir{env}.CrashReproducerDirPath();
-  ASSERT_TRUE(std::filesystem::exists(crashes_dir_path))
-      << VV(crashes_dir_path);
-  for (const auto &dir_ent :
-       std::filesystem::directory_iterator(crashes_dir_path)) {
-    found_crash_file_names.push_back(dir_ent.path().filename());
+    // In parallel mode, every extra binary is executed by callbacks of its
+    // own, which never execute the main binary.
+    const std::vector<std::set<std::string>> executed_binaries =
+        factory.GetExecutedBinaries();
+    for (const std::string extra_binary : {"b2", "b3", "b4"}) {
+      EXPECT_EQ(absl::c_any_of(executed_binaries,
+                               [&](const std::set<std::string> &binaries) {
+                                 return binaries.contains(extra_binary) &&
+                                        !binaries.contains("b1");
+                               }),
+                parallel_extra_binaries)
+          << VV(extra_binary);
+    }
+
+    // Verify that we see the expected crashes.
+    // The "crashes" dir must contain 3 crashy inputs, one for each binary.
+    // We simply match their file names, because they are hashes of the
+    // contents.
+    std::vector<std::string> found_crash_file_names;
+    auto crashes_dir_path = WorkDir{env}.CrashReproducerDirPath();
+    ASSERT_TRUE(std::filesystem::exists(crashes_dir_path))
+        << VV(crashes_dir_path);
+    for (const auto &dir_ent :
+         std::filesystem::directory_iterator(crashes_dir_path)) {
+      found_crash_file_names.push_back(dir_ent.path().filename());
+    }
+    EXPECT_THAT(found_crash_file_names,
+                testing::UnorderedElementsAre(Hash({10}), Hash({30}),
+                                              Hash({50})))
+        << VV(parallel_extra_binaries);
   }
-  EXPECT_THAT(found_crash_file_names, testing::UnorderedElementsAre(
-                                          Hash({10}), Hash({30}), Hash({50})));
 }
 
 namespace {
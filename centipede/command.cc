@@ -16,6 +16,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/poll.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -23,6 +24,7 @@
 
 #include <algorithm>
 #include <csignal>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <string>
@@ -46,6 +48,7 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "./centipede/early_exit.h"
+#include "./centipede/fork_server_ring.h"
 #include "./centipede/logging.h"
 #include "./centipede/util.h"
 
@@ -54,6 +57,10 @@ namespace centipede {
 // See the definition of --fork_server flag.
 inline constexpr std::string_view kCommandLineSeparator(" \\\n");
 inline constexpr std::string_view kNoForkServerRequestPrefix("%f");
+// How long to wait for the persistent fork server to report the status of a
+// runner process killed after a timeout.
+inline constexpr absl::Duration kPersistentForkServerRecoveryTimeout =
+    absl::Seconds(10);
 
 // TODO(ussuri): Encapsulate as much of the fork server functionality from
 //  this source as possible in this struct, and make it a class.
@@ -71,8 +78,13 @@ struct Command::ForkServerProps {
   // detect that the running process with `pid_` is still the original fork
   // server, not a PID recycled by the OS.
   struct stat exe_stat_ = {};
+  // The file path of the shared memory ring in the persistent mode.
+  std::string ring_path_;
+  // The mapped shared memory ring in the persistent mode, nullptr otherwise.
+  ForkServerControlBlock *control_block_ = nullptr;
 
   ~ForkServerProps() {
+    // Closing the pipes also tells the persistent fork server to exit.
     for (int i = 0; i < 2; ++i) {
       if (pipe_[i] >= 0 && close(pipe_[i]) != 0) {
         LOG(ERROR) << "Failed to close fork server pipe for " << fifo_path_[i];
@@ -84,6 +96,15 @@ struct Command::ForkServerProps {
                    << ": " << ec;
       }
     }
+    if (control_block_ != nullptr &&
+        munmap(control_block_, sizeof(*control_block_)) != 0) {
+      LOG(ERROR) << "Failed to unmap fork server ring " << ring_path_;
+    }
+    std::error_code ec;
+    if (!ring_path_.empty() && !std::filesystem::remove(ring_path_, ec)) {
+      LOG(ERROR) << "Failed to remove fork server ring file " << ring_path_
+                 << ": " << ec;
+    }
   }
 };
 
@@ -146,7 +167,7 @@ std::string Command::ToString() const {
 }
 
 bool Command::StartForkServer(std::string_view temp_dir_path,
-                              std::string_view prefix) {
+                              std::string_view prefix, bool persistent) {
   if (absl::StartsWith(path_, kNoForkServerRequestPrefix)) {
     VLOG(2) << "Fork server disabled for " << path();
     return false;
@@ -165,6 +186,22 @@ bool Command::StartForkServer(std::string_view temp_dir_path,
     PCHECK(mkfifo(fork_server_->fifo_path_[i].c_str(), 0600) == 0)
         << VV(i) << VV(fork_server_->fifo_path_[i]);
   }
+  std::string ring_env;
+  if (persistent) {
+    fork_server_->ring_path_ = std::filesystem::path(temp_dir_path)
+                                   .append(absl::StrCat(prefix, "_RING"));
+    const int fd = open(fork_server_->ring_path_.c_str(),
+                        O_RDWR | O_CREAT | O_TRUNC, 0600);
+    PCHECK(fd >= 0) << VV(fork_server_->ring_path_);
+    PCHECK(ftruncate(fd, sizeof(ForkServerControlBlock)) == 0);
+    void *addr = mmap(nullptr, sizeof(ForkServerControlBlock),
+                      PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    PCHECK(addr != MAP_FAILED) << VV(fork_server_->ring_path_);
+    PCHECK(close(fd) == 0);
+    fork_server_->control_block_ = new (addr) ForkServerControlBlock();
+    ring_env = absl::StrFormat("CENTIPEDE_FORK_SERVER_RING=\"%s\" \\\n    ",
+                               fork_server_->ring_path_);
+  }
 
   // NOTE: A background process does not return its exit status to the subshell,
   // so failures will never propagate to the caller of `system()`. Instead, we
@@ -174,13 +211,13 @@ bool Command::StartForkServer(std::string_view temp_dir_path,
   {
     CENTIPEDE_FORK_SERVER_FIFO0="%s" \
     CENTIPEDE_FORK_SERVER_FIFO1="%s" \
-    %s
+    %s%s
   } &
   echo -n $! > "%s"
 )sh";
   const std::string fork_server_command = absl::StrFormat(
       kForkServerCommandStub, fork_server_->fifo_path_[0],
-      fork_server_->fifo_path_[1], command_line_, pid_file_path);
+      fork_server_->fifo_path_[1], ring_env, command_line_, pid_file_path);
   VLOG(2) << "Fork server command:" << fork_server_command;
 
   const int exit_code = system(fork_server_command.c_str());
@@ -276,7 +313,42 @@ int Command::Execute() {
 
   int exit_code = EXIT_SUCCESS;
 
-  if (fork_server_ != nullptr) {
+  if (fork_server_ != nullptr && fork_server_->control_block_ != nullptr) {
+    VLOG(1) << "Sending execution request to persistent fork server: "
+            << VV(timeout_);
+
+    if (const auto status = VerifyForkServerIsHealthy(); !status.ok()) {
+      LogProblemInfo(absl::StrCat("Fork server should be running, but isn't: ",
+                                  status.message()));
+      return EXIT_FAILURE;
+    }
+
+    ForkServerControlBlock &control = *fork_server_->control_block_;
+    CHECK(control.requests.Push(ForkServerControlBlock::kRunBatch));
+    const int64_t timeout_ns = timeout_ == absl::InfiniteDuration()
+                                   ? -1
+                                   : absl::ToInt64Nanoseconds(timeout_);
+    if (!control.responses.WaitNotEmpty(timeout_ns)) {
+      LogProblemInfo(
+          absl::StrCat("Timeout while waiting for fork server: timeout is ",
+                       absl::FormatDuration(timeout_)));
+      // Kill the hanging runner process: the fork server will respond on
+      // its behalf and fork a new one for the next request.
+      if (const pid_t pid = control.runner_pid.load(); pid > 0) {
+        kill(pid, SIGKILL);
+      }
+      if (control.responses.WaitNotEmpty(absl::ToInt64Nanoseconds(
+              kPersistentForkServerRecoveryTimeout))) {
+        (void)control.responses.Pop();
+      } else {
+        LOG(ERROR) << "Fork server failed to recover from timeout; will "
+                      "proceed without it";
+        fork_server_.reset();
+      }
+      return EXIT_FAILURE;
+    }
+    exit_code = control.responses.Pop();
+  } else if (fork_server_ != nullptr) {
     VLOG(1) << "Sending execution request to fork server: " << VV(timeout_);
 
     if (const auto status = VerifyForkServerIsHealthy(); !status.ok()) {
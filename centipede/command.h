@@ -64,8 +64,13 @@ class Command final {
   // Attempts to start a fork server, returns true on success.
   // Pipe files for the fork server are created in `temp_dir_path`
   // with prefix `prefix`.
+  // If `persistent` is true, the fork server runs in the persistent mode: the
+  // same process executes one `Execute()` after another until it dies, and
+  // the control messages are passed via a shared memory ring, also created in
+  // `temp_dir_path`.
   // See runner_fork_server.cc for details.
-  bool StartForkServer(std::string_view temp_dir_path, std::string_view prefix);
+  bool StartForkServer(std::string_view temp_dir_path, std::string_view prefix,
+                       bool persistent = false);
 
   // Accessors.
   const std::string& path() const { return path_; }
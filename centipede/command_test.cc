@@ -145,5 +145,63 @@ TEST(CommandTest, ForkServer) {
   // TODO(kcc): [impl] test what happens if the child is interrupted.
 }
 
+TEST(CommandTest, PersistentForkServer) {
+  const std::string test_tmpdir = GetTestTempDir(test_info_->name());
+  const std::string helper =
+      GetDataDependencyFilepath("centipede/command_test_helper");
+
+  // The helper doesn't support the persistent mode, so every execution is
+  // served by a new process, but the statuses still travel via the ring.
+  {
+    const std::string input = "success";
+    const std::string log = std::filesystem::path{test_tmpdir} / input;
+    Command cmd(helper, {input}, {}, log, log);
+    ASSERT_TRUE(cmd.StartForkServer(test_tmpdir, "PersistentForkServer",
+                                    /*persistent=*/true));
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(cmd.Execute(), EXIT_SUCCESS);
+      std::string log_contents;
+      ReadFromLocalFile(log, log_contents);
+      EXPECT_EQ(log_contents, absl::Substitute("Got input: $0", input));
+    }
+  }
+
+  {
+    const std::string input = "ret42";
+    const std::string log = std::filesystem::path{test_tmpdir} / input;
+    Command cmd(helper, {input}, {}, log, log);
+    ASSERT_TRUE(cmd.StartForkServer(test_tmpdir, "PersistentForkServer",
+                                    /*persistent=*/true));
+    EXPECT_EQ(cmd.Execute(), 42);
+    EXPECT_EQ(cmd.Execute(), 42);
+  }
+
+  {
+    const std::string input = "abort";
+    const std::string log = std::filesystem::path{test_tmpdir} / input;
+    Command cmd(helper, {input}, {}, log, log);
+    ASSERT_TRUE(cmd.StartForkServer(test_tmpdir, "PersistentForkServer",
+                                    /*persistent=*/true));
+    EXPECT_EQ(WTERMSIG(cmd.Execute()), SIGABRT);
+    EXPECT_EQ(WTERMSIG(cmd.Execute()), SIGABRT);
+  }
+
+  {
+    // The hanging process gets killed, and the next execution is served by a
+    // new process.
+    const std::string input = "hang";
+    const std::string log = std::filesystem::path{test_tmpdir} / input;
+    constexpr auto kTimeout = absl::Seconds(1);
+    Command cmd(helper, {input}, {}, log, log, kTimeout);
+    ASSERT_TRUE(cmd.StartForkServer(test_tmpdir, "PersistentForkServer",
+                                    /*persistent=*/true));
+    EXPECT_EQ(cmd.Execute(), EXIT_FAILURE);
+    EXPECT_EQ(cmd.Execute(), EXIT_FAILURE);
+    std::string log_contents;
+    ReadFromLocalFile(log, log_contents);
+    EXPECT_EQ(log_contents, absl::Substitute("Got input: $0", input));
+  }
+}
+
 }  // namespace
 }  // namespace centipede
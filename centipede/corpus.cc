@@ -17,14 +17,17 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <ostream>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/numeric/bits.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
@@ -101,8 +104,6 @@ size_t Corpus::Prune(const FeatureSet &fs,
   auto subset_to_remove =
       weighted_distribution_.RemoveRandomWeightedSubset(target_size, rng);
   RemoveSubset(subset_to_remove, records_);
-
-  weighted_distribution_.RecomputeInternalState();
   CHECK(!records_.empty());
 
   // Features may have shrunk from CountUnseenAndPruneFrequentFeatures.
@@ -183,51 +184,78 @@ std::string Corpus::MemoryUsageString() const {
 //                          WeightedDistribution
 //------------------------------------------------------------------------------
 
+namespace {
+
+// Returns the lowest set bit of `i`, i.e. the size of the range of weights
+// summed up in the Fenwick tree node with 1-based index `i`.
+size_t LowestBit(size_t i) { return i & (~i + 1); }
+
+}  // namespace
+
 void WeightedDistribution::AddWeight(uint64_t weight) {
-  CHECK_EQ(weights_.size(), cumulative_weights_.size());
+  CHECK_EQ(weights_.size(), tree_.size());
   weights_.push_back(weight);
-  if (cumulative_weights_.empty()) {
-    cumulative_weights_.push_back(weight);
-  } else {
-    cumulative_weights_.push_back(cumulative_weights_.back() + weight);
+  // The new node sums up its own weight and the nodes right below it.
+  const size_t node = tree_.size() + 1;
+  uint64_t sum = weight;
+  for (size_t i = node - 1; i > node - LowestBit(node); i -= LowestBit(i)) {
+    sum += tree_[i - 1];
   }
+  tree_.push_back(sum);
 }
 
 void WeightedDistribution::ChangeWeight(size_t idx, uint64_t new_weight) {
   CHECK_LT(idx, size());
+  // Unsigned wraparound makes this correct for decreasing weights too.
+  const uint64_t delta = new_weight - weights_[idx];
   weights_[idx] = new_weight;
-  cumulative_weights_valid_ = false;
+  for (size_t node = idx + 1; node <= tree_.size(); node += LowestBit(node)) {
+    tree_[node - 1] += delta;
+  }
 }
 
-__attribute__((noinline))  // to see it in profile.
-void WeightedDistribution::RecomputeInternalState() {
-  uint64_t partial_sum = 0;
-  for (size_t i = 0, n = size(); i < n; i++) {
-    partial_sum += weights_[i];
-    cumulative_weights_[i] = partial_sum;
+uint64_t WeightedDistribution::PrefixSum(size_t n) const {
+  uint64_t sum = 0;
+  for (size_t node = n; node > 0; node -= LowestBit(node)) {
+    sum += tree_[node - 1];
+  }
+  return sum;
+}
+
+void WeightedDistribution::RebuildTree() {
+  tree_ = weights_;
+  for (size_t node = 1, n = tree_.size(); node <= n; ++node) {
+    const size_t parent = node + LowestBit(node);
+    if (parent <= n) tree_[parent - 1] += tree_[node - 1];
   }
-  cumulative_weights_valid_ = true;
 }
 
 __attribute__((noinline))  // to see it in profile.
 size_t
 WeightedDistribution::RandomIndex(size_t random) const {
   CHECK(!weights_.empty());
-  CHECK(cumulative_weights_valid_);
-  uint64_t sum_of_all_weights = cumulative_weights_.back();
+  uint64_t sum_of_all_weights = TotalWeight();
   if (sum_of_all_weights == 0)
     return random % size();  // can't do much else here.
   random = random % sum_of_all_weights;
-  auto it = std::upper_bound(cumulative_weights_.begin(),
-                             cumulative_weights_.end(), random);
-  CHECK(it != cumulative_weights_.end());
-  return it - cumulative_weights_.begin();
+  // Descend the tree to find the first index whose prefix sum exceeds
+  // `random`, like upper_bound() over the prefix sums.
+  size_t node = 0;
+  for (size_t step = absl::bit_floor(tree_.size()); step > 0; step >>= 1) {
+    if (node + step <= tree_.size() && tree_[node + step - 1] <= random) {
+      node += step;
+      random -= tree_[node - 1];
+    }
+  }
+  CHECK_LT(node, size());
+  return node;
 }
 
 uint64_t WeightedDistribution::PopBack() {
+  // No other node sums up the last weight.
   uint64_t result = weights_.back();
   weights_.pop_back();
-  cumulative_weights_.pop_back();
+  tree_.pop_back();
   return result;
 }
 
@@ -241,6 +269,8 @@ size_t CoverageFrontier::Compute(const Corpus &corpus) {
 
 size_t CoverageFrontier::Compute(
     const std::vector<CorpusRecord> &corpus_records) {
+  // The next `Update()` starts over.
+  covered_.clear();
   // Initialize the vectors.
   std::fill(frontier_.begin(), frontier_.end(), false);
   std::fill(frontier_weight_.begin(), frontier_weight_.end(), 0);
@@ -319,4 +349,116 @@ size_t CoverageFrontier::Compute(
   return num_functions_in_frontier_;
 }
 
+size_t CoverageFrontier::Update(const Corpus &corpus) {
+  return Update(corpus.Records());
+}
+
+size_t CoverageFrontier::Update(
+    const std::vector<CorpusRecord> &corpus_records) {
+  const auto &pc_table = binary_info_.pc_table;
+  if (func_entries_.empty()) {
+    IteratePcTableFunctions(pc_table, [this](size_t beg, size_t /*end*/) {
+      func_entries_.push_back(beg);
+    });
+  }
+  if (covered_.empty()) {
+    covered_.assign(pc_table.size(), false);
+    std::fill(frontier_.begin(), frontier_.end(), false);
+    std::fill(frontier_weight_.begin(), frontier_weight_.end(), 0);
+    num_functions_in_frontier_ = 0;
+    num_covered_pcs_in_func_.clear();
+    dependent_funcs_.clear();
+  }
+
+  // Collect the newly covered PCs, by function.
+  absl::flat_hash_set<PCIndex> funcs_with_new_pcs;
+  for (const auto &record : corpus_records) {
+    for (auto feature : record.features) {
+      if (!feature_domains::kPCs.Contains(feature)) continue;
+      size_t idx = ConvertPCFeatureToPcIndex(feature);
+      if (idx >= pc_table.size() || covered_[idx]) continue;
+      covered_[idx] = true;
+      const PCIndex func = FunctionOfPc(idx);
+      const size_t func_size = FunctionEnd(func) - func;
+      size_t &num_covered = num_covered_pcs_in_func_[func];
+      // A function counts as frontier while partially covered.
+      if (num_covered == 0 && func_size > 1) ++num_functions_in_frontier_;
+      if (++num_covered == func_size && func_size > 1) {
+        --num_functions_in_frontier_;
+      }
+      funcs_with_new_pcs.insert(func);
+    }
+  }
+
+  absl::flat_hash_set<PCIndex> funcs_to_update = funcs_with_new_pcs;
+  for (PCIndex func : funcs_with_new_pcs) {
+    auto it = dependent_funcs_.find(func);
+    if (it == dependent_funcs_.end()) continue;
+    funcs_to_update.insert(it->second.begin(), it->second.end());
+  }
+  for (PCIndex func : funcs_to_update) {
+    UpdateFunctionFrontier(func);
+  }
+  return num_functions_in_frontier_;
+}
+
+PCIndex CoverageFrontier::FunctionOfPc(PCIndex idx) const {
+  auto it = std::upper_bound(func_entries_.begin(), func_entries_.end(), idx);
+  CHECK(it != func_entries_.begin()) << VV(idx);
+  return *std::prev(it);
+}
+
+PCIndex CoverageFrontier::FunctionEnd(PCIndex func) const {
+  auto it = std::upper_bound(func_entries_.begin(), func_entries_.end(), func);
+  return it == func_entries_.end() ? binary_info_.pc_table.size() : *it;
+}
+
+void CoverageFrontier::UpdateFunctionFrontier(PCIndex func) {
+  const PCIndex end = FunctionEnd(func);
+  std::fill(frontier_.begin() + func, frontier_.begin() + end, false);
+  std::fill(frontier_weight_.begin() + func, frontier_weight_.begin() + end, 0);
+
+  const ControlFlowGraph &cfg = binary_info_.control_flow_graph;
+  auto block_is_covered = [this](PCIndex idx) { return covered_[idx]; };
+  auto function_is_fully_covered = [this](PCIndex idx) {
+    auto it = num_covered_pcs_in_func_.find(idx);
+    return it != num_covered_pcs_in_func_.end() &&
+           it->second == FunctionEnd(idx) - idx;
+  };
+  // The frontier of `func` may change when an uncovered PC of another
+  // function gets covered, e.g. a callee of `func`.
+  auto depend_on_pc = [this, func](PCIndex idx) {
+    const PCIndex other_func = FunctionOfPc(idx);
+    if (other_func != func) dependent_funcs_[other_func].insert(func);
+  };
+
+  // Same as in `Compute()`, but only for `func`.
+  for (PCIndex i = func; i < end; ++i) {
+    if (!covered_[i]) continue;
+    auto pc = binary_info_.pc_table[i].pc;
+    for (auto successor : cfg.GetSuccessors(pc)) {
+      if (!cfg.IsInPcTable(successor)) continue;
+      auto successor_idx = cfg.GetPcIndex(successor);
+      if (covered_[successor_idx]) continue;
+      depend_on_pc(successor_idx);
+      frontier_[i] = true;
+      for (auto reachable_bb : cfg.LazyGetReachabilityForPc(successor)) {
+        if (!cfg.IsInPcTable(reachable_bb)) continue;
+        const PCIndex reachable_idx = cfg.GetPcIndex(reachable_bb);
+        if (covered_[reachable_idx]) continue;
+        depend_on_pc(reachable_idx);
+        const auto &callees =
+            binary_info_.call_graph.GetBasicBlockCallees(reachable_bb);
+        for (auto callee : callees) {
+          if (callee == -1ULL || !cfg.IsInPcTable(callee)) continue;
+          const PCIndex callee_idx = cfg.GetPcIndex(callee);
+          if (!function_is_fully_covered(callee_idx)) depend_on_pc(callee_idx);
+        }
+        frontier_weight_[i] += ComputeFrontierWeight(
+            block_is_covered, function_is_fully_covered, cfg, callees);
+      }
+    }
+  }
+}
+
 }  // namespace centipede
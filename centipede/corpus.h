@@ -23,8 +23,11 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "./centipede/binary_info.h"
+#include "./centipede/control_flow.h"
 #include "./centipede/defs.h"
 #include "./centipede/execution_metadata.h"
 #include "./centipede/feature.h"
@@ -36,6 +39,8 @@ namespace centipede {
 // WeightedDistribution maintains an array of integer weights.
 // It allows to compute a random number in range [0,size()) such that
 // the probability of each number is proportional to its weight.
+// The weights are kept in a Fenwick tree, so that changing a weight and
+// choosing a random number both take O(log(size())).
 class WeightedDistribution {
  public:
   // Adds one more weight.
@@ -47,19 +52,16 @@ class WeightedDistribution {
   void ChangeWeight(size_t idx, uint64_t new_weight);
   // Returns a random number in [0,size()), using a random number `random`.
   // For proper randomness, `random` should come from a 64-bit RNG.
-  // RandomIndex() must not be called after ChangeWeight() without first
-  // calling RecomputeInternalState().
   size_t RandomIndex(size_t random) const;
   // Returns the number of weights.
   size_t size() const { return weights_.size(); }
+  // Returns the sum of all weights.
+  uint64_t TotalWeight() const { return PrefixSum(size()); }
   // Removes all weights.
   void clear() {
     weights_.clear();
-    cumulative_weights_.clear();
+    tree_.clear();
   }
-  // Fixes the internal state that could become stale after call(s) to
-  // ChangeWeight().
-  void RecomputeInternalState();
 
   // Computes a random weighted subset of elements to remove.
   // Removes this subset from `this`.
@@ -67,18 +69,22 @@ class WeightedDistribution {
   std::vector<size_t> RemoveRandomWeightedSubset(size_t target_size, Rng &rng) {
     auto subset_to_remove = RandomWeightedSubset(weights_, target_size, rng);
     RemoveSubset(subset_to_remove, weights_);
-    RemoveSubset(subset_to_remove, cumulative_weights_);
+    RebuildTree();
     return subset_to_remove;
   }
 
  private:
+  // Returns the sum of the first `n` weights.
+  uint64_t PrefixSum(size_t n) const;
+  // Rebuilds tree_ from weights_ in O(size()).
+  void RebuildTree();
+
   // The array of weights. The probability of choosing the index Idx
   // is weights_[Idx] / SumOfAllWeights.
   std::vector<uint64_t> weights_;
-  // i-th element is the sum of the first i elements of weights_.
-  std::vector<uint64_t> cumulative_weights_;
-  // If false, cumulative_weights_ needs to be recomputed.
-  bool cumulative_weights_valid_ = true;
+  // The Fenwick tree over weights_: tree_[i] is the sum of the weights in
+  // (i + 1 - LowestBit(i + 1), i].
+  std::vector<uint64_t> tree_;
 };
 
 class CoverageFrontier;  // Forward decl, used in Corpus.
@@ -175,6 +181,19 @@ class CoverageFrontier {
   // Same as above.
   size_t Compute(const std::vector<CorpusRecord> &corpus_records);
 
+  // Updates the coverage frontier with the PCs of `corpus` that were not
+  // covered in the previous call to `Update()`, recomputing the frontier only
+  // in the functions whose frontier depends on those PCs: the functions that
+  // contain them and the functions that call them. The first call after
+  // construction or after `Compute()` computes the whole frontier.
+  // Unlike `Compute()`, a PC stays covered once seen, even if all the inputs
+  // covering it are later pruned from the corpus.
+  // Returns the number of functions in the frontier.
+  size_t Update(const Corpus &corpus);
+
+  // Same as above.
+  size_t Update(const std::vector<CorpusRecord> &corpus_records);
+
   // Returns the number of functions in the frontier.
   size_t NumFunctionsInFrontier() const { return num_functions_in_frontier_; }
 
@@ -203,6 +222,28 @@ class CoverageFrontier {
 
   // The number of functions in the frontier.
   size_t num_functions_in_frontier_ = 0;
+
+  // The state maintained by `Update()`. Functions are identified by the
+  // PCIndex of their entry.
+
+  // Returns the entry of the function containing the PC at `idx`.
+  PCIndex FunctionOfPc(PCIndex idx) const;
+  // Returns the end of the range of PC indices of the function `func`.
+  PCIndex FunctionEnd(PCIndex func) const;
+  // Recomputes `frontier_` and `frontier_weight_` in the function `func` and
+  // records which other functions that depends on in `dependent_funcs_`.
+  void UpdateFunctionFrontier(PCIndex func);
+
+  // The entries of all functions, in increasing order.
+  std::vector<PCIndex> func_entries_;
+  // covered_[idx] is true iff the PC at `idx` was seen by `Update()`. Empty if
+  // `Update()` needs to start over.
+  std::vector<bool> covered_;
+  // The number of covered PCs in every function, by function entry.
+  absl::flat_hash_map<PCIndex, size_t> num_covered_pcs_in_func_;
+  // For every function, the functions whose frontier may change when more of
+  // its PCs get covered. May have false positives.
+  absl::flat_hash_map<PCIndex, absl::flat_hash_set<PCIndex>> dependent_funcs_;
 };
 
 }  // namespace centipede
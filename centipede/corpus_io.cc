@@ -13,10 +13,13 @@
 // limitations under the License.
 #include "./centipede/corpus_io.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -25,20 +28,35 @@
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "./centipede/blob_file.h"
+#include "./centipede/corpus_store.h"
 #include "./centipede/defs.h"
+#include "./centipede/early_exit.h"
 #include "./centipede/feature.h"
 #include "./centipede/logging.h"
 #include "./centipede/remote_file.h"
+#include "./centipede/remote_file_reader.h"
 #include "./centipede/rusage_profiler.h"
+#include "./centipede/thread_pool.h"
 #include "./centipede/util.h"
 
 namespace centipede {
+namespace {
+
+// The maximum number of blobs to get from a `BlobFileReader` at once.
+constexpr size_t kMaxBlobsPerReadBatch = 10000;
+
+// The number of corpus store inputs to read ahead of the one being added.
+constexpr size_t kStoreReadahead = 64;
+
+}  // namespace
 
 void ReadShard(std::string_view corpus_path, std::string_view features_path,
-               const std::function<void(ByteArray, FeatureVec)> &callback) {
+               const std::function<void(ByteArray, FeatureVec)> &callback,
+               AsyncRemoteFileReader *store_reader) {
   const bool good_corpus_path =
       !corpus_path.empty() && RemotePathExists(corpus_path);
   const bool good_features_path =
@@ -62,14 +80,45 @@ void ReadShard(std::string_view corpus_path, std::string_view features_path,
   //  `absl::flat_hash_map`.
   std::multimap<std::string /*hash*/, ByteArray /*input*/> hash_to_input;
   // Read inputs from the corpus file into `hash_to_input`.
-  auto corpus_reader = DefaultBlobFileReaderFactory();
+  auto corpus_reader = DefaultBlobFileReaderFactory(/*map_local_files=*/true);
   CHECK_OK(corpus_reader->Open(corpus_path)) << VV(corpus_path);
-  ByteSpan blob;
-  while (corpus_reader->Read(blob).ok()) {
-    std::string hash = Hash(blob);
-    ByteArray input{blob.begin(), blob.end()};
-    hash_to_input.emplace(std::move(hash), std::move(input));
+  // The inputs referenced from the corpus file are read from the corpus store,
+  // each from its own file: keep many reads in flight to hide their latency.
+  const CorpusStore corpus_store{CorpusStore::DirForCorpusFile(corpus_path)};
+  std::optional<AsyncRemoteFileReader> own_store_reader;
+  size_t num_inputs_missing_from_store = 0;
+  std::vector<ByteSpan> blobs;
+  std::vector<std::string> ref_hashes;
+  std::vector<std::string> ref_paths;
+  while (corpus_reader->ReadBatch(blobs, kMaxBlobsPerReadBatch).ok()) {
+    ref_hashes.clear();
+    ref_paths.clear();
+    for (ByteSpan blob : blobs) {
+      std::string hash = GetCorpusStoreRefHash(blob);
+      if (hash.empty()) {
+        hash_to_input.emplace(Hash(blob), ByteArray{blob.begin(), blob.end()});
+        continue;
+      }
+      ref_paths.push_back(corpus_store.InputPath(hash));
+      ref_hashes.push_back(std::move(hash));
+    }
+    if (ref_paths.empty()) continue;
+    if (store_reader == nullptr) {
+      store_reader = &own_store_reader.emplace(kMaxCorpusStoreReadThreads);
+    }
+    ReadRemoteFilesWithReadahead(
+        *store_reader, ref_paths, kStoreReadahead,
+        [&](size_t i, RemoteFileContents input) {
+          if (!input.has_value()) {
+            ++num_inputs_missing_from_store;
+            return;
+          }
+          hash_to_input.emplace(std::move(ref_hashes[i]), *std::move(input));
+        });
   }
+  LOG_IF(WARNING, num_inputs_missing_from_store != 0)
+      << "Inputs missing from the corpus store: "
+      << num_inputs_missing_from_store << " " << VV(corpus_path);
 
   RPROF_SNAPSHOT("Read inputs");
 
@@ -88,28 +137,31 @@ void ReadShard(std::string_view corpus_path, std::string_view features_path,
     // input in `hash_to_input`, call `callback` for the pair, and remove the
     // entry from `hash_to_input`. In the end, `hash_to_input` will contain
     // only inputs without matching features.
-    auto features_reader = DefaultBlobFileReaderFactory();
+    auto features_reader =
+        DefaultBlobFileReaderFactory(/*map_local_files=*/true);
     CHECK_OK(features_reader->Open(features_path)) << VV(features_path);
-    ByteSpan hash_and_features;
-    while (features_reader->Read(hash_and_features).ok()) {
-      // Every valid feature record must contain the hash at the end.
-      // Ignore this record if it is too short.
-      if (hash_and_features.size() < kHashLen) continue;
-      FeatureVec features;
-      std::string hash = UnpackFeaturesAndHash(hash_and_features, &features);
-      auto input_node = hash_to_input.extract(hash);
-      if (!input_node.empty()) {
-        --num_inputs_missing_features;
-        if (features.empty()) {
-          // When the features file got created, Centipede did compute features
-          // for the input, but they came up empty. Indicate to the client that
-          // there is no need to recompute by passing this special value.
-          features = {feature_domains::kNoFeature};
-          ++num_inputs_empty_features;
-        } else {
-          ++num_inputs_non_empty_features;
+    while (features_reader->ReadBatch(blobs, kMaxBlobsPerReadBatch).ok()) {
+      for (ByteSpan hash_and_features : blobs) {
+        // Every valid feature record must contain the hash at the end.
+        // Ignore this record if it is too short.
+        if (hash_and_features.size() < kHashLen) continue;
+        FeatureVec features;
+        std::string hash = UnpackFeaturesAndHash(hash_and_features, &features);
+        auto input_node = hash_to_input.extract(hash);
+        if (!input_node.empty()) {
+          --num_inputs_missing_features;
+          if (features.empty()) {
+            // When the features file got created, Centipede did compute
+            // features for the input, but they came up empty. Indicate to the
+            // client that there is no need to recompute by passing this
+            // special value.
+            features = {feature_domains::kNoFeature};
+            ++num_inputs_empty_features;
+          } else {
+            ++num_inputs_non_empty_features;
+          }
+          callback(std::move(input_node.mapped()), std::move(features));
         }
-        callback(std::move(input_node.mapped()), std::move(features));
       }
     }
 
@@ -137,6 +189,128 @@ void ReadShard(std::string_view corpus_path, std::string_view features_path,
       << "Inputs, missing features   : " << num_inputs_missing_features;
 }
 
+size_t ShardLoadBudget::TakeTicket() {
+  absl::MutexLock lock(&mu_);
+  return next_ticket_++;
+}
+
+void ShardLoadBudget::Admit(size_t ticket, size_t size_bytes) {
+  absl::MutexLock lock(&mu_);
+  while (ticket != next_ticket_to_admit_ ||
+         (admitted_bytes_ != 0 &&
+          admitted_bytes_ + size_bytes > budget_bytes_)) {
+    cv_.Wait(&mu_);
+  }
+  ++next_ticket_to_admit_;
+  admitted_bytes_ += size_bytes;
+  cv_.SignalAll();
+}
+
+void ShardLoadBudget::Release(size_t size_bytes) {
+  absl::MutexLock lock(&mu_);
+  CHECK_GE(admitted_bytes_, size_bytes);
+  admitted_bytes_ -= size_bytes;
+  cv_.SignalAll();
+}
+
+namespace {
+
+size_t GetFileSizeOrZero(std::string_view path) {
+  if (path.empty() || !RemotePathExists(path)) return 0;
+  return std::max<int64_t>(RemoteFileGetSize(path), 0);
+}
+
+}  // namespace
+
+size_t GetShardLoadSize(const ShardPaths &shard) {
+  const size_t features_size = GetFileSizeOrZero(shard.features_path);
+  const size_t corpus_file_size = GetFileSizeOrZero(shard.corpus_path);
+  if (corpus_file_size == 0 ||
+      !RemotePathExists(CorpusStore::DirForCorpusFile(shard.corpus_path))) {
+    return features_size + corpus_file_size;
+  }
+  // The corpus file may hold references to the store, which are much smaller
+  // than the inputs they refer to.
+  size_t inputs_size = 0;
+  auto reader = DefaultBlobFileReaderFactory(/*map_local_files=*/true);
+  if (!reader->Open(shard.corpus_path).ok()) return features_size;
+  std::vector<ByteSpan> blobs;
+  while (reader->ReadBatch(blobs, kMaxBlobsPerReadBatch).ok()) {
+    for (ByteSpan blob : blobs) {
+      inputs_size += GetCorpusBlobInputSize(blob);
+    }
+  }
+  return features_size + inputs_size;
+}
+
+void ReadShardsInParallel(
+    absl::Span<const ShardPaths> shards, size_t num_threads,
+    ShardLoadBudget &budget,
+    const std::function<void(size_t, ShardInputsAndFeatures)> &callback) {
+  struct LoadedShard {
+    ShardInputsAndFeatures inputs_and_features;
+    size_t size_bytes = 0;
+    bool ready = false;
+  };
+  std::vector<LoadedShard> loaded_shards(shards.size());
+  // Shared by all the shards, so that the number of threads reading from the
+  // corpus store doesn't grow with `num_threads`.
+  AsyncRemoteFileReader store_reader{kMaxCorpusStoreReadThreads};
+  absl::Mutex mu;
+  size_t next_shard_idx = 0;  // Guarded by `mu`.
+
+  // The readers take the shards and their admission tickets in the same order
+  // in which the shards are handed to `callback` below: the oldest shard not
+  // handed yet is therefore either being read or first in the admission queue,
+  // so the budget can't deadlock.
+  auto read_shards = [&]() {
+    while (true) {
+      size_t shard_idx = 0;
+      size_t ticket = 0;
+      {
+        absl::MutexLock lock(&mu);
+        if (next_shard_idx == shards.size()) return;
+        shard_idx = next_shard_idx++;
+        ticket = budget.TakeTicket();
+      }
+      const ShardPaths &paths = shards[shard_idx];
+      const size_t size_bytes = GetShardLoadSize(paths);
+      budget.Admit(ticket, size_bytes);
+      ShardInputsAndFeatures inputs_and_features;
+      if (!EarlyExitRequested()) {
+        ReadShard(
+            paths.corpus_path, paths.features_path,
+            [&inputs_and_features](ByteArray input, FeatureVec features) {
+              inputs_and_features.emplace_back(std::move(input),
+                                               std::move(features));
+            },
+            &store_reader);
+      }
+      absl::MutexLock lock(&mu);
+      LoadedShard &loaded_shard = loaded_shards[shard_idx];
+      loaded_shard.inputs_and_features = std::move(inputs_and_features);
+      loaded_shard.size_bytes = size_bytes;
+      loaded_shard.ready = true;
+    }
+  };
+
+  ThreadPool threads{static_cast<int>(
+      std::min(std::max<size_t>(num_threads, 1), shards.size()))};
+  for (size_t i = 0; i < threads.num_threads(); ++i) {
+    threads.Schedule(read_shards);
+  }
+  for (size_t shard_idx = 0; shard_idx < shards.size(); ++shard_idx) {
+    LoadedShard loaded_shard;
+    {
+      absl::MutexLock lock(&mu);
+      mu.Await(absl::Condition{&loaded_shards[shard_idx].ready});
+      loaded_shard = std::move(loaded_shards[shard_idx]);
+    }
+    callback(shard_idx, std::move(loaded_shard.inputs_and_features));
+    budget.Release(loaded_shard.size_bytes);
+  }
+}
+
 void ExportCorpus(absl::Span<const std::string> sharded_file_paths,
                   std::string_view out_dir) {
   LOG(INFO) << "Exporting corpus to " << out_dir;
@@ -144,10 +318,12 @@ void ExportCorpus(absl::Span<const std::string> sharded_file_paths,
     auto reader = DefaultBlobFileReaderFactory();
     CHECK_OK(reader->Open(file)) << VV(file);
     ByteSpan blob;
+    ByteArray input;
     size_t num_read = 0;
     while (reader->Read(blob).ok()) {
+      if (!ResolveCorpusBlob(file, blob, input)) continue;
       ++num_read;
-      WriteToRemoteHashedFileInDir(out_dir, blob);
+      WriteToRemoteHashedFileInDir(out_dir, input);
     }
     LOG(INFO) << "Exported " << num_read << " inputs from " << file;
   }
@@ -15,13 +15,19 @@
 #ifndef THIRD_PARTY_CENTIPEDE_SHARD_READER_H_
 #define THIRD_PARTY_CENTIPEDE_SHARD_READER_H_
 
+#include <cstddef>
 #include <functional>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "./centipede/defs.h"
 #include "./centipede/feature.h"
+#include "./centipede/remote_file_reader.h"
 
 namespace centipede {
 
@@ -40,8 +46,79 @@ namespace centipede {
 //
 // If features are found for a given input but are empty,
 // then callback's 2nd argument is {feature_domains::kNoFeature}.
+//
+// The inputs that `corpus_path` refers to in the corpus store are read with
+// `store_reader`, which can be shared between concurrent calls to bound the
+// total number of reading threads. If it is null, a reader with
+// `kMaxCorpusStoreReadThreads` threads is created for this call if needed.
+//
+// Local shard files are memory-mapped while being read (see
+// `DefaultBlobFileReaderFactory()`), so they must not be truncated meanwhile.
+// Centipede only appends to its shards; tools that overwrite shards (e.g. seed
+// corpus generation or distillation) must not write to shards being read.
 void ReadShard(std::string_view corpus_path, std::string_view features_path,
-               const std::function<void(ByteArray, FeatureVec)> &callback);
+               const std::function<void(ByteArray, FeatureVec)> &callback,
+               AsyncRemoteFileReader *store_reader = nullptr);
+
+// The number of concurrent reads of corpus store inputs to use for reading
+// shards, e.g. in the `AsyncRemoteFileReader` passed to `ReadShard()`.
+inline constexpr int kMaxCorpusStoreReadThreads = 16;
+
+// Limits the total size of the shards that `ReadShardsInParallel()` holds in
+// memory, across all the concurrent calls that share the same budget. The
+// size of a shard is approximated by `GetShardLoadSize()`. Shards are admitted
+// in FIFO order; a shard that doesn't fit in the budget is still admitted when
+// no other shard is held, so a budget of 0 makes the readers load one shard at
+// a time.
+class ShardLoadBudget {
+ public:
+  explicit ShardLoadBudget(size_t budget_bytes) : budget_bytes_{budget_bytes} {}
+
+  // Takes a place in the admission queue for a shard.
+  size_t TakeTicket();
+  // Blocks until the shard with `ticket` is the first in the queue and
+  // `size_bytes` fits in the budget, then charges the budget with it.
+  void Admit(size_t ticket, size_t size_bytes);
+  // Returns `size_bytes` of a previously admitted shard to the budget.
+  void Release(size_t size_bytes);
+
+ private:
+  const size_t budget_bytes_;
+  absl::Mutex mu_;
+  absl::CondVar cv_;
+  size_t next_ticket_ ABSL_GUARDED_BY(mu_) = 0;
+  size_t next_ticket_to_admit_ ABSL_GUARDED_BY(mu_) = 0;
+  size_t admitted_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// The corpus and features files of a shard, as passed to `ReadShard()`.
+struct ShardPaths {
+  std::string corpus_path;
+  std::string features_path;
+};
+
+// Returns the approximate number of bytes that `ReadShard()` loads for
+// `shard`: the size of its features file plus the total size of its inputs.
+// If the shard's corpus file refers to inputs in the corpus store, the inputs'
+// sizes are taken from the references, which requires reading the (small)
+// corpus file; otherwise, it is the size of the corpus file.
+size_t GetShardLoadSize(const ShardPaths &shard);
+
+// The {input, features} pairs of a shard, as passed to `ReadShard()`'s
+// `callback`.
+using ShardInputsAndFeatures = std::vector<std::pair<ByteArray, FeatureVec>>;
+
+// Reads `shards` with `ReadShard()` on up to `num_threads` threads, while
+// calling `callback` on the calling thread for every shard in the order of
+// `shards`, with the shard's index in `shards` and its {input, features}
+// pairs. The shards share one `AsyncRemoteFileReader` for their inputs in the
+// corpus store. A shard is read into memory only after it is admitted by
+// `budget`, and stays there until `callback` returns for it. If early exit is
+// requested, the shards that aren't read yet are reported as empty.
+void ReadShardsInParallel(
+    absl::Span<const ShardPaths> shards, size_t num_threads,
+    ShardLoadBudget &budget,
+    const std::function<void(size_t, ShardInputsAndFeatures)> &callback);
 
 // Unpacks the corpus from `sharded_file_paths` and writes each input to an
 // individual file in `out_dir`. The file names are the inputs' hashes.
@@ -14,6 +14,8 @@
 
 #include "./centipede/corpus_io.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
@@ -23,11 +25,14 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "./centipede/blob_file.h"
 #include "./centipede/corpus.h"
+#include "./centipede/corpus_store.h"
 #include "./centipede/defs.h"
 #include "./centipede/feature.h"
+#include "./centipede/logging.h"
 #include "./centipede/test_util.h"
 #include "./centipede/util.h"
 #include "./centipede/workdir.h"
@@ -36,6 +41,7 @@ namespace centipede {
 namespace {
 
 using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
 
 void WriteBlobsToFile(std::string_view blob_file_path,
                       absl::Span<const ByteArray> blobs) {
@@ -106,6 +112,72 @@ TEST(ReadShardTest, ReadsInputsAndFeaturesAndCallsCallbackForEachPair) {
   EXPECT_EQ(res[4].features, FeatureVec());
 }
 
+TEST(ReadShardsInParallelTest, CallsCallbackForEveryShardInOrder) {
+  TempDir tmp_dir{test_info_->name()};
+  constexpr size_t kNumShards = 7;
+  std::vector<ShardPaths> shards;
+  std::vector<ShardInputsAndFeatures> expected_shards;
+  for (size_t shard_idx = 0; shard_idx < kNumShards; ++shard_idx) {
+    ShardPaths paths{
+        tmp_dir.GetFilePath(absl::StrCat("corpus.", shard_idx)),
+        tmp_dir.GetFilePath(absl::StrCat("features.", shard_idx)),
+    };
+    std::vector<ByteArray> corpus_blobs;
+    std::vector<ByteArray> features_blobs;
+    ShardInputsAndFeatures expected;
+    for (size_t i = 0; i < shard_idx * 10; ++i) {
+      ByteArray input(1 + i, static_cast<uint8_t>(shard_idx));
+      FeatureVec features = {shard_idx * 1000 + i};
+      corpus_blobs.push_back(input);
+      features_blobs.push_back(PackFeaturesAndHash(input, features));
+      expected.emplace_back(std::move(input), std::move(features));
+    }
+    WriteBlobsToFile(paths.corpus_path, corpus_blobs);
+    WriteBlobsToFile(paths.features_path, features_blobs);
+    shards.push_back(std::move(paths));
+    expected_shards.push_back(std::move(expected));
+  }
+  // A non-existent shard.
+  shards.push_back({tmp_dir.GetFilePath("no_corpus"), ""});
+  expected_shards.emplace_back();
+
+  // From "one shard at a time" to "all shards at once".
+  for (size_t budget_bytes : {0, 1000, 1 << 30}) {
+    ShardLoadBudget budget{budget_bytes};
+    std::vector<ShardInputsAndFeatures> res;
+    ReadShardsInParallel(
+        shards, /*num_threads=*/3, budget,
+        [&res](size_t shard_idx, ShardInputsAndFeatures inputs_and_features) {
+          EXPECT_EQ(shard_idx, res.size());
+          res.push_back(std::move(inputs_and_features));
+        });
+    ASSERT_EQ(res.size(), expected_shards.size()) << VV(budget_bytes);
+    for (size_t shard_idx = 0; shard_idx < res.size(); ++shard_idx) {
+      EXPECT_THAT(res[shard_idx],
+                  UnorderedElementsAreArray(expected_shards[shard_idx]))
+          << VV(budget_bytes) << VV(shard_idx);
+    }
+  }
+}
+
+TEST(GetShardLoadSizeTest, CountsInputsReferencedFromCorpusStore) {
+  TempDir tmp_dir{test_info_->name()};
+  const ShardPaths plain_shard{tmp_dir.GetFilePath("plain/corpus.0"), ""};
+  const ShardPaths store_shard{tmp_dir.GetFilePath("store/corpus.0"), ""};
+  std::filesystem::create_directories(tmp_dir.GetFilePath("plain"));
+  std::filesystem::create_directories(tmp_dir.GetFilePath("store"));
+  const std::vector<ByteArray> inputs = {ByteArray(1000, 1),
+                                         ByteArray(2000, 2)};
+  WriteBlobsToFile(plain_shard.corpus_path, inputs);
+  CorpusStore store{CorpusStore::DirForCorpusFile(store_shard.corpus_path)};
+  WriteBlobsToFile(store_shard.corpus_path,
+                   {store.Put(inputs[0]), store.Put(inputs[1])});
+
+  EXPECT_GE(GetShardLoadSize(plain_shard), 3000);
+  EXPECT_GE(GetShardLoadSize(store_shard), 3000);
+  EXPECT_LT(std::filesystem::file_size(store_shard.corpus_path), 3000);
+}
+
 TEST(ExportCorpusTest, ExportsCorpusToIndividualFiles) {
   const std::filesystem::path temp_dir = GetTestTempDir(test_info_->name());
   const std::filesystem::path out_dir = temp_dir / "out_dir";
@@ -0,0 +1,127 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./centipede/corpus_store.h"
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "./centipede/defs.h"
+#include "./centipede/logging.h"
+#include "./centipede/remote_file.h"
+#include "./centipede/util.h"
+
+namespace centipede {
+namespace {
+
+// A reference is the magic followed by the hash of the referenced input and
+// its size.
+constexpr char kRefMagic[] = "-CentipedeStoreRef-";
+constexpr size_t kRefMagicLen = sizeof(kRefMagic) - 1;
+constexpr size_t kRefSizeOffset = kRefMagicLen + kHashLen;
+constexpr size_t kRefLen = kRefSizeOffset + sizeof(uint64_t);
+
+bool IsCorpusStoreRef(ByteSpan blob) {
+  return blob.size() == kRefLen &&
+         memcmp(blob.data(), kRefMagic, kRefMagicLen) == 0;
+}
+
+}  // namespace
+
+std::string GetCorpusStoreRefHash(ByteSpan blob) {
+  if (!IsCorpusStoreRef(blob)) return "";
+  return std::string{blob.begin() + kRefMagicLen,
+                     blob.begin() + kRefSizeOffset};
+}
+
+size_t GetCorpusBlobInputSize(ByteSpan blob) {
+  if (!IsCorpusStoreRef(blob)) return blob.size();
+  uint64_t size = 0;
+  memcpy(&size, blob.data() + kRefSizeOffset, sizeof(size));
+  return size;
+}
+
+std::string CorpusStore::DirForCorpusFile(std::string_view corpus_path) {
+  return std::filesystem::path(corpus_path).parent_path() / "corpus_store";
+}
+
+std::string CorpusStore::InputPath(std::string_view hash) const {
+  CHECK_EQ(hash.size(), kHashLen) << VV(hash);
+  return std::filesystem::path(dir_) / hash.substr(0, 2) / hash;
+}
+
+ByteArray CorpusStore::Put(ByteSpan input) {
+  std::string hash = Hash(input);
+  const std::string path = InputPath(hash);
+  ByteArray ref(kRefMagic, kRefMagic + kRefMagicLen);
+  ref.insert(ref.end(), hash.begin(), hash.end());
+  const uint64_t size = input.size();
+  const auto *size_bytes = reinterpret_cast<const uint8_t *>(&size);
+  ref.insert(ref.end(), size_bytes, size_bytes + sizeof(size));
+
+  absl::MutexLock lock(&mu_);
+  if (stored_hashes_.contains(hash)) return ref;
+  if (!RemotePathExists(path)) {
+    const std::string subdir = std::filesystem::path(path).parent_path();
+    if (existing_subdirs_.insert(subdir).second) RemoteMkdir(subdir);
+    // Write to a temporary file first, so that the readers never see a
+    // partially written input. Concurrent writers of the same input are
+    // harmless: they rename identical files.
+    const std::string tmp_path =
+        absl::StrCat(path, ".", getpid(), ".",
+                     std::hash<std::thread::id>{}(std::this_thread::get_id()),
+                     ".tmp");
+    RemoteFileSetContents(tmp_path, ByteArray{input.begin(), input.end()});
+    RemotePathRename(tmp_path, path);
+  }
+  stored_hashes_.insert(std::move(hash));
+  return ref;
+}
+
+bool CorpusStore::Get(std::string_view hash, ByteArray &input) const {
+  const std::string path = InputPath(hash);
+  if (!RemotePathExists(path)) return false;
+  RemoteFileGetContents(path, input);
+  return true;
+}
+
+bool ResolveCorpusBlob(std::string_view corpus_path, ByteSpan blob,
+                       ByteArray &input) {
+  const std::string hash = GetCorpusStoreRefHash(blob);
+  if (hash.empty()) {
+    input.assign(blob.begin(), blob.end());
+    return true;
+  }
+  const CorpusStore corpus_store{CorpusStore::DirForCorpusFile(corpus_path)};
+  if (!corpus_store.Get(hash, input)) {
+    LOG(WARNING) << "Input missing from the corpus store: " << VV(hash)
+                 << VV(corpus_path);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace centipede
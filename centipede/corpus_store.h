@@ -0,0 +1,87 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A content-addressed store of corpus inputs shared by all the shards of a
+// workdir. With the store, a corpus file holds small references to the inputs
+// in the store instead of the inputs themselves, so an input that ends up in
+// many shards (e.g. after `--merge_from` or `--full_sync`) is stored once.
+//
+// Every input is stored in its own file named by `Hash(input)`, in the
+// "corpus_store" dir next to the corpus files. Files are written atomically
+// and never modified, so any number of processes can share the store without
+// coordination. Corpus files may contain both references and plain inputs.
+
+#ifndef THIRD_PARTY_CENTIPEDE_CORPUS_STORE_H_
+#define THIRD_PARTY_CENTIPEDE_CORPUS_STORE_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "./centipede/defs.h"
+
+namespace centipede {
+
+// Returns the hash of the input referenced by `blob` if `blob` is a reference
+// returned by `CorpusStore::Put()`, or an empty string otherwise.
+std::string GetCorpusStoreRefHash(ByteSpan blob);
+
+// Returns the size of the input stored as `blob` in a corpus file: the size of
+// `blob` itself or, if `blob` is a reference, the size of the referenced input
+// recorded in the reference. Doesn't read the input.
+size_t GetCorpusBlobInputSize(ByteSpan blob);
+
+class CorpusStore {
+ public:
+  // Uses the store in `dir`, which is created on the first `Put()`.
+  explicit CorpusStore(std::string_view dir) : dir_{dir} {}
+
+  // Returns the dir of the store used by the corpus file `corpus_path`.
+  static std::string DirForCorpusFile(std::string_view corpus_path);
+
+  // Adds `input` to the store unless it is already there. Returns the
+  // reference to write to a corpus file instead of `input`.
+  ByteArray Put(ByteSpan input);
+
+  // Reads the input with `hash` into `input`. Returns false if the store
+  // doesn't have it.
+  bool Get(std::string_view hash, ByteArray &input) const;
+
+  // Returns the path of the input with `hash`, e.g. to read many inputs with
+  // `AsyncRemoteFileReader`. The inputs are spread over 256 subdirs to keep
+  // the dirs reasonably small.
+  std::string InputPath(std::string_view hash) const;
+
+ private:
+  const std::string dir_;
+  absl::Mutex mu_;
+  // The hashes of the inputs known to be in the store and the subdirs known
+  // to exist, to avoid checking the file system on every `Put()`.
+  absl::flat_hash_set<std::string> stored_hashes_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_set<std::string> existing_subdirs_ ABSL_GUARDED_BY(mu_);
+};
+
+// Reads the input stored as `blob` in the corpus file `corpus_path` into
+// `input`: `blob` itself or, if `blob` is a reference, the referenced input
+// from the store of `corpus_path`. Returns false (and logs a warning) if the
+// referenced input is missing from the store.
+bool ResolveCorpusBlob(std::string_view corpus_path, ByteSpan blob,
+                       ByteArray &input);
+
+}  // namespace centipede
+
+#endif  // THIRD_PARTY_CENTIPEDE_CORPUS_STORE_H_
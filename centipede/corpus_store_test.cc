@@ -0,0 +1,106 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./centipede/corpus_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+
+#include "gtest/gtest.h"
+#include "./centipede/defs.h"
+#include "./centipede/test_util.h"
+#include "./centipede/util.h"
+
+namespace centipede {
+namespace {
+
+size_t CountFiles(const std::filesystem::path &dir) {
+  size_t num_files = 0;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(dir)) {
+    num_files += entry.is_regular_file();
+  }
+  return num_files;
+}
+
+TEST(CorpusStoreTest, PutAndGet) {
+  const TempDir tmp_dir{test_info_->name()};
+  const std::string dir = tmp_dir.GetFilePath("store");
+  CorpusStore store{dir};
+  const ByteArray input1 = {1, 2, 3};
+  const ByteArray input2 = {4, 5};
+
+  const ByteArray ref1 = store.Put(input1);
+  const ByteArray ref2 = store.Put(input2);
+  EXPECT_NE(ref1, input1);
+  EXPECT_NE(ref1, ref2);
+  EXPECT_EQ(GetCorpusStoreRefHash(ref1), Hash(input1));
+  EXPECT_EQ(GetCorpusStoreRefHash(ref2), Hash(input2));
+  EXPECT_EQ(GetCorpusStoreRefHash(input1), "");
+
+  ByteArray input;
+  EXPECT_TRUE(store.Get(Hash(input1), input));
+  EXPECT_EQ(input, input1);
+  // A different store object in the same dir sees the same inputs.
+  EXPECT_TRUE(CorpusStore{dir}.Get(Hash(input2), input));
+  EXPECT_EQ(input, input2);
+  EXPECT_FALSE(store.Get(Hash(ByteArray{7, 7, 7}), input));
+}
+
+TEST(CorpusStoreTest, StoresEveryInputOnce) {
+  const TempDir tmp_dir{test_info_->name()};
+  const std::string dir = tmp_dir.GetFilePath("store");
+  const ByteArray input = {1, 2, 3};
+  CorpusStore store1{dir};
+  CorpusStore store2{dir};
+  const ByteArray ref = store1.Put(input);
+  EXPECT_EQ(store1.Put(input), ref);
+  EXPECT_EQ(store2.Put(input), ref);
+  EXPECT_EQ(CountFiles(dir), 1);
+}
+
+TEST(CorpusStoreTest, ResolveCorpusBlob) {
+  const TempDir tmp_dir{test_info_->name()};
+  const std::string corpus_path = tmp_dir.GetFilePath("corpus.000000");
+  EXPECT_EQ(CorpusStore::DirForCorpusFile(corpus_path),
+            tmp_dir.GetFilePath("corpus_store"));
+  CorpusStore store{CorpusStore::DirForCorpusFile(corpus_path)};
+  const ByteArray stored_input = {1, 2, 3};
+  const ByteArray plain_input = {4, 5, 6};
+  ByteArray input;
+  EXPECT_TRUE(ResolveCorpusBlob(corpus_path, store.Put(stored_input), input));
+  EXPECT_EQ(input, stored_input);
+  EXPECT_TRUE(ResolveCorpusBlob(corpus_path, plain_input, input));
+  EXPECT_EQ(input, plain_input);
+  // A reference to an input missing from the store.
+  const ByteArray dangling_ref =
+      CorpusStore{tmp_dir.GetFilePath("other_store")}.Put({7, 8});
+  EXPECT_FALSE(ResolveCorpusBlob(corpus_path, dangling_ref, input));
+}
+
+TEST(CorpusStoreTest, GetCorpusBlobInputSize) {
+  const TempDir tmp_dir{test_info_->name()};
+  const std::string corpus_path = tmp_dir.GetFilePath("corpus.000000");
+  CorpusStore store{CorpusStore::DirForCorpusFile(corpus_path)};
+  const ByteArray stored_input(1000, 'a');
+  const ByteArray ref = store.Put(stored_input);
+  EXPECT_LT(ref.size(), stored_input.size());
+  EXPECT_EQ(GetCorpusBlobInputSize(ref), stored_input.size());
+  EXPECT_EQ(GetCorpusBlobInputSize(ByteArray{4, 5, 6}), 3);
+}
+
+}  // namespace
+}  // namespace centipede
@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -218,10 +219,6 @@ TEST(WeightedDistribution, WeightedDistribution) {
   EXPECT_GT(freq[1], freq[0]);
 
   wd.ChangeWeight(2, 1);
-  // Calling RandomIndex() after ChangeWeight() w/o calling
-  // RecomputeInternalState() should crash.
-  EXPECT_DEATH(compute_freq(), "");
-  wd.RecomputeInternalState();
   // Weights: {1, 2, 1, 4, 5}
   compute_freq();
   EXPECT_GT(freq[4], freq[3]);
@@ -231,7 +228,6 @@ TEST(WeightedDistribution, WeightedDistribution) {
 
   // Weights: {1, 2, 1, 0, 5}
   wd.ChangeWeight(3, 0);
-  wd.RecomputeInternalState();
   compute_freq();
   EXPECT_GT(freq[4], freq[1]);
   EXPECT_GT(freq[1], freq[0]);
@@ -255,6 +251,52 @@ TEST(WeightedDistribution, WeightedDistribution) {
   compute_freq();
 }
 
+TEST(WeightedDistribution, MatchesPrefixSums) {
+  WeightedDistribution wd;
+  std::vector<uint64_t> weights;
+  Rng rng(0);
+  for (size_t iter = 0; iter < 3000; ++iter) {
+    switch (rng() % 8) {
+      case 0:
+        if (weights.empty()) break;
+        EXPECT_EQ(wd.PopBack(), weights.back());
+        weights.pop_back();
+        break;
+      case 1: {
+        if (weights.empty()) break;
+        const size_t idx = rng() % weights.size();
+        weights[idx] = rng() % 3 == 0 ? 0 : rng() % 1000;
+        wd.ChangeWeight(idx, weights[idx]);
+        break;
+      }
+      case 2: {
+        if (weights.size() < 2 || rng() % 10 != 0) break;
+        const auto removed =
+            wd.RemoveRandomWeightedSubset(weights.size() / 2, rng);
+        RemoveSubset(removed, weights);
+        break;
+      }
+      default:
+        weights.push_back(rng() % 1000);
+        wd.AddWeight(weights.back());
+    }
+    ASSERT_EQ(wd.size(), weights.size());
+    if (weights.empty()) continue;
+    std::vector<uint64_t> prefix_sums(weights.size());
+    std::partial_sum(weights.begin(), weights.end(), prefix_sums.begin());
+    ASSERT_EQ(wd.TotalWeight(), prefix_sums.back());
+    if (prefix_sums.back() == 0) continue;
+    for (size_t i = 0; i < 10; ++i) {
+      const size_t random = rng();
+      const size_t expected_idx =
+          std::upper_bound(prefix_sums.begin(), prefix_sums.end(),
+                           random % prefix_sums.back()) -
+          prefix_sums.begin();
+      ASSERT_EQ(wd.RandomIndex(random), expected_idx);
+    }
+  }
+}
+
 // TODO(ussuri): This is becoming difficult to maintain: various bits of the
 //  input data are stored in independent arrays, other bits are dynamically
 //  initialized, and the matching expected results are listed in two long chains
@@ -383,6 +425,62 @@ TEST(CoverageFrontier, Compute) {
   EXPECT_EQ(frontier.FrontierWeight(18), 0);
 }
 
+TEST(CoverageFrontier, UpdateMatchesCompute) {
+  // Function [0, 3): bb 1 calls [7, 9), bb 2 calls [3, 5).
+  // Function [3, 5): bb 4 calls [5, 7).
+  // Function [5, 7).
+  // Function [7, 9).
+  PCTable pc_table{{100, PCInfo::kFuncEntry}, {101, 0}, {102, 0},
+                   {103, PCInfo::kFuncEntry}, {104, 0},
+                   {105, PCInfo::kFuncEntry}, {106, 0},
+                   {107, PCInfo::kFuncEntry}, {108, 0}};
+  CFTable cf_table{
+      100, 101, 102, 0, 0,  // 100 branches to 101 and 102.
+      101, 0,   107, 0,     // This bb calls 107.
+      102, 0,   103, 0,     // This bb calls 103.
+      103, 104, 0,   0,     //
+      104, 0,   105, 0,     // This bb calls 105.
+      105, 106, 0,   0,     //
+      106, 0,   0,          //
+      107, 108, 0,   0,     //
+      108, 0,   0,          //
+  };
+  BinaryInfo bin_info = {pc_table,           {},         cf_table, {},
+                         ControlFlowGraph(), CallGraph()};
+  bin_info.control_flow_graph.InitializeControlFlowGraph(cf_table, pc_table);
+  bin_info.call_graph.InitializeCallGraph(cf_table, pc_table);
+
+  CoverageFrontier updated_frontier(bin_info);
+  std::vector<CorpusRecord> records;
+  uint64_t prev_weight_of_3 = 0;
+  // Covering 5 and 6 makes [5, 7) fully covered, which changes the frontier
+  // weight of 3 in a different function.
+  for (const std::vector<size_t> &new_pcs :
+       std::vector<std::vector<size_t>>{{0}, {3}, {5, 6}, {7}, {1, 2, 4}}) {
+    CorpusRecord record;
+    for (size_t idx : new_pcs) {
+      record.features.push_back(feature_domains::kPCs.ConvertToMe(idx));
+    }
+    records.push_back(record);
+    CoverageFrontier computed_frontier(bin_info);
+    EXPECT_EQ(updated_frontier.Update(records),
+              computed_frontier.Compute(records));
+    for (size_t i = 0; i < pc_table.size(); ++i) {
+      EXPECT_EQ(updated_frontier.PcIndexIsFrontier(i),
+                computed_frontier.PcIndexIsFrontier(i))
+          << "i=" << i << " step=" << new_pcs.front();
+      EXPECT_EQ(updated_frontier.FrontierWeight(i),
+                computed_frontier.FrontierWeight(i))
+          << "i=" << i << " step=" << new_pcs.front();
+    }
+    if (new_pcs.front() == 5) {
+      EXPECT_NE(updated_frontier.FrontierWeight(3), prev_weight_of_3);
+    }
+    prev_weight_of_3 = updated_frontier.FrontierWeight(3);
+  }
+  EXPECT_EQ(updated_frontier.NumFunctionsInFrontier(), 1);
+}
+
 TEST(CoverageFrontierDeath, InvalidIndexToFrontier) {
   PCTable pc_table = {{0, PCInfo::kFuncEntry}, {1, 0}};
   CFTable cf_table = {
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_split.h"
 #include "absl/synchronization/mutex.h"
@@ -177,19 +178,29 @@ bool FunctionFilter::filter(const FeatureVec &features) const {
   return false;
 }
 
-static uint8_t SelectMultiplierByCoverageKind(uint8_t uncovered_knob,
-                                              uint8_t partially_covered_knob,
-                                              uint8_t fully_covered_knob,
-                                              PCIndex callee_idx,
-                                              const Coverage &coverage) {
-  if (coverage.FunctionIsFullyCovered(callee_idx)) return fully_covered_knob;
-  if (coverage.BlockIsCovered(callee_idx)) return partially_covered_knob;
+static uint8_t SelectMultiplierByCoverageKind(
+    uint8_t uncovered_knob, uint8_t partially_covered_knob,
+    uint8_t fully_covered_knob, PCIndex callee_idx,
+    absl::FunctionRef<bool(PCIndex)> block_is_covered,
+    absl::FunctionRef<bool(PCIndex)> function_is_fully_covered) {
+  if (function_is_fully_covered(callee_idx)) return fully_covered_knob;
+  if (block_is_covered(callee_idx)) return partially_covered_knob;
   return uncovered_knob;
 }
 
 uint32_t ComputeFrontierWeight(const Coverage &coverage,
                                const ControlFlowGraph &cfg,
                                const std::vector<uintptr_t> &callees) {
+  return ComputeFrontierWeight(
+      [&coverage](PCIndex idx) { return coverage.BlockIsCovered(idx); },
+      [&coverage](PCIndex idx) { return coverage.FunctionIsFullyCovered(idx); },
+      cfg, callees);
+}
+
+uint32_t ComputeFrontierWeight(
+    absl::FunctionRef<bool(PCIndex)> block_is_covered,
+    absl::FunctionRef<bool(PCIndex)> function_is_fully_covered,
+    const ControlFlowGraph &cfg, const std::vector<uintptr_t> &callees) {
   // Multiplication factors for different coverage types.
   // TODO(ussuri): replace with actual knobs (cl/486229527).
   uint8_t uncovered_knob = 153;         // ~ (255 * 0.6)
@@ -217,7 +228,7 @@ uint32_t ComputeFrontierWeight(const Coverage &coverage,
     CHECK(cfg.BlockIsFunctionEntry(callee_idx));
     auto coverage_multiplier = SelectMultiplierByCoverageKind(
         uncovered_knob, partially_covered_knob, fully_covered_knob, callee_idx,
-        coverage);
+        block_is_covered, function_is_fully_covered);
 
     weight += coverage_multiplier * cyclomatic_comp;
   }
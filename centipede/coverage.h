@@ -26,6 +26,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/synchronization/mutex.h"
 #include "./centipede/control_flow.h"
@@ -180,6 +181,14 @@ uint32_t ComputeFrontierWeight(const Coverage &coverage,
                                const ControlFlowGraph &cfg,
                                const std::vector<uintptr_t> &callees);
 
+// Same as above, but with the coverage given as predicates over PC indices:
+// `block_is_covered` and, for function entries, `function_is_fully_covered`.
+// Used where the coverage is maintained incrementally.
+uint32_t ComputeFrontierWeight(
+    absl::FunctionRef<bool(PCIndex)> block_is_covered,
+    absl::FunctionRef<bool(PCIndex)> function_is_fully_covered,
+    const ControlFlowGraph &cfg, const std::vector<uintptr_t> &callees);
+
 }  // namespace centipede
 
 #endif  // THIRD_PARTY_CENTIPEDE_COVERAGE_H_
@@ -0,0 +1,164 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares `CoverageFrontier::Compute()` (full recompute) against
+// `CoverageFrontier::Update()` (incremental) on a synthetic binary, e.g.
+//
+//   coverage_frontier_benchmark --num_functions=100000 --bbs_per_function=10
+//
+// The workload mimics a fuzzing campaign: in every step, a record covering a
+// few more PCs is added to the corpus, and the frontier is brought up to date
+// with both methods, on separate copies of the binary so that neither
+// benefits from the reachability cached by the other. The two frontiers are
+// checked to be identical after every step.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./centipede/binary_info.h"
+#include "./centipede/call_graph.h"
+#include "./centipede/config_init.h"
+#include "./centipede/control_flow.h"
+#include "./centipede/corpus.h"
+#include "./centipede/defs.h"
+#include "./centipede/feature.h"
+#include "./centipede/logging.h"
+#include "./centipede/pc_info.h"
+
+ABSL_FLAG(size_t, num_functions, 100000,
+          "Number of functions in the synthetic binary.");
+ABSL_FLAG(size_t, bbs_per_function, 10,
+          "Number of basic blocks in every function.");
+ABSL_FLAG(size_t, num_steps, 20,
+          "Number of times the frontier is brought up to date.");
+ABSL_FLAG(size_t, new_pcs_per_step, 1000,
+          "Number of PCs newly covered in every step.");
+
+namespace centipede {
+
+// A synthetic binary. Every basic block branches to the next one and, at
+// random, to the one after it. Every basic block calls a random function with
+// the probability of 1/4.
+void MakeSyntheticBinary(BinaryInfo &binary_info) {
+  const size_t num_functions = absl::GetFlag(FLAGS_num_functions);
+  const size_t bbs_per_function = absl::GetFlag(FLAGS_bbs_per_function);
+  QCHECK_GT(num_functions, 0);
+  QCHECK_GT(bbs_per_function, 0);
+  auto pc_of = [](size_t idx) { return (idx + 1) * 16; };
+  Rng rng(1);
+  PCTable &pc_table = binary_info.pc_table;
+  CFTable &cf_table = binary_info.cf_table;
+  for (size_t func = 0; func < num_functions; ++func) {
+    for (size_t bb = 0; bb < bbs_per_function; ++bb) {
+      const size_t idx = func * bbs_per_function + bb;
+      pc_table.push_back({pc_of(idx), bb == 0 ? PCInfo::kFuncEntry : 0});
+      cf_table.push_back(pc_of(idx));
+      if (bb + 1 < bbs_per_function) cf_table.push_back(pc_of(idx + 1));
+      if (bb + 2 < bbs_per_function && rng() % 2 == 0) {
+        cf_table.push_back(pc_of(idx + 2));
+      }
+      cf_table.push_back(0);
+      if (rng() % 4 == 0) {
+        cf_table.push_back(pc_of(rng() % num_functions * bbs_per_function));
+      }
+      cf_table.push_back(0);
+    }
+  }
+  binary_info.control_flow_graph.InitializeControlFlowGraph(cf_table,
+                                                            pc_table);
+  binary_info.call_graph.InitializeCallGraph(cf_table, pc_table);
+}
+
+void RunBenchmark() {
+  BinaryInfo binary_info_for_compute;
+  BinaryInfo binary_info_for_update;
+  MakeSyntheticBinary(binary_info_for_compute);
+  MakeSyntheticBinary(binary_info_for_update);
+  const size_t num_pcs = binary_info_for_compute.pc_table.size();
+  const size_t bbs_per_function = absl::GetFlag(FLAGS_bbs_per_function);
+  LOG(INFO) << absl::StrFormat("pcs: %d | functions: %d", num_pcs,
+                               num_pcs / bbs_per_function);
+
+  CoverageFrontier computed_frontier(binary_info_for_compute);
+  CoverageFrontier updated_frontier(binary_info_for_update);
+  std::vector<CorpusRecord> records;
+  // The number of covered basic blocks in every function, covered in order.
+  std::vector<size_t> num_covered_bbs(num_pcs / bbs_per_function);
+  size_t num_covered_pcs = 0;
+  absl::Duration total_compute_time;
+  absl::Duration total_update_time;
+  Rng rng(2);
+  for (size_t step = 0; step < absl::GetFlag(FLAGS_num_steps); ++step) {
+    CorpusRecord record;
+    for (size_t i = 0; i < absl::GetFlag(FLAGS_new_pcs_per_step) &&
+                       num_covered_pcs < num_pcs;) {
+      const size_t func = rng() % num_covered_bbs.size();
+      if (num_covered_bbs[func] == bbs_per_function) continue;
+      const size_t idx = func * bbs_per_function + num_covered_bbs[func]++;
+      record.features.push_back(feature_domains::kPCs.ConvertToMe(idx));
+      ++num_covered_pcs;
+      ++i;
+    }
+    records.push_back(std::move(record));
+
+    const absl::Time compute_start = absl::Now();
+    const size_t computed_num_functions = computed_frontier.Compute(records);
+    const absl::Duration compute_time = absl::Now() - compute_start;
+    const absl::Time update_start = absl::Now();
+    const size_t updated_num_functions = updated_frontier.Update(records);
+    const absl::Duration update_time = absl::Now() - update_start;
+    total_compute_time += compute_time;
+    total_update_time += update_time;
+
+    CHECK_EQ(computed_num_functions, updated_num_functions) << VV(step);
+    for (size_t idx = 0; idx < num_pcs; ++idx) {
+      CHECK_EQ(computed_frontier.PcIndexIsFrontier(idx),
+               updated_frontier.PcIndexIsFrontier(idx))
+          << VV(step) << VV(idx);
+      CHECK_EQ(computed_frontier.FrontierWeight(idx),
+               updated_frontier.FrontierWeight(idx))
+          << VV(step) << VV(idx);
+    }
+    LOG(INFO) << absl::StrFormat(
+        "step: %4d | covered pcs: %9d | frontier functions: %7d | "
+        "Compute: %10s | Update: %10s",
+        step, num_covered_pcs, updated_num_functions,
+        absl::FormatDuration(compute_time), absl::FormatDuration(update_time));
+  }
+  LOG(INFO) << absl::StrFormat(
+      "total | Compute: %10s | Update: %10s | speedup: %.1fx",
+      absl::FormatDuration(total_compute_time),
+      absl::FormatDuration(total_update_time),
+      absl::FDivDuration(total_compute_time,
+                         std::max(total_update_time, absl::Nanoseconds(1))));
+}
+
+}  // namespace centipede
+
+int main(int argc, absl::Nonnull<char **> argv) {
+  (void)centipede::config::InitRuntime(argc, argv);
+  centipede::RunBenchmark();
+  return EXIT_SUCCESS;
+}
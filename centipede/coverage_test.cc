@@ -33,9 +33,11 @@
 #include "absl/container/flat_hash_set.h"
 #include "./centipede/binary_info.h"
 #include "./centipede/control_flow.h"
+#include "./centipede/defs.h"
 #include "./centipede/environment.h"
 #include "./centipede/feature.h"
 #include "./centipede/pc_info.h"
+#include "./centipede/runner_result.h"
 #include "./centipede/symbol_table.h"
 #include "./centipede/test_coverage_util.h"
 #include "./centipede/test_util.h"
@@ -182,6 +184,12 @@ static std::string GetThreadedTargetPath() {
   return GetDataDependencyFilepath("centipede/testing/threaded_fuzz_target");
 }
 
+// Returns path to user_defined_features_target.
+static std::string GetUserDefinedFeaturesTargetPath() {
+  return GetDataDependencyFilepath(
+      "centipede/testing/user_defined_features_target");
+}
+
 // Tests coverage collection on test_fuzz_target
 // using two inputs that trigger different code paths.
 TEST(Coverage, CoverageFeatures) {
@@ -381,6 +389,35 @@ TEST(Coverage, CMPFeaturesExecute) {
             ExtractDomainFeatures(features[1], feature_domains::k8bitCounters));
 }
 
+// Tests __sanitizer_cov_trace_switch.
+TEST(Coverage, CMPSwitchFeaturesExecute) {
+  Environment env;
+  env.binary = GetTargetPath();
+  // Returns an input that makes the target switch on `value`, with the cases
+  // 1000, 2000, 3000 and 4000 (see test_fuzz_target.cc).
+  auto switch_input = [](uint32_t value) {
+    std::string input = "swch";
+    input.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    return input;
+  };
+  auto features = RunInputsAndCollectCoverage(
+      env, {switch_input(2000), switch_input(3000), switch_input(2001),
+            switch_input(2100)});
+  ASSERT_EQ(features.size(), 4);
+  std::vector<FeatureVec> switch_features;
+  for (const FeatureVec &input_features : features) {
+    switch_features.push_back(
+        ExtractDomainFeatures(input_features, feature_domains::kCMPSwitch));
+    EXPECT_FALSE(switch_features.back().empty());
+  }
+  // Different matched cases.
+  EXPECT_NE(switch_features[0], switch_features[1]);
+  // No case matched, different distances to the closest case.
+  EXPECT_NE(switch_features[2], switch_features[3]);
+  // A matched case vs no case matched.
+  EXPECT_NE(switch_features[0], switch_features[2]);
+}
+
 // Tests memcmp interceptor.
 TEST(Coverage, CMPFeaturesFromMemcmp) {
   Environment env;
@@ -469,6 +506,38 @@ TEST(Coverage, FunctionFilter) {
   EXPECT_FALSE(both_func_filter.filter(other));
 }
 
+TEST(Coverage, SymbolizesPCsInChunks) {
+  const std::string tmp_dir = GetTestTempDir(test_info_->name()).string();
+  BinaryInfo binary_info;
+  binary_info.InitializeFromSanCovBinary(GetTargetPath(), GetObjDumpPath(),
+                                         GetLLVMSymbolizerPath(), tmp_dir);
+  const PCTable &pc_table = binary_info.pc_table;
+  ASSERT_GT(pc_table.size(), 3);
+  const DsoTable dso_table = {{GetTargetPath(), pc_table.size()}};
+  SymbolTable symbols;
+  EXPECT_TRUE(symbols.GetSymbolsFromBinary(pc_table, dso_table,
+                                           GetLLVMSymbolizerPath(), tmp_dir,
+                                           /*max_pcs_per_symbolizer_run=*/3));
+  EXPECT_EQ(symbols, binary_info.symbols);
+}
+
+TEST(Coverage, SymbolTableIsCachedAndReused) {
+  const std::filesystem::path tmp_dir = GetTestTempDir(test_info_->name());
+  const std::string cache_path = tmp_dir / "symbol-table-cache";
+  std::filesystem::remove(cache_path);
+  BinaryInfo binary_info;
+  binary_info.InitializeFromSanCovBinary(GetTargetPath(), GetObjDumpPath(),
+                                         GetLLVMSymbolizerPath(),
+                                         tmp_dir.string(), cache_path);
+  ASSERT_TRUE(std::filesystem::exists(cache_path));
+  // Without a symbolizer, the symbols can only come from the cache.
+  BinaryInfo cached_binary_info;
+  cached_binary_info.InitializeFromSanCovBinary(
+      GetTargetPath(), GetObjDumpPath(), /*symbolizer_path=*/"",
+      tmp_dir.string(), cache_path);
+  EXPECT_EQ(cached_binary_info.symbols, binary_info.symbols);
+}
+
 TEST(Coverage, ThreadedTest) {
   Environment env;
   env.path_level = 10;
@@ -491,6 +560,71 @@ TEST(Coverage, ThreadedTest) {
   }
 }
 
+// Tests that a persistent runner keeps serving batches after a batch whose
+// inputs didn't all fit into the shared memory.
+TEST(Coverage, PersistentRunnerSurvivesPartiallyWrittenBatches) {
+  Environment env;
+  env.binary = GetTargetPath();
+  env.persistent_mode = true;
+  env.shmem_size_mb = 1;
+  std::filesystem::create_directories(TemporaryLocalDirPath());
+  TestCallbacks callbacks(env);
+  // Only the first input fits, so the runner reads fewer inputs than the
+  // batch announces.
+  const std::vector<ByteArray> large_inputs(3, ByteArray(600 * 1024, 'x'));
+  const std::vector<ByteArray> small_inputs = {{'f', 'u', 'z', 'z'}};
+  for (int i = 0; i < 3; ++i) {
+    BatchResult batch_result;
+    // TestCallbacks::Execute() checks that the runner succeeded.
+    ASSERT_TRUE(callbacks.Execute(env.binary, large_inputs, batch_result));
+    EXPECT_EQ(batch_result.num_outputs_read(), 1);
+    ASSERT_TRUE(callbacks.Execute(env.binary, small_inputs, batch_result));
+    EXPECT_EQ(batch_result.num_outputs_read(), 1);
+  }
+}
+
+// Returns the input that user_defined_features_target has executed, as
+// recovered from its user-defined `features`: for each input byte, the target
+// emits a feature with the byte's position and value.
+static ByteArray RecoverUserDefinedFeaturesTargetInput(
+    const FeatureVec &features) {
+  ByteArray input;
+  for (auto feature : features) {
+    for (size_t domain_id = 0; domain_id < 2; ++domain_id) {
+      const auto &domain = feature_domains::kUserDomains[domain_id];
+      if (!domain.Contains(feature)) continue;
+      const size_t index =
+          feature_domains::Domain::FeatureToIndexInDomain(feature);
+      const size_t pos = index >> 8;
+      if (pos >= input.size()) input.resize(pos + 1);
+      input[pos] = index & 0xFF;
+    }
+  }
+  return input;
+}
+
+// Tests that the runner passes every input of a batch from the shared memory
+// to the target unchanged, whether it executes the inputs in place or, in
+// sanitized builds, from exactly sized copies.
+TEST(Coverage, RunnerPassesBatchInputsUnchanged) {
+  Environment env;
+  env.binary = GetUserDefinedFeaturesTargetPath();
+  // No input starts with a 0 byte: the target would emit a zero feature for it,
+  // which the runner ignores.
+  std::string all_bytes(1000, 0);
+  for (size_t i = 0; i < all_bytes.size(); ++i) all_bytes[i] = (i + 1) % 256;
+  const std::vector<std::string> inputs = {
+      "fuzz", "ab", "ba", std::string("\x01\x00\xFF", 3), all_bytes, "fuzz"};
+  const std::vector<FeatureVec> features =
+      RunInputsAndCollectCoverage(env, inputs);
+  ASSERT_EQ(features.size(), inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    EXPECT_EQ(RecoverUserDefinedFeaturesTargetInput(features[i]),
+              ByteArray(inputs[i].begin(), inputs[i].end()))
+        << "input " << i;
+  }
+}
+
 TEST(FrontierWeight, ComputeFrontierWeight) {
   PCTable g_pc_table{{0, PCInfo::kFuncEntry},
                      {1, PCInfo::kFuncEntry},
@@ -22,6 +22,7 @@
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <queue>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -29,6 +30,7 @@
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -45,6 +47,7 @@
 #include "./centipede/logging.h"
 #include "./centipede/periodic_action.h"
 #include "./centipede/remote_file.h"
+#include "./centipede/remote_file_reader.h"
 #include "./centipede/resource_pool.h"
 #include "./centipede/rusage_profiler.h"
 #include "./centipede/rusage_stats.h"
@@ -97,6 +100,13 @@ inline constexpr perf::RUsageMemory kRamQuota{.mem_rss = 25 * kGB};
 // by its concurrent siblings.
 inline constexpr absl::Duration kRamLeaseTimeout = absl::Hours(5);
 
+// The cost of keeping an input in a corpus distilled with
+// `--distill_set_cover`, on top of the input's size in bytes. Accounts for the
+// fixed per-input overhead of storing, loading and executing the input, so
+// that splitting the coverage between many tiny inputs doesn't look cheaper
+// than keeping a single somewhat larger one.
+inline constexpr size_t kSetCoverPerInputCost = 1024;
+
 std::string LogPrefix(const Environment &env) {
   return absl::StrCat("DISTILL[S.", env.my_shard_index, "]: ");
 }
@@ -141,13 +151,16 @@ class InputCorpusShardReader {
         corpus_path, features_path,
         [&elts](ByteArray input, FeatureVec features) {
           elts.emplace_back(std::move(input), std::move(features));
-        });
+        },
+        &store_reader_);
     return elts;
   }
 
  private:
   const WorkDir workdir_;
   const std::string log_prefix_;
+  // Shared by the concurrent `ReadShard()` calls.
+  AsyncRemoteFileReader store_reader_{kMaxCorpusStoreReadThreads};
 };
 
 // A helper class for writing corpus shards. Thread-safe.
@@ -253,13 +266,17 @@ class DistillingInputFilter {
   // equivalent set will be rejected.
   // `should_discard_domains` specifies the domains that should be discarded
   // from the feature set of a filtered input.
+  // `use_sparse_storage` selects the storage backend of the seen features, see
+  // `FeatureSet`.
   DistillingInputFilter(  //
       uint8_t feature_frequency_threshold,
-      const FeatureSet::FeatureDomainSet &domains_to_discard)
+      const FeatureSet::FeatureDomainSet &domains_to_discard,
+      bool use_sparse_storage)
       : seen_inputs_{},
         seen_features_{
             /*frequency_threshold=*/feature_frequency_threshold,
             /*should_discard_domain=*/domains_to_discard,
+            /*use_sparse_storage=*/use_sparse_storage,
         } {}
 
   std::optional<CorpusElt> FilterElt(CorpusElt elt) {
@@ -315,6 +332,50 @@ class DistilledCorpusShardWriter : public CorpusShardWriter {
   DistillingInputFilter &input_filter_;
 };
 
+// The RAM budget of the reading threads of `SelectInputsBySetCover()`. Unlike
+// the shards read so far, what is retained of them is held until the selection
+// is done, so it permanently shrinks the budget left for reading the remaining
+// shards. Thread-safe.
+class SetCoverRamBudget {
+ public:
+  explicit SetCoverRamBudget(perf::MemSize quota) : quota_{quota} {}
+
+  // Blocks until reading `read_bytes` more fits in the quota along with the
+  // other reads in flight and the retained bytes. CHECK-fails if it doesn't fit
+  // with no other reads in flight, as then it never will.
+  void AcquireForRead(size_t shard_idx, perf::MemSize read_bytes) {
+    absl::MutexLock lock{&mu_};
+    while (num_reads_ > 0 && retained_ + reading_ + read_bytes > quota_) {
+      cv_.Wait(&mu_);
+    }
+    CHECK_LE(retained_ + read_bytes, quota_)
+        << "Not enough RAM to distill with --distill_set_cover: the inputs "
+           "retained from the shards read so far take "
+        << retained_ << " bytes and reading shard " << shard_idx << " takes "
+        << read_bytes << " more, over the quota of " << quota_ << " bytes";
+    reading_ += read_bytes;
+    ++num_reads_;
+  }
+
+  // Returns the `read_bytes` of a finished read and charges the
+  // `retained_bytes` of the read shard instead.
+  void ReleaseRead(perf::MemSize read_bytes, perf::MemSize retained_bytes) {
+    absl::MutexLock lock{&mu_};
+    reading_ -= read_bytes;
+    retained_ += retained_bytes;
+    --num_reads_;
+    cv_.SignalAll();
+  }
+
+ private:
+  const perf::MemSize quota_;
+  absl::Mutex mu_;
+  absl::CondVar cv_;
+  perf::MemSize retained_ ABSL_GUARDED_BY(mu_) = 0;
+  perf::MemSize reading_ ABSL_GUARDED_BY(mu_) = 0;
+  size_t num_reads_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
 }  // namespace
 
 // Runs one independent distillation task. Reads shards in the order specified
@@ -375,6 +436,239 @@ void DistillToOneOutputShard(                          //
             << env.my_shard_index;
 }
 
+// For each of the input shards, whether each of its inputs (in the order of
+// `ReadShard()`) is selected for the distilled corpus.
+using SelectedInputs = absl::flat_hash_map<size_t /*shard_idx*/,
+                                           std::vector<bool> /*is_selected*/>;
+
+// Selects the inputs for the distilled corpus (--distill_set_cover) by
+// computing a greedy weighted set cover of the features of all the inputs in
+// `shard_indices`: repeatedly selects the input with the most features not yet
+// covered by `feature_frequency_threshold` selected inputs per unit of cost,
+// where the cost of an input is its size plus `kSetCoverPerInputCost`.
+// Byte-identical inputs are considered only once.
+//
+// Reads the shards with up to `parallelism` threads, within `ram_quota` bytes.
+// Only the features, the costs and the hashes of the inputs are retained after
+// a shard is read; their actual size stays charged to `ram_quota` until the
+// selection is done. CHECK-fails if they leave too little of `ram_quota` to
+// read the next shard. The selection itself is single-threaded and
+// deterministic.
+SelectedInputs SelectInputsBySetCover(         //
+    const Environment &env,                    //
+    const std::vector<size_t> &shard_indices,  //
+    uint8_t feature_frequency_threshold,       //
+    perf::MemSize ram_quota,                   //
+    int parallelism) {
+  LOG(INFO) << LogPrefix() << "Computing the set cover of "
+            << shard_indices.size() << " input shards";
+
+  // An input that can be selected.
+  struct Candidate {
+    // The features of the input not yet covered by the selected inputs.
+    // Shrinks as more inputs are selected.
+    FeatureVec features;
+    double cost = 0;
+    size_t shard_idx = 0;
+    size_t pos_in_shard = 0;
+  };
+  // The candidates and the input hashes of every shard, in the order of
+  // `shard_indices`.
+  std::vector<std::vector<Candidate>> candidates_per_shard(
+      shard_indices.size());
+  std::vector<std::vector<std::string>> hashes_per_shard(shard_indices.size());
+  const FeatureSet discarding_set{
+      /*frequency_threshold=*/feature_frequency_threshold,
+      /*should_discard_domain=*/env.MakeDomainDiscardMask(),
+      /*use_sparse_storage=*/env.use_sparse_feature_set,
+  };
+  SetCoverRamBudget ram_budget{ram_quota};
+  InputCorpusShardReader reader{env};
+  {
+    ThreadPool threads{parallelism};
+    for (size_t i = 0; i < shard_indices.size(); ++i) {
+      threads.Schedule([shard_idx = shard_indices[i],
+                        &candidates = candidates_per_shard[i],
+                        &hashes = hashes_per_shard[i], &reader,
+                        &discarding_set, &ram_budget] {
+        const perf::MemSize read_bytes = reader.EstimateRamFootprint(shard_idx);
+        ram_budget.AcquireForRead(shard_idx, read_bytes);
+        {
+          CorpusEltVec shard_elts = reader.ReadShard(shard_idx);
+          candidates.reserve(shard_elts.size());
+          hashes.reserve(shard_elts.size());
+          for (size_t pos = 0; pos < shard_elts.size(); ++pos) {
+            CorpusElt &elt = shard_elts[pos];
+            discarding_set.PruneDiscardedDomains(elt.features);
+            elt.features.shrink_to_fit();
+            hashes.push_back(Hash(elt.input));
+            candidates.push_back({
+                .features = std::move(elt.features),
+                .cost = static_cast<double>(elt.input.size() +
+                                            kSetCoverPerInputCost),
+                .shard_idx = shard_idx,
+                .pos_in_shard = pos,
+            });
+          }
+        }  // The shard's inputs are freed here.
+
+        // Charge the budget with the retained features and hashes instead.
+        size_t retained_bytes = candidates.capacity() * sizeof(Candidate) +
+                                hashes.capacity() * sizeof(std::string);
+        for (const Candidate &candidate : candidates) {
+          retained_bytes += candidate.features.capacity() * sizeof(feature_t);
+        }
+        for (const std::string &hash : hashes) {
+          retained_bytes += hash.capacity();
+        }
+        ram_budget.ReleaseRead(read_bytes,
+                               static_cast<perf::MemSize>(retained_bytes));
+      });
+    }
+  }  // The threads join here.
+
+  // Deduplicate byte-identical inputs, in the order of `shard_indices` for
+  // determinism, and flatten the candidates.
+  SelectedInputs selected;
+  std::vector<Candidate> candidates;
+  size_t num_total_inputs = 0;
+  absl::flat_hash_set<std::string> seen_hashes;
+  for (size_t i = 0; i < shard_indices.size(); ++i) {
+    selected[shard_indices[i]].resize(candidates_per_shard[i].size());
+    num_total_inputs += candidates_per_shard[i].size();
+    for (size_t pos = 0; pos < candidates_per_shard[i].size(); ++pos) {
+      if (!seen_hashes.insert(std::move(hashes_per_shard[i][pos])).second) {
+        continue;
+      }
+      candidates.push_back(std::move(candidates_per_shard[i][pos]));
+    }
+    std::vector<Candidate>().swap(candidates_per_shard[i]);
+    std::vector<std::string>().swap(hashes_per_shard[i]);
+  }
+  absl::flat_hash_set<std::string>().swap(seen_hashes);
+
+  // Lazy greedy selection: an input's number of uncovered features can only
+  // decrease as more inputs are selected, so a previously computed priority is
+  // an upper bound of the current one. The top input is therefore selected if
+  // its recomputed priority still isn't below the next one's; otherwise, it is
+  // requeued with the recomputed priority. Ties go to the earlier input.
+  using QueueEntry = std::pair<double /*priority*/, size_t /*candidate_idx*/>;
+  auto lower_priority = [](const QueueEntry &a, const QueueEntry &b) {
+    if (a.first != b.first) return a.first < b.first;
+    return a.second > b.second;
+  };
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      decltype(lower_priority)>
+      queue{lower_priority};
+  for (size_t idx = 0; idx < candidates.size(); ++idx) {
+    const Candidate &candidate = candidates[idx];
+    if (candidate.features.empty()) continue;
+    queue.emplace(candidate.features.size() / candidate.cost, idx);
+  }
+  FeatureSet covered_features{
+      /*frequency_threshold=*/feature_frequency_threshold,
+      /*should_discard_domain=*/env.MakeDomainDiscardMask(),
+      /*use_sparse_storage=*/env.use_sparse_feature_set,
+  };
+  size_t num_selected_inputs = 0;
+  while (!queue.empty()) {
+    const size_t idx = queue.top().second;
+    queue.pop();
+    Candidate &candidate = candidates[idx];
+    covered_features.PruneFeaturesAndCountUnseen(candidate.features);
+    if (candidate.features.empty()) continue;
+    const double priority = candidate.features.size() / candidate.cost;
+    if (!queue.empty() && priority < queue.top().first) {
+      queue.emplace(priority, idx);
+      continue;
+    }
+    covered_features.IncrementFrequencies(candidate.features);
+    selected[candidate.shard_idx][candidate.pos_in_shard] = true;
+    ++num_selected_inputs;
+    FeatureVec().swap(candidate.features);
+  }
+
+  LOG(INFO) << LogPrefix() << covered_features
+            << " inputs: " << num_total_inputs
+            << " unique: " << candidates.size()
+            << " distilled: " << num_selected_inputs;
+  return selected;
+}
+
+// Writes the inputs from `shard_indices` that are marked in `selected` to
+// `WorkDir{env}.DistilledPath()`, in the order of `shard_indices`. Similar to
+// `DistillToOneOutputShard()`, but the inputs have already been selected, so
+// the output doesn't depend on `parallelism`.
+void WriteSelectedToOneOutputShard(                    //
+    const Environment &env,                            //
+    const std::vector<size_t> &shard_indices,          //
+    const SelectedInputs &selected,                    //
+    perf::ResourcePool<perf::RUsageMemory> &ram_pool,  //
+    int parallelism) {
+  LOG(INFO) << LogPrefix(env) << "Writing selected inputs to output shard "
+            << env.my_shard_index << "; input shard indices:\n"
+            << absl::StrJoin(shard_indices, ", ");
+
+  // The features written to the output shard are pruned the same way as by
+  // `DistillingInputFilter`.
+  const FeatureSet discarding_set{
+      /*frequency_threshold=*/1,
+      /*should_discard_domain=*/env.MakeDomainDiscardMask(),
+      /*use_sparse_storage=*/env.use_sparse_feature_set,
+  };
+  InputCorpusShardReader reader{env};
+  // NOTE: Always overwrite corpus and features files, never append.
+  CorpusShardWriter writer{env, /*append=*/false};
+  // Read the shards in parallel, but write them in order.
+  std::vector<std::optional<CorpusEltVec>> selected_elts_per_shard(
+      shard_indices.size());
+  absl::Mutex mu;
+  size_t num_written_shards = 0;
+  {
+    ThreadPool threads{parallelism};
+    for (size_t i = 0; i < shard_indices.size(); ++i) {
+      threads.Schedule([i, &shard_indices, &selected, &selected_elts_per_shard,
+                        &reader, &writer, &discarding_set, &env, &ram_pool,
+                        &mu, &num_written_shards] {
+        const size_t shard_idx = shard_indices[i];
+        CorpusEltVec selected_elts;
+        {
+          const auto ram_lease = ram_pool.AcquireLeaseBlocking({
+              .id = absl::StrCat("out_", env.my_shard_index, "/in_",
+                                 shard_idx),
+              .amount = {.mem_rss = reader.EstimateRamFootprint(shard_idx)},
+              .timeout = kRamLeaseTimeout,
+          });
+          CHECK_OK(ram_lease.status());
+          CorpusEltVec shard_elts = reader.ReadShard(shard_idx);
+          const std::vector<bool> &is_selected = selected.at(shard_idx);
+          CHECK_EQ(shard_elts.size(), is_selected.size())
+              << "Shard changed during distillation: " << VV(shard_idx);
+          for (size_t pos = 0; pos < shard_elts.size(); ++pos) {
+            if (!is_selected[pos]) continue;
+            discarding_set.PruneDiscardedDomains(shard_elts[pos].features);
+            selected_elts.push_back(std::move(shard_elts[pos]));
+          }
+        }
+        absl::MutexLock lock{&mu};
+        selected_elts_per_shard[i] = std::move(selected_elts);
+        // Write all the consecutive shards that are ready.
+        while (num_written_shards < shard_indices.size() &&
+               selected_elts_per_shard[num_written_shards].has_value()) {
+          writer.WriteBatch(
+              *std::move(selected_elts_per_shard[num_written_shards]));
+          selected_elts_per_shard[num_written_shards].reset();
+          ++num_written_shards;
+        }
+      });
+    }
+  }  // The threads join here.
+
+  const CorpusShardWriter::Stats stats = writer.GetStats();
+  LOG(INFO) << LogPrefix(env) << "Done writing to output shard "
+            << env.my_shard_index << "; written: " << stats.num_written_elts;
+}
+
 int Distill(const Environment &env, const DistillOptions &opts) {
   RPROF_THIS_FUNCTION_WITH_TIMELAPSE(                                      //
       /*enable=*/ABSL_VLOG_IS_ON(1),                                       //
@@ -401,6 +695,29 @@ int Distill(const Environment &env, const DistillOptions &opts) {
     thread_idx = (thread_idx + 1) % env.num_threads;
   }
 
+  if (env.distill_set_cover) {
+    const SelectedInputs selected = SelectInputsBySetCover(  //
+        env, all_shard_indices, opts.feature_frequency_threshold,
+        kRamQuota.mem_rss, kMaxReadingThreads);
+    // The RAM pool shared between all the output shard writers.
+    perf::ResourcePool ram_pool{kRamQuota};
+    {
+      const size_t num_threads = std::min(env.num_threads, kMaxWritingThreads);
+      ThreadPool threads{static_cast<int>(num_threads)};
+      for (size_t thread_idx = 0; thread_idx < env.num_threads; ++thread_idx) {
+        threads.Schedule(
+            [&thread_env = envs_per_thread[thread_idx],
+             &thread_shard_indices = shard_indices_per_thread[thread_idx],
+             &selected, &ram_pool]() {
+              WriteSelectedToOneOutputShard(  //
+                  thread_env, thread_shard_indices, selected, ram_pool,
+                  kMaxReadingThreads);
+            });
+      }
+    }  // The threads join here.
+    return EXIT_SUCCESS;
+  }
+
   // Run the distillation threads in parallel.
   {
     // A global input filter shared by all output shard writers. The output
@@ -409,6 +726,7 @@ int Distill(const Environment &env, const DistillOptions &opts) {
     DistillingInputFilter input_filter{
         opts.feature_frequency_threshold,
         env.MakeDomainDiscardMask(),
+        env.use_sparse_feature_set,
     };
     // A periodic logger of the global distillation progress. Runs on a separate
     // thread.
@@ -450,13 +768,28 @@ int Distill(const Environment &env, const DistillOptions &opts) {
 }
 
 void DistillForTests(const Environment &env,
-                     const std::vector<size_t> &shard_indices) {
+                     const std::vector<size_t> &shard_indices,
+                     std::optional<size_t> ram_quota) {
+  // Do not limit the max RAM, unless asked to.
+  const perf::RUsageMemory ram_limit =
+      ram_quota.has_value()
+          ? perf::RUsageMemory{.mem_rss = static_cast<perf::MemSize>(
+                                   *ram_quota)}
+          : perf::RUsageMemory::Max();
+  perf::ResourcePool ram_pool{ram_limit};
+  if (env.distill_set_cover) {
+    const SelectedInputs selected = SelectInputsBySetCover(  //
+        env, shard_indices, /*feature_frequency_threshold=*/1,
+        ram_limit.mem_rss, /*parallelism=*/1);
+    WriteSelectedToOneOutputShard(  //
+        env, shard_indices, selected, ram_pool, /*parallelism=*/1);
+    return;
+  }
   DistillingInputFilter input_filter{
       /*feature_frequency_threshold=*/1,
       env.MakeDomainDiscardMask(),
+      env.use_sparse_feature_set,
   };
-  // Do not limit the max RAM.
-  perf::ResourcePool ram_pool{perf::RUsageMemory::Max()};
   // Read the input shards sequentially and in order to ensure deterministic
   // outputs.
   DistillToOneOutputShard(  //
@@ -17,6 +17,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "./centipede/environment.h"
@@ -26,6 +27,8 @@ namespace centipede {
 // Options for `Distill()`.
 struct DistillOptions {
   // From each feature-equivalent set of inputs, select up to this many winners.
+  // With `Environment::distill_set_cover`, cover each feature by up to this
+  // many selected inputs instead.
   uint8_t feature_frequency_threshold = 1;
 };
 
@@ -37,14 +40,20 @@ struct DistillOptions {
 // that is that the results are generally non-deterministic (for a given
 // feature-equivalent set of inputs, any one can win and make it to the output).
 //
+// With `env.distill_set_cover`, the inputs are instead selected up front by a
+// greedy weighted set cover of the features of all the input shards, which
+// favors small inputs and is deterministic. The selected inputs are then
+// written to the output shards in parallel.
+//
 // Returns EXIT_SUCCESS.
 int Distill(const Environment &env, const DistillOptions &opts = {});
 
 // Same as `Distill()`, but runs distillation without I/O parallelization and
 // reads shards in the order specified by `shard_indices` for deterministic
-// results.
+// results. Limits the RAM to `ram_quota` bytes, if set.
 void DistillForTests(const Environment &env,
-                     const std::vector<size_t> &shard_indices);
+                     const std::vector<size_t> &shard_indices,
+                     std::optional<size_t> ram_quota = std::nullopt);
 
 }  // namespace centipede
 
@@ -17,6 +17,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -93,25 +94,33 @@ std::vector<TestCorpusRecord> ReadFromDistilled(const WorkDir &wd) {
   return result;
 }
 
-// Distills `shards` in the order specified by `shard_indices`,
-// returns the distilled corpus as a vector of inputs.
+// Returns the environment in which `TestDistill()` distills for `test_name`.
+Environment GetTestDistillEnv(std::string_view test_name) {
+  Environment env;
+  env.workdir = GetTestTempDir(test_name);
+  env.binary = "binary_that_is_not_here";
+  env.binary_hash = "01234567890";
+  env.my_shard_index = 1;  // an arbitrary shard index.
+  return env;
+}
+
+// Distills `shards` in the order specified by `shard_indices` within
+// `ram_quota` bytes, if set, and returns the distilled corpus as a vector of
+// inputs.
 std::vector<TestCorpusRecord> TestDistill(
     const ShardVec &shards, const std::vector<size_t> &shard_indices,
-    std::string_view test_name, uint64_t user_feature_domain_mask) {
+    std::string_view test_name, uint64_t user_feature_domain_mask,
+    bool set_cover = false, std::optional<size_t> ram_quota = std::nullopt) {
   // Set up the environment.
   // We need to set at least --binary_hash before `env` is constructed,
   // so we do this by overriding the flags.
   absl::FlagSaver flag_saver;
-  std::string dir = GetTestTempDir(test_name);
-  std::filesystem::remove_all(dir);
-  std::filesystem::create_directories(dir);
-  Environment env;
-  env.workdir = dir;
-  env.binary = "binary_that_is_not_here";
-  env.binary_hash = "01234567890";
+  Environment env = GetTestDistillEnv(test_name);
+  std::filesystem::remove_all(env.workdir);
+  std::filesystem::create_directories(env.workdir);
   env.total_shards = shards.size();
-  env.my_shard_index = 1;  // an arbitrary shard index.
   env.user_feature_domain_mask = user_feature_domain_mask;
+  env.distill_set_cover = set_cover;
   const WorkDir wd{env};
   std::filesystem::create_directories(wd.CoverageDirPath());
 
@@ -122,7 +131,7 @@ std::vector<TestCorpusRecord> TestDistill(
     }
   }
   // Distill.
-  DistillForTests(env, shard_indices);
+  DistillForTests(env, shard_indices, ram_quota);
   // Read the result back.
   return ReadFromDistilled(wd);
 }
@@ -187,6 +196,103 @@ TEST(Distill, BasicDistill) {
               }));
 }
 
+TEST(Distill, SetCoverDistill) {
+  ByteArray in0 = {0};
+  ByteArray in1 = {1};
+  ByteArray in2 = {2};
+  ByteArray in3 = {3};
+  ByteArray in4 = {4};
+  ByteArray in5 = {5};
+  ByteArray big(4000, 6);
+
+  ShardVec shards = {
+      // shard 0
+      {
+          {in0, {10, 20}},
+          {big, {10, 20, 30, 40}},
+      },
+      // shard 1
+      {
+          {in1, {30}},
+          {in2, {40}},
+          {in3, {30, 40}},
+          {in0, {10, 20}},
+      },
+      // shard 2
+      {
+          {in4, {10}},
+          {in5, {20}},
+      },
+  };
+  // The default distillation keeps every input that adds features.
+  EXPECT_THAT(TestDistill(shards, {2, 1, 0}, test_info_->name(), 0),
+              UnorderedElementsAreArray({
+                  EqualsTestCorpusRecord(in5, FeatureVec{20}),
+                  EqualsTestCorpusRecord(in4, FeatureVec{10}),
+                  EqualsTestCorpusRecord(in3, FeatureVec{30, 40}),
+              }));
+  EXPECT_THAT(TestDistill(shards, {0, 1, 2}, test_info_->name(), 0),
+              UnorderedElementsAreArray({
+                  EqualsTestCorpusRecord(big, FeatureVec{10, 20, 30, 40}),
+              }));
+  // The set cover selects the fewest small inputs covering all the features,
+  // regardless of the order of the shards, and skips the duplicate `in0`.
+  for (const std::vector<size_t> &shard_indices :
+       std::vector<std::vector<size_t>>{{2, 1, 0}, {0, 1, 2}, {1, 2, 0}}) {
+    EXPECT_THAT(
+        TestDistill(shards, shard_indices, test_info_->name(), 0,
+                    /*set_cover=*/true),
+        UnorderedElementsAreArray({
+            EqualsTestCorpusRecord(in0, FeatureVec{10, 20}),
+            EqualsTestCorpusRecord(in3, FeatureVec{30, 40}),
+        }));
+  }
+}
+
+TEST(Distill, SetCoverDistillFailsFastWithSmallRamQuota) {
+  ByteArray in0 = {0};
+  ByteArray in1 = {1};
+
+  ShardVec shards = {
+      // shard 0
+      {
+          {in0, {10, 20}},
+      },
+      // shard 1
+      {
+          {in1, {30, 40}},
+      },
+  };
+  EXPECT_THAT(TestDistill(shards, {0, 1}, test_info_->name(), 0,
+                          /*set_cover=*/true),
+              UnorderedElementsAreArray({
+                  EqualsTestCorpusRecord(in0, FeatureVec{10, 20}),
+                  EqualsTestCorpusRecord(in1, FeatureVec{30, 40}),
+              }));
+
+  // The RAM that the distillation estimates for reading a shard: the corpus
+  // and the features files take up to 5x and 10x their size in RAM. The two
+  // shards have the same size.
+  const Environment env = GetTestDistillEnv(test_info_->name());
+  const WorkDir wd{env};
+  std::vector<size_t> shard_read_bytes;
+  for (size_t shard_index = 0; shard_index < shards.size(); ++shard_index) {
+    const auto corpus_path = wd.CorpusFiles().ShardPath(shard_index);
+    const auto features_path = wd.FeaturesFiles().ShardPath(shard_index);
+    shard_read_bytes.push_back(5 * std::filesystem::file_size(corpus_path) +
+                               10 * std::filesystem::file_size(features_path));
+  }
+  ASSERT_EQ(shard_read_bytes[0], shard_read_bytes[1]);
+
+  // The quota fits reading either shard, but not reading shard 1 on top of
+  // what is retained of shard 0. The distillation must fail right away rather
+  // than wait for RAM that is never freed.
+  EXPECT_DEATH(TestDistill(shards, {0, 1}, test_info_->name(), 0,
+                           /*set_cover=*/true,
+                           /*ram_quota=*/shard_read_bytes[0]),
+               "Not enough RAM to distill with --distill_set_cover");
+}
+
 // TODO(kcc): add more tests once we settle on the testing code above.
 
 }  // namespace
@@ -127,6 +127,7 @@ void Environment::SetFlagForExperiment(std::string_view name,
       {"crossover_level", &crossover_level},
       {"mutate_batch_size", &mutate_batch_size},
       {"feature_frequency_threshold", &feature_frequency_threshold},
+      {"max_pc_pairs_per_input", &max_pc_pairs_per_input},
   };
   auto int_iter = int_flags.find(name);
   if (int_iter != int_flags.end()) {
@@ -40,18 +40,23 @@ struct Environment {
   std::string coverage_binary;
   std::string clang_coverage_binary;
   std::vector<std::string> extra_binaries;
+  bool parallel_extra_binaries = false;
   std::string workdir;
   std::string merge_from;
   size_t num_runs = std::numeric_limits<size_t>::max();
   size_t total_shards = 1;
   size_t my_shard_index = 0;
   size_t num_threads = 1;
+  bool shared_coverage = false;
   size_t max_len = 4000;
   size_t batch_size = 1000;
+  size_t target_batch_time_ms = 0;
   size_t mutate_batch_size = 2;
   bool use_legacy_default_mutator = false;
   size_t load_other_shard_frequency = 10;
-  bool serialize_shard_loads = false;
+  size_t shard_load_parallelism = 8;
+  size_t shard_load_memory_budget_mb = 2048;
+  bool use_corpus_store = false;
   size_t seed = 0;
   size_t prune_frequency = 100;
   size_t address_space_limit_mb = 8192;
@@ -60,6 +65,7 @@ struct Environment {
   size_t timeout_per_batch = 0;
   absl::Time stop_at = absl::InfiniteFuture();
   bool fork_server = true;
+  bool persistent_mode = false;
   bool full_sync = false;
   bool use_corpus_weights = true;
   bool use_coverage_frontier = false;
@@ -73,12 +79,15 @@ struct Environment {
   bool use_dataflow_features = true;
   bool use_counter_features = false;
   bool use_pcpair_features = false;
+  size_t max_pc_pairs_per_input = 0;
   uint64_t user_feature_domain_mask = ~0UL;
   size_t feature_frequency_threshold = 100;
+  bool use_sparse_feature_set = false;
   bool require_pc_table = true;
   int telemetry_frequency = 0;
   bool print_runner_log = false;
   bool distill = false;
+  bool distill_set_cover = false;
   size_t log_features_shards = 0;
   std::string knobs_file;
   std::string corpus_to_files;
@@ -65,6 +65,13 @@ ABSL_FLAG(std::vector<std::string>, extra_binaries, default_env->extra_binaries,
           "fed the same inputs as the main binary, but the coverage feedback "
           "from them is not collected. Use this e.g. to run the target under "
           "sanitizers.");
+ABSL_FLAG(bool, parallel_extra_binaries, default_env->parallel_extra_binaries,
+          "If true, every fuzzing thread executes each batch in --binary and "
+          "in all the --extra_binaries concurrently, using a separate thread, "
+          "shared memory and fork server for every extra binary. If false, "
+          "the binaries are executed one after another. Requires that "
+          "separate callbacks objects created by the callbacks factory can be "
+          "used concurrently from different threads.");
 ABSL_FLAG(std::string, workdir, default_env->workdir, "The working directory.");
 ABSL_FLAG(std::string, merge_from, default_env->merge_from,
           "Another working directory to merge the corpus from. Inputs from "
@@ -81,6 +88,12 @@ ABSL_FLAG(size_t, num_threads, default_env->num_threads,
           "Number of threads to execute in one process. i-th thread, where i "
           "is in [0, --num_threads), will work on shard "
           "(--first_shard_index + i).");
+ABSL_FLAG(bool, shared_coverage, default_env->shared_coverage,
+          "If true and --num_threads > 1, the fuzzing threads of this process "
+          "share one set of observed features, and an input added to the "
+          "corpus by one thread is also added to the in-memory corpora of the "
+          "other threads. Each thread still writes only the inputs it found to "
+          "its own shard. Incompatible with --use_sparse_feature_set.");
 ABSL_FLAG(size_t, j, 0,
           "If not 0, --j=N is a shorthand for "
           "--num_threads=N --total_shards=N --first_shard_index=0. "
@@ -94,6 +107,12 @@ ABSL_FLAG(size_t, batch_size, default_env->batch_size,
       QCHECK_GT(absl::GetFlag(FLAGS_batch_size), 0)
           << "--" << FLAGS_batch_size.Name() << " must be non-zero";
     });
+ABSL_FLAG(size_t, target_batch_time_ms, default_env->target_batch_time_ms,
+          "If not 0, the number of mutants per batch during fuzzing adapts to "
+          "the observed execution time, so that a batch takes about this many "
+          "milliseconds of wall time. --batch_size is then the initial batch "
+          "size, and batches grow to at most 10x --batch_size. Must be below "
+          "--timeout_per_batch.");
 ABSL_FLAG(size_t, mutate_batch_size, default_env->mutate_batch_size,
           "Mutate this many inputs to produce batch_size mutants");
 ABSL_FLAG(bool, use_legacy_default_mutator,
@@ -106,14 +125,27 @@ ABSL_FLAG(size_t, load_other_shard_frequency,
           "to disable loading other shards.  For now, choose the value of this "
           "flag so that shard loads happen at most once in a few minutes. In "
           "future we may be able to find the suitable value automatically.");
-// TODO(b/262798184): Remove once the bug is fixed.
-ABSL_FLAG(bool, serialize_shard_loads, default_env->serialize_shard_loads,
-          "When this flag is on, shard loading is serialized. "
-          " Useful to avoid excessive RAM consumption when loading more"
-          " that one shard at a time. Currently, loading a single large shard"
-          " may create too many temporary heap allocations. "
-          " This means, if we load many large shards concurrently,"
-          " we may run out or RAM.");
+ABSL_FLAG(size_t, shard_load_parallelism,
+          default_env->shard_load_parallelism,
+          "The number of threads that read shards concurrently when loading "
+          "many shards, e.g. with --full_sync or --distill. The shards are "
+          "still merged into the corpus one by one, in a random order.");
+ABSL_FLAG(size_t, shard_load_memory_budget_mb,
+          default_env->shard_load_memory_budget_mb,
+          "The approximate total size, in MB, of the shards that are read "
+          "into memory but not yet merged into the corpus, across all the "
+          "Centipede threads in the process. A shard larger than the budget "
+          "is loaded alone. Use 0 to load one shard at a time.");
+ABSL_RETIRED_FLAG(bool, serialize_shard_loads, false,
+                  "No longer supported: use --shard_load_memory_budget_mb=0 "
+                  "instead.");
+ABSL_FLAG(bool, use_corpus_store, default_env->use_corpus_store,
+          "If true, every input added to the corpus is written once to a "
+          "content-addressed store shared by all the shards "
+          "(<workdir>/corpus_store/), and the corpus files get only a small "
+          "reference to it. Saves disk space and I/O when the shards find the "
+          "same inputs, e.g. with --full_sync. Corpus files with references "
+          "are readable regardless of this flag.");
 ABSL_FLAG(size_t, prune_frequency, default_env->prune_frequency,
           "Prune the corpus every time after this many inputs were added. If "
           "zero, pruning is disabled. Pruning removes redundant inputs from "
@@ -172,6 +204,16 @@ ABSL_FLAG(bool, fork_server, default_env->fork_server,
           "'%f' to disable the fork server. --fork_server applies to binaries "
           "passed via these flags: --binary, --extra_binaries, "
           "--input_filter.");
+ABSL_FLAG(bool, persistent_mode, default_env->persistent_mode,
+          "If true, and --fork_server is true, the fork server runs in the "
+          "persistent mode: a single runner process executes batch after "
+          "batch, with the coverage reset between the batches, and is "
+          "re-forked only after a crash or a timeout. The control messages "
+          "are passed via shared memory instead of pipes. This removes the "
+          "per-batch fork, which dominates the execution time for very fast "
+          "targets, but the state leaked by the target (e.g. memory, global "
+          "variables) carries over from one batch to the next. Binaries that "
+          "do not support the persistent mode are forked for every batch.");
 ABSL_FLAG(bool, full_sync, default_env->full_sync,
           "Perform a full corpus sync on startup. If true, feature sets and "
           "corpora are read from all shards before fuzzing. This way fuzzing "
@@ -228,6 +270,12 @@ ABSL_FLAG(bool, use_counter_features, default_env->use_counter_features,
 ABSL_FLAG(bool, use_pcpair_features, default_env->use_pcpair_features,
           "If true, PC pairs are used as additional synthetic features. "
           "Experimental, use with care - it may explode the corpus.");
+ABSL_FLAG(size_t, max_pc_pairs_per_input, default_env->max_pc_pairs_per_input,
+          "With --use_pcpair_features, the maximal number of PC pairs "
+          "considered for every input: the pairs of the least frequent PCs in "
+          "the input with all its other PCs. If 0, all the pairs are "
+          "considered, which is quadratic by the number of PCs in the input. "
+          "See pc_pair_benchmark for the throughput with various values.");
 ABSL_FLAG(uint64_t, user_feature_domain_mask,
           default_env->user_feature_domain_mask,
           "A bitmask indicating which user feature domains should be enabled. "
@@ -244,6 +292,12 @@ ABSL_FLAG(size_t, feature_frequency_threshold,
           << "--" << FLAGS_feature_frequency_threshold.Name()
           << " must be in [2,255] but has value " << threshold;
     });
+ABSL_FLAG(bool, use_sparse_feature_set, default_env->use_sparse_feature_set,
+          "If true, feature frequencies are kept in per-domain hash tables "
+          "instead of one large mmap-ed array. Uses RAM proportional to the "
+          "number of distinct features rather than to the number of touched "
+          "pages, at the cost of slower lookups. Consider enabling for long "
+          "runs with many hashed features (cmp, dataflow, path, etc).");
 ABSL_FLAG(bool, require_pc_table, default_env->require_pc_table,
           "If true, Centipede will exit if the --pc_table is not found.");
 ABSL_FLAG(int, telemetry_frequency, default_env->telemetry_frequency,
@@ -296,6 +350,13 @@ ABSL_FLAG(bool, distill, default_env->distill,
           "loading the shards in random order. "
           "Each distillation thread writes a minimized (distilled) "
           "corpus to workdir/distilled-BINARY.`my_shard_index`.");
+ABSL_FLAG(bool, distill_set_cover, default_env->distill_set_cover,
+          "If true, --distill selects the inputs with a greedy weighted set "
+          "cover over the features of all the `total_shards` shards, instead "
+          "of keeping every input that has features unseen by the inputs "
+          "distilled before it. This yields a smaller distilled corpus that "
+          "favors small inputs, at the cost of keeping the features of the "
+          "entire corpus in memory.");
 ABSL_RETIRED_FLAG(size_t, distill_shards, 0,
                   "No longer supported: use --distill instead.");
 ABSL_FLAG(size_t, log_features_shards, default_env->log_features_shards,
@@ -443,20 +504,26 @@ Environment CreateEnvironmentFromFlags(const std::vector<std::string> &argv) {
       .coverage_binary = coverage_binary,
       .clang_coverage_binary = absl::GetFlag(FLAGS_clang_coverage_binary),
       .extra_binaries = absl::GetFlag(FLAGS_extra_binaries),
+      .parallel_extra_binaries = absl::GetFlag(FLAGS_parallel_extra_binaries),
       .workdir = absl::GetFlag(FLAGS_workdir),
       .merge_from = absl::GetFlag(FLAGS_merge_from),
       .num_runs = absl::GetFlag(FLAGS_num_runs),
       .total_shards = absl::GetFlag(FLAGS_total_shards),
       .my_shard_index = absl::GetFlag(FLAGS_first_shard_index),
       .num_threads = absl::GetFlag(FLAGS_num_threads),
+      .shared_coverage = absl::GetFlag(FLAGS_shared_coverage),
       .max_len = absl::GetFlag(FLAGS_max_len),
       .batch_size = absl::GetFlag(FLAGS_batch_size),
+      .target_batch_time_ms = absl::GetFlag(FLAGS_target_batch_time_ms),
       .mutate_batch_size = absl::GetFlag(FLAGS_mutate_batch_size),
       .use_legacy_default_mutator =
           absl::GetFlag(FLAGS_use_legacy_default_mutator),
       .load_other_shard_frequency =
           absl::GetFlag(FLAGS_load_other_shard_frequency),
-      .serialize_shard_loads = absl::GetFlag(FLAGS_serialize_shard_loads),
+      .shard_load_parallelism = absl::GetFlag(FLAGS_shard_load_parallelism),
+      .shard_load_memory_budget_mb =
+          absl::GetFlag(FLAGS_shard_load_memory_budget_mb),
+      .use_corpus_store = absl::GetFlag(FLAGS_use_corpus_store),
       .seed = absl::GetFlag(FLAGS_seed),
       .prune_frequency = absl::GetFlag(FLAGS_prune_frequency),
       .address_space_limit_mb = absl::GetFlag(FLAGS_address_space_limit_mb),
@@ -469,6 +536,7 @@ Environment CreateEnvironmentFromFlags(const std::vector<std::string> &argv) {
       .stop_at = GetStopAtTime(absl::GetFlag(FLAGS_stop_at),
                                absl::GetFlag(FLAGS_stop_after)),
       .fork_server = absl::GetFlag(FLAGS_fork_server),
+      .persistent_mode = absl::GetFlag(FLAGS_persistent_mode),
       .full_sync = absl::GetFlag(FLAGS_full_sync),
       .use_corpus_weights = absl::GetFlag(FLAGS_use_corpus_weights),
       .use_coverage_frontier = absl::GetFlag(FLAGS_use_coverage_frontier),
@@ -482,13 +550,16 @@ Environment CreateEnvironmentFromFlags(const std::vector<std::string> &argv) {
       .use_dataflow_features = absl::GetFlag(FLAGS_use_dataflow_features),
       .use_counter_features = absl::GetFlag(FLAGS_use_counter_features),
       .use_pcpair_features = absl::GetFlag(FLAGS_use_pcpair_features),
+      .max_pc_pairs_per_input = absl::GetFlag(FLAGS_max_pc_pairs_per_input),
       .user_feature_domain_mask = absl::GetFlag(FLAGS_user_feature_domain_mask),
       .feature_frequency_threshold =
           absl::GetFlag(FLAGS_feature_frequency_threshold),
+      .use_sparse_feature_set = absl::GetFlag(FLAGS_use_sparse_feature_set),
       .require_pc_table = absl::GetFlag(FLAGS_require_pc_table),
       .telemetry_frequency = absl::GetFlag(FLAGS_telemetry_frequency),
       .print_runner_log = absl::GetFlag(FLAGS_print_runner_log),
       .distill = absl::GetFlag(FLAGS_distill),
+      .distill_set_cover = absl::GetFlag(FLAGS_distill_set_cover),
       .log_features_shards = absl::GetFlag(FLAGS_log_features_shards),
       .knobs_file = absl::GetFlag(FLAGS_knobs_file),
       .corpus_to_files = absl::GetFlag(FLAGS_corpus_to_files),
@@ -530,6 +601,18 @@ Environment CreateEnvironmentFromFlags(const std::vector<std::string> &argv) {
   CHECK_GE(env_from_flags.total_shards, 1);
   CHECK_GE(env_from_flags.batch_size, 1);
   CHECK_GE(env_from_flags.num_threads, 1);
+  QCHECK(env_from_flags.target_batch_time_ms == 0 ||
+         env_from_flags.timeout_per_batch == 0 ||
+         env_from_flags.target_batch_time_ms <
+             env_from_flags.timeout_per_batch * 1000)
+      << "--" << FLAGS_target_batch_time_ms.Name()
+      << " must be below --" << FLAGS_timeout_per_batch.Name() << ": "
+      << VV(env_from_flags.target_batch_time_ms)
+      << VV(env_from_flags.timeout_per_batch);
+  QCHECK(!env_from_flags.shared_coverage ||
+         !env_from_flags.use_sparse_feature_set)
+      << "--" << FLAGS_shared_coverage.Name() << " is incompatible with --"
+      << FLAGS_use_sparse_feature_set.Name();
   CHECK_LE(env_from_flags.num_threads, env_from_flags.total_shards);
   CHECK_LE(env_from_flags.my_shard_index + env_from_flags.num_threads,
            env_from_flags.total_shards)
@@ -550,6 +633,7 @@ Environment CreateEnvironmentFromFlags(const std::vector<std::string> &argv) {
     LOG(INFO) << "@@ detected; running in standalone mode with batch_size=1";
     env_from_flags.has_input_wildcards = true;
     env_from_flags.batch_size = 1;
+    env_from_flags.target_batch_time_ms = 0;
     // TODO(kcc): do we need to check if extra_binaries have @@?
   }
 
@@ -152,14 +152,6 @@ inline constexpr Domain kCMPModDiff = {__COUNTER__};
 inline constexpr Domain kCMPHamming = {__COUNTER__};
 // log2(a > b ? a - b : b - a), see ABToCmpDiffLog.
 inline constexpr Domain kCMPDiffLog = {__COUNTER__};
-// A list of all the CMP domains.
-inline constexpr std::array<Domain, 5> kCMPDomains = {{
-    kCMP,
-    kCMPEq,
-    kCMPModDiff,
-    kCMPHamming,
-    kCMPDiffLog,
-}};
 // Features derived from observing function call stacks.
 inline constexpr Domain kCallStack = {__COUNTER__};
 // Features derived from computing (bounded) control flow paths.
@@ -188,6 +180,21 @@ inline constexpr std::array<Domain, 16> kUserDomains = {{
     {__COUNTER__},
     {__COUNTER__},
 }};
+// Features derived from instrumenting switch statements `switch (a)`: the
+// index of the matched case or, if no case matched, log2 of the distance from
+// `a` to the closest case. The context is the same as for the CMP domains.
+// Declared after the older domains so that their ids, and thus the features
+// stored in existing corpora, don't change.
+inline constexpr Domain kCMPSwitch = {__COUNTER__};
+// A list of all the CMP domains.
+inline constexpr std::array<Domain, 6> kCMPDomains = {{
+    kCMP,
+    kCMPEq,
+    kCMPModDiff,
+    kCMPHamming,
+    kCMPDiffLog,
+    kCMPSwitch,
+}};
 // A fake domain, not actually used, must be last.
 inline constexpr Domain kLastDomain = {__COUNTER__};
 // For now, check that all domains (except maybe for kLastDomain) fit
@@ -14,13 +14,21 @@
 
 #include "./centipede/feature_set.h"
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif  // defined(__x86_64__)
+
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <ostream>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_cat.h"
 #include "./centipede/control_flow.h"
@@ -29,28 +37,208 @@
 
 namespace centipede {
 
+namespace {
+
+// How many features ahead the batched kernels prefetch the frequencies.
+constexpr size_t kPrefetchDistance = 16;
+
+// log2(kDomainSize): the domain id of a feature is `feature >> kDomainBits`.
+constexpr int kDomainBits =
+    __builtin_ctzll(feature_domains::Domain::kDomainSize);
+static_assert(feature_domains::Domain::kDomainSize == 1ULL << kDomainBits);
+
+#if defined(__x86_64__)
+
+bool CpuHasAvx2() {
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+}
+
+// Gathers the dense `frequencies` of the 4 `features`, zero-extended to 64
+// bits. Gathers the aligned 32-bit words containing the frequency bytes, and
+// then shifts the bytes into place: unlike gathering at the exact byte offsets,
+// this never reads past the end of `frequencies` (its size is a multiple of 4).
+__attribute__((target("avx2"))) __m256i GatherFrequencies(
+    __m256i features, const uint8_t *frequencies) {
+  const __m256i kThree = _mm256_set1_epi64x(3);
+  const __m128i words = _mm256_i64gather_epi32(
+      reinterpret_cast<const int *>(frequencies),
+      _mm256_andnot_si256(kThree, features), /*scale=*/1);
+  const __m256i shifts = _mm256_slli_epi64(_mm256_and_si256(features, kThree),
+                                           /*imm8=*/3);
+  return _mm256_and_si256(
+      _mm256_srlv_epi64(_mm256_cvtepu32_epi64(words), shifts),
+      _mm256_set1_epi64x(0xFF));
+}
+
+// Returns true if any of the 4 `features` is outside of
+// [0, kLastDomain.begin()), i.e. is not in one of the kNumDomains domains.
+__attribute__((target("avx2"))) bool AnyFeatureOutOfRange(__m256i features) {
+  const __m256i domains = _mm256_srli_epi64(features, kDomainBits);
+  const __m256i max_domain =
+      _mm256_set1_epi64x(feature_domains::kNumDomains - 1);
+  return !_mm256_testz_si256(_mm256_cmpgt_epi64(domains, max_domain),
+                             _mm256_set1_epi64x(-1));
+}
+
+// AVX2 kernel of FeatureSet::PruneFeaturesAndCountUnseen() for the dense
+// storage. Processes `features[0, size)` in blocks of 4, compacting the kept
+// features in place, and updates `num_kept` and `num_unseen` accordingly.
+// Returns the number of processed features: the caller is expected to process
+// the remaining ones. Stops early at a block containing a feature out of range,
+// leaving the error reporting to the caller's scalar code.
+__attribute__((target("avx2"))) size_t PruneFeaturesAndCountUnseenAvx2(
+    feature_t *features, size_t size, const uint8_t *frequencies,
+    const uint64_t *prune_thresholds, size_t &num_kept, size_t &num_unseen) {
+  const __m256i kZero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    if (i + kPrefetchDistance + 4 <= size) {
+      for (size_t j = i + kPrefetchDistance; j < i + kPrefetchDistance + 4; ++j)
+        __builtin_prefetch(frequencies + features[j]);
+    }
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(features + i));
+    if (AnyFeatureOutOfRange(block)) break;
+    const __m256i thresholds = _mm256_i64gather_epi64(
+        reinterpret_cast<const long long *>(prune_thresholds),  // NOLINT
+        _mm256_srli_epi64(block, kDomainBits), /*scale=*/8);
+    const __m256i freqs = GatherFrequencies(block, frequencies);
+    const int keep_mask = _mm256_movemask_pd(
+        _mm256_castsi256_pd(_mm256_cmpgt_epi64(thresholds, freqs)));
+    const __m256i unseen =
+        _mm256_andnot_si256(_mm256_cmpeq_epi64(thresholds, kZero),
+                            _mm256_cmpeq_epi64(freqs, kZero));
+    num_unseen +=
+        __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(unseen)));
+    // Compact the kept features. Since `num_kept <= i`, this never overwrites
+    // the features that are not processed yet.
+    alignas(32) feature_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), block);
+    for (int lane = 0; lane < 4; ++lane) {
+      features[num_kept] = lanes[lane];
+      num_kept += (keep_mask >> lane) & 1;
+    }
+  }
+  return i;
+}
+
+// AVX2 kernel of FeatureSet::HasUnseenFeatures() for the dense storage.
+// Processes `features[0, size)` in blocks of 4. Sets `num_processed` to the
+// number of processed features, the caller is expected to process the
+// remaining ones. Returns true if an unseen feature was found.
+__attribute__((target("avx2"))) bool HasUnseenFeaturesAvx2(
+    const feature_t *features, size_t size, const uint8_t *frequencies,
+    size_t &num_processed) {
+  const __m256i kZero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    if (i + kPrefetchDistance + 4 <= size) {
+      for (size_t j = i + kPrefetchDistance; j < i + kPrefetchDistance + 4; ++j)
+        __builtin_prefetch(frequencies + features[j]);
+    }
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(features + i));
+    if (AnyFeatureOutOfRange(block)) break;
+    const __m256i freqs = GatherFrequencies(block, frequencies);
+    if (!_mm256_testz_si256(_mm256_cmpeq_epi64(freqs, kZero),
+                            _mm256_set1_epi64x(-1))) {
+      num_processed = i;
+      return true;
+    }
+  }
+  num_processed = i;
+  return false;
+}
+
+#endif  // defined(__x86_64__)
+
+}  // namespace
+
 //------------------------------------------------------------------------------
 //                                FeatureSet
 //------------------------------------------------------------------------------
 
-// This implementation is slow (needs to iterate over the entire domain),
-// but there is no need for it to be fast.
+FeatureSet::FeatureSet(uint8_t frequency_threshold,
+                       FeatureDomainSet should_discard_domain,
+                       bool use_sparse_storage, bool concurrent)
+    : frequency_threshold_(frequency_threshold),
+      concurrent_(concurrent),
+      should_discard_domain_(should_discard_domain) {
+  CHECK(!(concurrent && use_sparse_storage))
+      << "A concurrent FeatureSet requires the dense storage";
+  if (use_sparse_storage) {
+    sparse_frequencies_.resize(feature_domains::kNumDomains);
+  } else {
+    dense_frequencies_ = std::make_unique<MmapNoReserveArray<kSize>>();
+  }
+  for (size_t domain_id = 0; domain_id < feature_domains::kNumDomains;
+       ++domain_id) {
+    const feature_t first_feature = feature_domains::Domain(domain_id).begin();
+    prune_threshold_per_domain_[domain_id] =
+        ShouldDiscardFeature(first_feature) ? 0
+                                            : FrequencyThreshold(first_feature);
+  }
+}
+
+uint8_t FeatureSet::GetSparseFrequency(feature_t feature) const {
+  CHECK_LT(feature, kSize);
+  const auto &domain_frequencies =
+      sparse_frequencies_[feature_domains::Domain::FeatureToDomainId(feature)];
+  const auto it = domain_frequencies.find(
+      feature_domains::Domain::FeatureToIndexInDomain(feature));
+  return it == domain_frequencies.end() ? 0 : it->second;
+}
+
+uint8_t &FeatureSet::MutableSparseFrequency(feature_t feature) {
+  CHECK_LT(feature, kSize);
+  return sparse_frequencies_[feature_domains::Domain::FeatureToDomainId(
+      feature)][feature_domains::Domain::FeatureToIndexInDomain(feature)];
+}
+
+// For the dense storage, this implementation is slow (needs to iterate over
+// the entire domain), but there is no need for it to be fast.
 PCIndexVec FeatureSet::ToCoveragePCs() const {
   PCIndexVec pcs;
+  if (UsesSparseStorage()) {
+    for (const auto &[idx, freq] :
+         sparse_frequencies_[feature_domains::kPCs.domain_id()]) {
+      if (freq) pcs.push_back(idx);
+    }
+    std::sort(pcs.begin(), pcs.end());
+    return pcs;
+  }
   for (size_t idx = 0; idx < feature_domains::Domain::kDomainSize; ++idx) {
-    if (frequencies_[feature_domains::kPCs.ConvertToMe(idx)])
+    if (GetFrequency(feature_domains::kPCs.ConvertToMe(idx)))
       pcs.push_back(idx);
   }
   return pcs;
 }
 
 size_t FeatureSet::CountFeatures(feature_domains::Domain domain) const {
-  return features_per_domain_[domain.domain_id()];
+  return __atomic_load_n(&features_per_domain_[domain.domain_id()], kRelaxed);
 }
 
 bool FeatureSet::HasUnseenFeatures(const FeatureVec &features) const {
-  for (auto feature : features) {
-    if (frequencies_[feature] == 0) return true;
+  const size_t size = features.size();
+  size_t i = 0;
+  if (dense_frequencies_ != nullptr) {
+    const uint8_t *frequencies = dense_frequencies_->data();
+#if defined(__x86_64__)
+    if (!concurrent_ && CpuHasAvx2() &&
+        HasUnseenFeaturesAvx2(features.data(), size, frequencies, i)) {
+      return true;
+    }
+#endif  // defined(__x86_64__)
+    for (; i < size; ++i) {
+      if (i + kPrefetchDistance < size)
+        __builtin_prefetch(frequencies + features[i + kPrefetchDistance]);
+      if (GetDenseFrequency(features[i]) == 0) return true;
+    }
+    return false;
+  }
+  for (; i < size; ++i) {
+    if (GetSparseFrequency(features[i]) == 0) return true;
   }
   return false;
 }
@@ -58,13 +246,37 @@ bool FeatureSet::HasUnseenFeatures(const FeatureVec &features) const {
 __attribute__((noinline))  // to see it in profile.
 size_t
 FeatureSet::PruneFeaturesAndCountUnseen(FeatureVec &features) const {
+  const size_t size = features.size();
   size_t number_of_unseen_features = 0;
   size_t num_kept = 0;
-  for (auto feature : features) {
-    if (ShouldDiscardFeature(feature)) continue;
-    auto freq = frequencies_[feature];
-    if (freq == 0) ++number_of_unseen_features;
-    if (freq < FrequencyThreshold(feature)) features[num_kept++] = feature;
+  size_t i = 0;
+  // Keeps or drops `features[i]` given its frequency, without branches.
+  auto prune_one = [&](size_t idx, uint8_t freq) {
+    const feature_t feature = features[idx];
+    const uint64_t threshold = prune_threshold_per_domain_
+        [feature_domains::Domain::FeatureToDomainId(feature)];
+    number_of_unseen_features += (freq == 0) & (threshold != 0);
+    features[num_kept] = feature;
+    num_kept += freq < threshold;
+  };
+  if (dense_frequencies_ != nullptr) {
+    const uint8_t *frequencies = dense_frequencies_->data();
+#if defined(__x86_64__)
+    if (!concurrent_ && CpuHasAvx2()) {
+      i = PruneFeaturesAndCountUnseenAvx2(
+          features.data(), size, frequencies, prune_threshold_per_domain_,
+          num_kept, number_of_unseen_features);
+    }
+#endif  // defined(__x86_64__)
+    for (; i < size; ++i) {
+      if (i + kPrefetchDistance < size)
+        __builtin_prefetch(frequencies + features[i + kPrefetchDistance]);
+      // NOTE: GetDenseFrequency() CHECKs that the feature is in range before
+      // its domain is used as an index into prune_threshold_per_domain_.
+      prune_one(i, GetDenseFrequency(features[i]));
+    }
+  } else {
+    for (; i < size; ++i) prune_one(i, GetSparseFrequency(features[i]));
   }
   features.resize(num_kept);
   return number_of_unseen_features;
@@ -80,8 +292,27 @@ void FeatureSet::PruneDiscardedDomains(FeatureVec &features) const {
 }
 
 void FeatureSet::IncrementFrequencies(const FeatureVec &features) {
+  if (concurrent_) {
+    for (auto f : features) {
+      uint8_t *freq = &(*dense_frequencies_)[f];
+      const uint8_t threshold = FrequencyThreshold(f);
+      uint8_t old_freq = __atomic_load_n(freq, kRelaxed);
+      // On failure, the CAS reloads `old_freq` for the next attempt.
+      while (old_freq < threshold &&
+             !__atomic_compare_exchange_n(freq, &old_freq, old_freq + 1,
+                                          /*weak=*/true, kRelaxed, kRelaxed)) {
+      }
+      // Only the thread that moved the frequency off 0 counts the feature.
+      if (old_freq == 0) {
+        const size_t domain_id = feature_domains::Domain::FeatureToDomainId(f);
+        __atomic_fetch_add(&num_features_, 1, kRelaxed);
+        __atomic_fetch_add(&features_per_domain_[domain_id], 1, kRelaxed);
+      }
+    }
+    return;
+  }
   for (auto f : features) {
-    auto &freq = frequencies_[f];
+    auto &freq = MutableFrequency(f);
     if (freq == 0) {
       ++num_features_;
       ++features_per_domain_[feature_domains::Domain::FeatureToDomainId(f)];
@@ -101,10 +332,14 @@ FeatureSet::ComputeWeight(const FeatureVec &features) const {
     // and so on.
     // The less frequent is the domain, the more valuable are its features.
     auto domain_id = feature_domains::Domain::FeatureToDomainId(feature);
-    auto features_in_domain = features_per_domain_[domain_id];
-    CHECK(features_in_domain);
-    auto domain_weight = num_features_ / features_in_domain;
-    auto feature_frequency = frequencies_[feature];
+    auto features_in_domain =
+        __atomic_load_n(&features_per_domain_[domain_id], kRelaxed);
+    // In a concurrent set, the counter of a feature counted by another thread
+    // may not be visible yet.
+    CHECK(features_in_domain || concurrent_);
+    features_in_domain = std::max<size_t>(features_in_domain, 1);
+    auto domain_weight = size() / features_in_domain;
+    auto feature_frequency = GetFrequency(feature);
     CHECK_GT(feature_frequency, 0)
         << VV(feature) << VV(domain_id) << VV(features_in_domain)
         << VV(domain_weight) << VV((int)feature_frequency) << DebugString();
@@ -116,7 +351,7 @@ FeatureSet::ComputeWeight(const FeatureVec &features) const {
 std::string FeatureSet::DebugString() const {
   std::ostringstream os;
   os << VV((int)frequency_threshold_);
-  os << VV(num_features_);
+  os << VV(size());
   os << this;
   return os.str();
 }
@@ -142,4 +377,55 @@ std::ostream &operator<<(std::ostream &out, const FeatureSet &fs) {
   return out;
 }
 
+size_t AddPcPairFeatures(const FeatureSet &feature_set, size_t num_pcs,
+                         size_t max_pairs, FeatureVec &features,
+                         std::vector<size_t> &pcs) {
+  pcs.clear();
+  for (auto feature : features) {
+    if (feature_domains::kPCs.Contains(feature))
+      pcs.push_back(ConvertPCFeatureToPcIndex(feature));
+  }
+  const size_t n = pcs.size();
+  size_t num_added_pairs = 0;
+  auto add_pair_if_unseen = [&](size_t pc1, size_t pc2) {
+    // The pair is unordered: number it the same regardless of the order of the
+    // PCs in `features` and of which of them is an anchor below.
+    const feature_t f = feature_domains::kPCPair.ConvertToMe(
+        ConvertPcPairToNumber(std::min(pc1, pc2), std::max(pc1, pc2), num_pcs));
+    // If we have seen this pair at least once, ignore it.
+    if (feature_set.Frequency(f) != 0) return;
+    features.push_back(f);
+    ++num_added_pairs;
+  };
+
+  if (max_pairs == 0 || n < 2 || n * (n - 1) / 2 <= max_pairs) {
+    // The quadratic loop: iterate all PC pairs (!!).
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = i + 1; j < n; ++j) add_pair_if_unseen(pcs[i], pcs[j]);
+    }
+    return num_added_pairs;
+  }
+
+  // Move the `num_anchors` least frequent PCs to the front, then pair each of
+  // them with all the PCs after it: that is fewer than `num_anchors * n`
+  // pairs, so at most `max_pairs` unless `max_pairs < n`, when it is the n - 1
+  // pairs of one anchor. Ties are broken by PC index, to keep the choice
+  // deterministic.
+  const size_t num_anchors = std::max<size_t>(1, max_pairs / n);
+  auto by_frequency = [&feature_set](size_t pc1, size_t pc2) {
+    return std::make_tuple(
+               feature_set.Frequency(feature_domains::kPCs.ConvertToMe(pc1)),
+               pc1) <
+           std::make_tuple(
+               feature_set.Frequency(feature_domains::kPCs.ConvertToMe(pc2)),
+               pc2);
+  };
+  std::nth_element(pcs.begin(), pcs.begin() + num_anchors - 1, pcs.end(),
+                   by_frequency);
+  for (size_t i = 0; i < num_anchors; ++i) {
+    for (size_t j = i + 1; j < n; ++j) add_pair_if_unseen(pcs[i], pcs[j]);
+  }
+  return num_added_pairs;
+}
+
 }  // namespace centipede
@@ -19,9 +19,13 @@
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "./centipede/control_flow.h"
 #include "./centipede/feature.h"
 #include "./centipede/util.h"
@@ -32,14 +36,32 @@ namespace centipede {
 // Features that have a frequency >= frequency_threshold
 // are considered too frequent and thus less interesting for further fuzzing.
 // All features must be in [0, feature_domains::kLastDomain.begin()).
+//
+// Two storage backends are available for the frequencies:
+// * dense (default): a single MmapNoReserveArray spanning all the domains.
+//   Lookups are a single load, but every touched page stays resident, which
+//   adds up for hashed domains (cmp, dataflow, path, etc.) whose features are
+//   scattered randomly across the domain.
+// * sparse: one Swiss table per domain, keyed by the feature's index in the
+//   domain. Memory is proportional to the number of distinct features, at the
+//   cost of a hash lookup per feature.
+// See feature_set_benchmark.cc for comparing the two on real corpora.
+//
+// A concurrent FeatureSet (dense storage only) may be shared by several
+// threads, e.g. the Centipede instances fuzzing in one process: all its
+// methods may be called concurrently. The frequencies are incremented with
+// atomic compare-and-swap, and the counters with atomic adds, so no locks are
+// taken. The readers may observe slightly stale frequencies and counters, which
+// at worst makes two threads add inputs with the same new feature. The
+// concurrent set doesn't use the SIMD kernels, since those read the
+// frequencies non-atomically.
 class FeatureSet {
  public:
   using FeatureDomainSet = std::bitset<feature_domains::kNumDomains>;
 
   explicit FeatureSet(uint8_t frequency_threshold,
-                      FeatureDomainSet should_discard_domain)
-      : frequency_threshold_(frequency_threshold),
-        should_discard_domain_(should_discard_domain) {}
+                      FeatureDomainSet should_discard_domain,
+                      bool use_sparse_storage = false, bool concurrent = false);
 
   // Returns true if there are features in `features` not present in `this`.
   bool HasUnseenFeatures(const FeatureVec &features) const;
@@ -48,6 +70,10 @@ class FeatureSet {
   // discarded domains.
   // Returns the number of unpruned features in `features` that were not
   // previously present in `this`.
+  // This is on the path of every executed input, so `features` are processed
+  // in blocks: the frequencies of the upcoming features are prefetched, and
+  // with the dense storage on CPUs supporting AVX2, the frequencies, domains
+  // and thresholds of a block are gathered and compared with SIMD.
   size_t PruneFeaturesAndCountUnseen(FeatureVec &features) const;
 
   // Prune the features that are in discarded domains.
@@ -59,7 +85,7 @@ class FeatureSet {
   void IncrementFrequencies(const FeatureVec &features);
 
   // How many different features are in the set.
-  size_t size() const { return num_features_; }
+  size_t size() const { return __atomic_load_n(&num_features_, kRelaxed); }
 
   // Returns features that originate from CFG counters, converted to PCIndexVec.
   PCIndexVec ToCoveragePCs() const;
@@ -71,7 +97,8 @@ class FeatureSet {
   size_t CountFeatures(const DomainListT &domains) const {
     size_t count = 0;
     for (auto domain : domains) {
-      count += features_per_domain_[domain.domain_id()];
+      count +=
+          __atomic_load_n(&features_per_domain_[domain.domain_id()], kRelaxed);
     }
     return count;
   }
@@ -83,7 +110,13 @@ class FeatureSet {
   }
 
   // Returns the frequency associated with `feature`.
-  size_t Frequency(feature_t feature) const { return frequencies_[feature]; }
+  size_t Frequency(feature_t feature) const { return GetFrequency(feature); }
+
+  // Returns true if `this` uses the sparse storage backend.
+  bool UsesSparseStorage() const { return dense_frequencies_ == nullptr; }
+
+  // Returns true if `this` may be used by several threads concurrently.
+  bool IsConcurrent() const { return concurrent_; }
 
   // Computes combined weight of `features`.
   // The less frequent the feature is, the bigger its weight.
@@ -94,6 +127,9 @@ class FeatureSet {
   std::string DebugString() const;
 
  private:
+  // The memory order of all the atomic accesses: only the atomicity matters.
+  static constexpr int kRelaxed = __ATOMIC_RELAXED;
+
   // Computes the frequency threshold based on the domain of `feature`.
   // For now, just uses 1 for kPCPair and frequency_threshold_ for all others.
   // Rationale: the kPCPair features might be too numerous, we don't want to
@@ -111,15 +147,52 @@ class FeatureSet {
     return should_discard_domain_.test(domain_id);
   }
 
+  // Returns the frequency of `feature`, 0 if it was never seen.
+  uint8_t GetFrequency(feature_t feature) const {
+    if (dense_frequencies_ != nullptr) return GetDenseFrequency(feature);
+    return GetSparseFrequency(feature);
+  }
+
+  // Dense storage implementation of the above. The load is atomic, which is
+  // as cheap as a plain one, so that it's safe in a concurrent set.
+  uint8_t GetDenseFrequency(feature_t feature) const {
+    CHECK_LT(feature, kSize);
+    return __atomic_load_n(dense_frequencies_->data() + feature, kRelaxed);
+  }
+
+  // Returns a mutable reference to the frequency of `feature`, adding it with
+  // the frequency 0 if it was never seen.
+  uint8_t &MutableFrequency(feature_t feature) {
+    if (dense_frequencies_ != nullptr) return (*dense_frequencies_)[feature];
+    return MutableSparseFrequency(feature);
+  }
+
+  // Sparse storage implementations of the above.
+  uint8_t GetSparseFrequency(feature_t feature) const;
+  uint8_t &MutableSparseFrequency(feature_t feature);
+
   const uint8_t frequency_threshold_;
 
+  // For every domain, features with frequencies below this threshold are kept
+  // by PruneFeaturesAndCountUnseen(). It is 0 for the discarded domains, so
+  // that their features are never kept. Combines FrequencyThreshold() and
+  // ShouldDiscardFeature() into a single lookup; the values are 64-bit so that
+  // the table can be gathered with SIMD.
+  uint64_t prune_threshold_per_domain_[feature_domains::kNumDomains] = {};
+
   static constexpr size_t kSize = feature_domains::kLastDomain.begin();
 
-  // Maps features to their frequencies.
+  // Maps features to their frequencies; non-null iff the dense storage is used.
   // This array is huge but sparse, and depending on the enabled features
   // some parts of it will never be written to or read from.
   // Unused parts of MmapNoReserveArray don't actually reserve memory.
-  MmapNoReserveArray<kSize> frequencies_;
+  std::unique_ptr<MmapNoReserveArray<kSize>> dense_frequencies_;
+
+  // Maps features to their frequencies when the sparse storage is used:
+  // `sparse_frequencies_[domain_id]` maps the index of a feature in its domain
+  // to the feature's frequency. Only features with non-zero frequencies are
+  // present. Empty iff the dense storage is used.
+  std::vector<absl::flat_hash_map<uint32_t, uint8_t>> sparse_frequencies_;
 
   // Counts all unique features added to this.
   size_t num_features_ = 0;
@@ -127,12 +200,32 @@ class FeatureSet {
   // Counts features in each domain.
   size_t features_per_domain_[feature_domains::kNumDomains] = {};
 
+  const bool concurrent_;
+
   FeatureDomainSet should_discard_domain_;
 };
 
 // Stream out description and count of features in feature set.
 std::ostream &operator<<(std::ostream &out, const FeatureSet &fs);
 
+// Collects the PCs (in [0, `num_pcs`)) from `features`, then appends to
+// `features` the kPCPair features, for pairs of those PCs, that `feature_set`
+// has never seen. A pair is unordered: {pc1, pc2} is numbered as
+// `ConvertPcPairToNumber(min(pc1, pc2), max(pc1, pc2), num_pcs)`. Returns the
+// number of appended features. `pcs` is scratch space, reused across calls to
+// avoid allocations.
+//
+// If `max_pairs` is 0 or is at least the number of pairs, all pairs are
+// considered, which is quadratic by the number of PCs. Otherwise, the pairs of
+// the least frequent PCs in `feature_set` with all the other PCs are
+// considered, so that a rare PC contributes all its pairs before a frequent
+// one contributes any. That is at most max(`max_pairs`, number of PCs - 1)
+// pairs: the least frequent PC contributes all its pairs even if they are
+// more than `max_pairs`.
+size_t AddPcPairFeatures(const FeatureSet &feature_set, size_t num_pcs,
+                         size_t max_pairs, FeatureVec &features,
+                         std::vector<size_t> &pcs);
+
 }  // namespace centipede
 
 #endif  // THIRD_PARTY_CENTIPEDE_FEATURE_SET_H_
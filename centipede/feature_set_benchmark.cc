@@ -0,0 +1,219 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the storage backends of `FeatureSet` (see feature_set.h) by RSS and
+// by ns/feature. The features are either read from the features files of a
+// real workdir, e.g.
+//
+//   feature_set_benchmark \
+//     --features_glob=/path/to/workdir/binary-hash/features.*
+//
+// or, if --features_glob is empty, generated synthetically with a mix of
+// dense (PCs) and hashed (cmp, dataflow, path) domains.
+//
+// The workload mimics `Centipede::LoadShard()`: every feature vector is pruned
+// against the set and, if it has unseen features, added to the set. Then, the
+// throughput (features/sec) of `PruneFeaturesAndCountUnseen()` and
+// `HasUnseenFeatures()`, which are on the path of every executed input in
+// `Centipede::RunBatch()`, is measured against the populated set.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./centipede/blob_file.h"
+#include "./centipede/config_init.h"
+#include "./centipede/defs.h"
+#include "./centipede/feature.h"
+#include "./centipede/feature_set.h"
+#include "./centipede/logging.h"
+#include "./centipede/remote_file.h"
+#include "./centipede/rusage_stats.h"
+#include "./centipede/util.h"
+
+ABSL_FLAG(std::string, features_glob, "",
+          "Glob matching the features files to read the feature vectors from. "
+          "If empty, synthetic feature vectors are used.");
+ABSL_FLAG(std::string, storage, "both",
+          "FeatureSet storage to benchmark (dense|sparse|both).");
+ABSL_FLAG(size_t, num_synthetic_inputs, 200000,
+          "Number of synthetic feature vectors.");
+ABSL_FLAG(size_t, synthetic_features_per_input, 300,
+          "Number of features in every synthetic feature vector.");
+ABSL_FLAG(size_t, num_synthetic_pcs, 1000000,
+          "Number of PCs in the synthetic target.");
+ABSL_FLAG(size_t, frequency_threshold, 100,
+          "Same as Centipede's --feature_frequency_threshold.");
+ABSL_FLAG(size_t, num_iterations, 1,
+          "Number of passes over the feature vectors.");
+
+namespace centipede {
+
+std::vector<FeatureVec> ReadFeatureVecs(std::string_view glob) {
+  std::vector<std::string> paths;
+  RemoteGlobMatch(glob, paths);
+  QCHECK(!paths.empty()) << "No files match " << VV(glob);
+  std::vector<FeatureVec> feature_vecs;
+  for (const auto &path : paths) {
+    const auto reader = DefaultBlobFileReaderFactory();
+    CHECK_OK(reader->Open(path)) << VV(path);
+    ByteSpan blob;
+    while (reader->Read(blob).ok()) {
+      FeatureVec features;
+      UnpackFeaturesAndHash(blob, &features);
+      if (!features.empty()) feature_vecs.push_back(std::move(features));
+    }
+  }
+  return feature_vecs;
+}
+
+std::vector<FeatureVec> MakeSyntheticFeatureVecs() {
+  const size_t num_inputs = absl::GetFlag(FLAGS_num_synthetic_inputs);
+  const size_t features_per_input =
+      absl::GetFlag(FLAGS_synthetic_features_per_input);
+  const size_t num_pcs = absl::GetFlag(FLAGS_num_synthetic_pcs);
+  QCHECK_GT(num_pcs, 0);
+  Rng rng(1);
+  // PCs are dense and well localized; the other domains are hashed and thus
+  // scattered over the entire domain.
+  const feature_domains::Domain hashed_domains[] = {
+      feature_domains::kDataFlow,
+      feature_domains::kCMPEq,
+      feature_domains::kCMPModDiff,
+      feature_domains::kCMPHamming,
+      feature_domains::kCMPDiffLog,
+      feature_domains::kBoundedPath,
+  };
+  std::vector<FeatureVec> feature_vecs(num_inputs);
+  for (auto &features : feature_vecs) {
+    features.reserve(features_per_input);
+    for (size_t i = 0; i < features_per_input; ++i) {
+      if (i % 3 == 0) {
+        features.push_back(feature_domains::kPCs.ConvertToMe(rng() % num_pcs));
+      } else {
+        const auto &domain = hashed_domains[rng() % std::size(hashed_domains)];
+        features.push_back(domain.ConvertToMe(rng()));
+      }
+    }
+  }
+  return feature_vecs;
+}
+
+void RunBenchmark(const std::vector<FeatureVec> &feature_vecs,
+                  bool use_sparse_storage) {
+  static const auto scope = perf::RUsageScope::ThisProcess();
+  const auto rss_before = perf::RUsageMemory::Snapshot(scope).mem_rss;
+  FeatureSet feature_set(
+      static_cast<uint8_t>(absl::GetFlag(FLAGS_frequency_threshold)),
+      /*should_discard_domain=*/{}, use_sparse_storage);
+  size_t num_features = 0;
+  size_t num_added_inputs = 0;
+  FeatureVec features;
+  const absl::Time start = absl::Now();
+  for (size_t iter = 0; iter < absl::GetFlag(FLAGS_num_iterations); ++iter) {
+    for (const auto &input_features : feature_vecs) {
+      features = input_features;
+      num_features += features.size();
+      if (feature_set.PruneFeaturesAndCountUnseen(features) == 0) continue;
+      feature_set.IncrementFrequencies(features);
+      ++num_added_inputs;
+    }
+  }
+  const absl::Duration duration = absl::Now() - start;
+  const auto rss_after = perf::RUsageMemory::Snapshot(scope).mem_rss;
+  LOG(INFO) << absl::StrFormat(
+      "storage: %6s | inputs: %9d | features: %11d | added: %8d | "
+      "ns/feature: %6.2f | rss: +%s | %s",
+      use_sparse_storage ? "sparse" : "dense", feature_vecs.size(),
+      num_features, num_added_inputs,
+      absl::ToDoubleNanoseconds(duration) / std::max<size_t>(num_features, 1),
+      perf::FormatInOptimalUnits(rss_after - rss_before,
+                                 /*always_signed=*/false),
+      (std::ostringstream{} << feature_set).str());
+
+  // Measure the throughput of the read-only operations on the populated set.
+  auto log_throughput = [&](std::string_view name, absl::Duration duration,
+                            size_t num_features, size_t checksum) {
+    LOG(INFO) << absl::StrFormat(
+        "storage: %6s | %27s: %12.0f features/sec | checksum: %d",
+        use_sparse_storage ? "sparse" : "dense", name,
+        num_features / std::max(absl::ToDoubleSeconds(duration), 1e-9),
+        checksum);
+  };
+  num_features = 0;
+  size_t checksum = 0;
+  absl::Time prune_start = absl::Now();
+  for (size_t iter = 0; iter < absl::GetFlag(FLAGS_num_iterations); ++iter) {
+    for (const auto &input_features : feature_vecs) {
+      features = input_features;
+      num_features += features.size();
+      checksum += feature_set.PruneFeaturesAndCountUnseen(features);
+    }
+  }
+  log_throughput("PruneFeaturesAndCountUnseen", absl::Now() - prune_start,
+                 num_features, checksum);
+  num_features = 0;
+  checksum = 0;
+  absl::Time has_unseen_start = absl::Now();
+  for (size_t iter = 0; iter < absl::GetFlag(FLAGS_num_iterations); ++iter) {
+    for (const auto &input_features : feature_vecs) {
+      num_features += input_features.size();
+      checksum += feature_set.HasUnseenFeatures(input_features);
+    }
+  }
+  log_throughput("HasUnseenFeatures", absl::Now() - has_unseen_start,
+                 num_features, checksum);
+}
+
+}  // namespace centipede
+
+int main(int argc, absl::Nonnull<char **> argv) {
+  (void)centipede::config::InitRuntime(argc, argv);
+
+  const std::string storage = absl::GetFlag(FLAGS_storage);
+  QCHECK(storage == "dense" || storage == "sparse" || storage == "both")
+      << VV(storage);
+  const std::string features_glob = absl::GetFlag(FLAGS_features_glob);
+  const std::vector<centipede::FeatureVec> feature_vecs =
+      features_glob.empty() ? centipede::MakeSyntheticFeatureVecs()
+                            : centipede::ReadFeatureVecs(features_glob);
+
+  // The dense storage returns its memory to the OS when destroyed (munmap),
+  // while the heap used by the sparse storage may be retained by the
+  // allocator: run the dense storage first so that the RSS deltas stay
+  // meaningful in the "both" mode.
+  if (storage != "sparse") {
+    centipede::RunBenchmark(feature_vecs, /*use_sparse_storage=*/false);
+  }
+  if (storage != "dense") {
+    centipede::RunBenchmark(feature_vecs, /*use_sparse_storage=*/true);
+  }
+
+  return EXIT_SUCCESS;
+}
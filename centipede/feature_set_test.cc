@@ -14,9 +14,13 @@
 
 #include "./centipede/feature_set.h"
 
+#include <algorithm>
 #include <bitset>
 #include <cstddef>
 #include <cstdint>
+#include <random>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "./centipede/feature.h"
@@ -200,5 +204,243 @@ TEST(FeatureSet, PruneDiscardedDomains) {
   }
 }
 
+// Tests the batched implementation of PruneFeaturesAndCountUnseen() against a
+// straightforward one, on vectors long enough to exercise the block kernels.
+TEST(FeatureSet, PruneFeaturesAndCountUnseenMatchesReference) {
+  std::bitset<feature_domains::kNumDomains> discarded_domains;
+  discarded_domains.set(feature_domains::kDataFlow.domain_id());
+  for (bool use_sparse_storage : {false, true}) {
+    SCOPED_TRACE(use_sparse_storage);
+    FeatureSet feature_set(3, discarded_domains, use_sparse_storage);
+    std::mt19937_64 rng(1);
+    auto random_feature = [&rng]() -> feature_t {
+      const feature_domains::Domain domain(rng() %
+                                           feature_domains::kNumDomains);
+      return domain.ConvertToMe(rng() % 1000);
+    };
+    for (size_t iter = 0; iter < 300; ++iter) {
+      FeatureVec features(rng() % 100);
+      for (auto &feature : features) feature = random_feature();
+
+      FeatureVec expected_features;
+      size_t expected_num_unseen = 0;
+      for (auto feature : features) {
+        if (discarded_domains.test(
+                feature_domains::Domain::FeatureToDomainId(feature))) {
+          continue;
+        }
+        const size_t threshold =
+            feature_domains::kPCPair.Contains(feature) ? 1 : 3;
+        if (feature_set.Frequency(feature) == 0) ++expected_num_unseen;
+        if (feature_set.Frequency(feature) < threshold)
+          expected_features.push_back(feature);
+      }
+      bool expected_has_unseen = false;
+      for (auto feature : features) {
+        if (feature_set.Frequency(feature) == 0) expected_has_unseen = true;
+      }
+
+      EXPECT_EQ(feature_set.HasUnseenFeatures(features), expected_has_unseen);
+      FeatureVec pruned_features = features;
+      EXPECT_EQ(feature_set.PruneFeaturesAndCountUnseen(pruned_features),
+                expected_num_unseen);
+      EXPECT_EQ(pruned_features, expected_features);
+      feature_set.IncrementFrequencies(features);
+    }
+  }
+}
+
+TEST(FeatureSet, SparseStorageMatchesDenseStorage) {
+  std::bitset<feature_domains::kNumDomains> discarded_domains;
+  discarded_domains.set(feature_domains::kCallStack.domain_id());
+  FeatureSet dense(5, discarded_domains, /*use_sparse_storage=*/false);
+  FeatureSet sparse(5, discarded_domains, /*use_sparse_storage=*/true);
+  EXPECT_FALSE(dense.UsesSparseStorage());
+  EXPECT_TRUE(sparse.UsesSparseStorage());
+
+  std::mt19937_64 rng(42);
+  for (size_t iter = 0; iter < 1000; ++iter) {
+    FeatureVec features;
+    for (size_t i = 0; i < 20; ++i) {
+      const feature_domains::Domain domain(rng() %
+                                           feature_domains::kNumDomains);
+      // Mix features from a small range (repeats) and from the entire domain.
+      features.push_back(domain.ConvertToMe(i % 2 ? rng() % 100 : rng()));
+    }
+    FeatureVec dense_features = features;
+    FeatureVec sparse_features = features;
+    EXPECT_EQ(dense.HasUnseenFeatures(features),
+              sparse.HasUnseenFeatures(features));
+    EXPECT_EQ(dense.PruneFeaturesAndCountUnseen(dense_features),
+              sparse.PruneFeaturesAndCountUnseen(sparse_features));
+    EXPECT_EQ(dense_features, sparse_features);
+    dense.IncrementFrequencies(dense_features);
+    sparse.IncrementFrequencies(sparse_features);
+    for (auto feature : features) {
+      EXPECT_EQ(dense.Frequency(feature), sparse.Frequency(feature));
+    }
+  }
+  EXPECT_EQ(dense.size(), sparse.size());
+  for (size_t i = 0; i < feature_domains::kNumDomains; ++i) {
+    EXPECT_EQ(dense.CountFeatures(feature_domains::Domain(i)),
+              sparse.CountFeatures(feature_domains::Domain(i)));
+  }
+  EXPECT_EQ(dense.ToCoveragePCs(), sparse.ToCoveragePCs());
+}
+
+TEST(FeatureSet, ConcurrentSetMatchesDenseSet) {
+  std::bitset<feature_domains::kNumDomains> discarded_domains;
+  discarded_domains.set(feature_domains::kCallStack.domain_id());
+  FeatureSet dense(5, discarded_domains);
+  FeatureSet concurrent(5, discarded_domains, /*use_sparse_storage=*/false,
+                        /*concurrent=*/true);
+  EXPECT_FALSE(dense.IsConcurrent());
+  EXPECT_TRUE(concurrent.IsConcurrent());
+
+  std::mt19937_64 rng(42);
+  for (size_t iter = 0; iter < 1000; ++iter) {
+    FeatureVec features;
+    for (size_t i = 0; i < 20; ++i) {
+      const feature_domains::Domain domain(rng() %
+                                           feature_domains::kNumDomains);
+      features.push_back(domain.ConvertToMe(i % 2 ? rng() % 100 : rng()));
+    }
+    FeatureVec dense_features = features;
+    FeatureVec concurrent_features = features;
+    EXPECT_EQ(dense.HasUnseenFeatures(features),
+              concurrent.HasUnseenFeatures(features));
+    EXPECT_EQ(dense.PruneFeaturesAndCountUnseen(dense_features),
+              concurrent.PruneFeaturesAndCountUnseen(concurrent_features));
+    EXPECT_EQ(dense_features, concurrent_features);
+    dense.IncrementFrequencies(dense_features);
+    concurrent.IncrementFrequencies(concurrent_features);
+    EXPECT_EQ(dense.ComputeWeight(dense_features),
+              concurrent.ComputeWeight(concurrent_features));
+  }
+  EXPECT_EQ(dense.size(), concurrent.size());
+  for (size_t i = 0; i < feature_domains::kNumDomains; ++i) {
+    EXPECT_EQ(dense.CountFeatures(feature_domains::Domain(i)),
+              concurrent.CountFeatures(feature_domains::Domain(i)));
+  }
+}
+
+TEST(FeatureSet, ConcurrentSetCountsIncrementsFromManyThreads) {
+  constexpr size_t kNumThreads = 8;
+  constexpr size_t kNumIncrementsPerThread = 10;
+  FeatureSet feature_set(/*frequency_threshold=*/100,
+                         /*should_discard_domain=*/{},
+                         /*use_sparse_storage=*/false, /*concurrent=*/true);
+  FeatureVec features;
+  for (size_t i = 0; i < 1000; ++i) {
+    features.push_back(feature_domains::kPCs.ConvertToMe(i));
+    features.push_back(feature_domains::kCMP.ConvertToMe(i));
+  }
+  // kPCPair features saturate at 1.
+  features.push_back(feature_domains::kPCPair.ConvertToMe(1));
+  {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&feature_set, &features]() {
+        for (size_t i = 0; i < kNumIncrementsPerThread; ++i) {
+          feature_set.IncrementFrequencies(features);
+        }
+      });
+    }
+    for (std::thread &thread : threads) thread.join();
+  }
+  EXPECT_EQ(feature_set.size(), features.size());
+  EXPECT_EQ(feature_set.CountFeatures(feature_domains::kPCs), 1000);
+  EXPECT_EQ(feature_set.CountFeatures(feature_domains::kCMP), 1000);
+  EXPECT_EQ(feature_set.CountFeatures(feature_domains::kPCPair), 1);
+  for (size_t i = 0; i + 1 < features.size(); ++i) {
+    ASSERT_EQ(feature_set.Frequency(features[i]),
+              kNumThreads * kNumIncrementsPerThread);
+  }
+  EXPECT_EQ(feature_set.Frequency(features.back()), 1);
+}
+
+TEST(FeatureSet, AddPcPairFeatures) {
+  constexpr size_t kNumPcs = 100;
+  FeatureSet feature_set(10, {});
+  auto pc = [](size_t pc) { return feature_domains::kPCs.ConvertToMe(pc); };
+  auto pc_pair = [](size_t pc1, size_t pc2) {
+    return feature_domains::kPCPair.ConvertToMe(
+        ConvertPcPairToNumber(pc1, pc2, kNumPcs));
+  };
+  // PC 0 is new, PCs 1 and 3 are rare, PCs 2, 4 and 5 are frequent.
+  feature_set.IncrementFrequencies({pc(1), pc(2), pc(3), pc(4), pc(5)});
+  feature_set.IncrementFrequencies({pc(2), pc(4), pc(5)});
+  const FeatureVec input = {
+      pc(0), pc(1), pc(2), pc(3), pc(4), pc(5),
+      feature_domains::kCMPEq.ConvertToMe(6),
+  };
+  std::vector<size_t> scratch;
+  auto added_pairs = [&](const FeatureVec &features) {
+    FeatureVec pairs(features.begin() + input.size(), features.end());
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+  };
+
+  // All 15 pairs, without a limit or with one that is not exceeded.
+  for (size_t max_pairs : {0, 15, 100}) {
+    FeatureVec features = input;
+    EXPECT_EQ(AddPcPairFeatures(feature_set, kNumPcs, max_pairs, features,
+                                scratch),
+              15);
+    EXPECT_EQ(features.size(), input.size() + 15);
+  }
+
+  // 6 / 6 PCs = 1 anchor: pairs of PC 0, the least frequent one. A limit
+  // below the number of PCs still yields all the pairs of one anchor.
+  for (size_t max_pairs : {1, 3, 6}) {
+    FeatureVec features = input;
+    EXPECT_EQ(AddPcPairFeatures(feature_set, kNumPcs, max_pairs, features,
+                                scratch),
+              5)
+        << "max_pairs: " << max_pairs;
+    EXPECT_EQ(added_pairs(features),
+              (FeatureVec{pc_pair(0, 1), pc_pair(0, 2), pc_pair(0, 3),
+                          pc_pair(0, 4), pc_pair(0, 5)}))
+        << "max_pairs: " << max_pairs;
+  }
+
+  // 12 / 6 PCs = 2 anchors: pairs of PCs 0 and 1, the least frequent ones
+  // (ties broken by PC index). The pairs seen before are skipped.
+  feature_set.IncrementFrequencies({pc_pair(0, 2), pc_pair(1, 4)});
+  FeatureVec features = input;
+  EXPECT_EQ(AddPcPairFeatures(feature_set, kNumPcs, 12, features, scratch),
+            7);
+  EXPECT_EQ(added_pairs(features),
+            (FeatureVec{pc_pair(0, 1), pc_pair(0, 3), pc_pair(0, 4),
+                        pc_pair(0, 5), pc_pair(1, 2), pc_pair(1, 3),
+                        pc_pair(1, 5)}));
+}
+
+TEST(FeatureSet, AddPcPairFeaturesNumbersPairsTheSameInBothModes) {
+  constexpr size_t kNumPcs = 100;
+  FeatureSet feature_set(10, {});
+  auto pc = [](size_t pc) { return feature_domains::kPCs.ConvertToMe(pc); };
+  auto pc_pair = [](size_t pc1, size_t pc2) {
+    return feature_domains::kPCPair.ConvertToMe(
+        ConvertPcPairToNumber(pc1, pc2, kNumPcs));
+  };
+  // The PCs are not sorted, so the quadratic loop sees PC 7 before PC 3,
+  // while the anchor mode pairs PC 3, the least frequent one, with PC 7.
+  feature_set.IncrementFrequencies({pc(5), pc(7)});
+  const FeatureVec input = {pc(7), pc(3), pc(5)};
+  std::vector<size_t> scratch;
+  auto added_pairs = [&](size_t max_pairs) {
+    FeatureVec features = input;
+    AddPcPairFeatures(feature_set, kNumPcs, max_pairs, features, scratch);
+    FeatureVec pairs(features.begin() + input.size(), features.end());
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+  };
+  EXPECT_EQ(added_pairs(/*max_pairs=*/0),
+            (FeatureVec{pc_pair(3, 5), pc_pair(3, 7), pc_pair(5, 7)}));
+  EXPECT_EQ(added_pairs(/*max_pairs=*/1),
+            (FeatureVec{pc_pair(3, 5), pc_pair(3, 7)}));
+}
+
 }  // namespace
 }  // namespace centipede
@@ -0,0 +1,143 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Control messages of the persistent-mode fork server (see
+// runner_fork_server.cc), exchanged between Centipede and the runner through
+// a small shared memory region.
+//
+// This library is used by both the engine and the runner, and is also
+// executed from the fork server very early in the runner process startup.
+// Hence it must not depend on anything other than libc and must not allocate.
+// This library is header-only, with all functions defined as inline.
+
+#ifndef THIRD_PARTY_CENTIPEDE_FORK_SERVER_RING_H_
+#define THIRD_PARTY_CENTIPEDE_FORK_SERVER_RING_H_
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace centipede {
+
+// A single-producer single-consumer ring of 32-bit messages that lives in
+// memory shared between processes. The consumer sleeps on a futex while the
+// ring is empty, so a message is delivered without any syscalls on the
+// producer side other than one FUTEX_WAKE.
+//
+// Must be zero-initialized before use, e.g. by `ftruncate()`-ing a file.
+class ForkServerRing {
+ public:
+  static constexpr uint32_t kCapacity = 16;
+
+  // Returns true if there are no messages to pop.
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_relaxed);
+  }
+
+  // Appends `message` and wakes up the consumer. Returns false if the ring is
+  // full.
+  bool Push(int32_t message) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kCapacity) return false;
+    messages_[head % kCapacity] = message;
+    head_.store(head + 1, std::memory_order_release);
+    syscall(SYS_futex, &head_, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+    return true;
+  }
+
+  // Removes and returns the oldest message. The ring must not be empty.
+  int32_t Pop() {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const int32_t message = messages_[tail % kCapacity];
+    tail_.store(tail + 1, std::memory_order_release);
+    return message;
+  }
+
+  // Blocks until the ring is not empty or until `timeout_ns` nanoseconds
+  // elapse. A negative `timeout_ns` means wait forever. Returns true if the
+  // ring is not empty. Spurious wakeups and EINTR are handled by re-checking
+  // the ring against the remaining time.
+  bool WaitNotEmpty(int64_t timeout_ns) {
+    const int64_t deadline_ns = timeout_ns < 0 ? -1 : NowNs() + timeout_ns;
+    while (true) {
+      const uint32_t head = head_.load(std::memory_order_acquire);
+      if (head != tail_.load(std::memory_order_relaxed)) return true;
+      struct timespec ts = {};
+      struct timespec *ts_ptr = nullptr;
+      if (deadline_ns >= 0) {
+        const int64_t remaining_ns = deadline_ns - NowNs();
+        if (remaining_ns <= 0) return false;
+        ts.tv_sec = remaining_ns / 1000000000;
+        ts.tv_nsec = remaining_ns % 1000000000;
+        ts_ptr = &ts;
+      }
+      // FUTEX_WAIT returns immediately with EAGAIN if `head_` has already
+      // changed: no wakeup can be lost between the check above and the wait.
+      syscall(SYS_futex, &head_, FUTEX_WAIT, head, ts_ptr, nullptr, 0);
+    }
+  }
+
+  // The number of messages ever popped from the ring.
+  uint32_t num_popped() const { return tail_.load(std::memory_order_acquire); }
+  // The number of messages ever pushed to the ring.
+  uint32_t num_pushed() const { return head_.load(std::memory_order_acquire); }
+
+ private:
+  static int64_t NowNs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+  }
+
+  // The futex word. Non-private futex ops are used since the ring is shared
+  // across processes.
+  std::atomic<uint32_t> head_;
+  std::atomic<uint32_t> tail_;
+  int32_t messages_[kCapacity];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+// The shared memory region of the persistent-mode fork server.
+//
+// The protocol, with at most one batch in flight at any time:
+// * Centipede pushes `kRunBatch` to `requests` and waits on `responses`.
+// * The runner pops the request, executes the batch in the same process it
+//   used for the previous batches, and pushes the batch exit status to
+//   `responses`, encoded like the status returned by `waitpid()`.
+// * If the runner process dies with a request popped but not responded to
+//   (a crash, a timeout, an OOM), or never pops the request (the binary does
+//   not support the persistent mode), the fork server pushes the `waitpid()`
+//   status of the dead process on its behalf and forks a new runner process
+//   on the next request.
+struct ForkServerControlBlock {
+  // Request messages.
+  static constexpr int32_t kRunBatch = 1;
+
+  ForkServerRing requests;   // Centipede -> runner.
+  ForkServerRing responses;  // Runner -> Centipede.
+  // The PID of the current runner process, 0 if none. Used by Centipede to
+  // kill a runner process that exceeded the batch timeout.
+  std::atomic<int32_t> runner_pid;
+};
+
+}  // namespace centipede
+
+#endif  // THIRD_PARTY_CENTIPEDE_FORK_SERVER_RING_H_
@@ -93,6 +93,7 @@ void FuzzTestMutator::CrossOverOverwrite(ByteArray &data,
 }
 
 void FuzzTestMutator::CrossOver(ByteArray &data, const ByteArray &other) {
+  if (other.empty()) return;
   if (data.size() >= max_len_) {
     CrossOverOverwrite(data, other);
   } else {
@@ -59,8 +59,9 @@ class FuzzTestMutator {
   // Propagates the execution `metadata` to the internal mutation dictionary.
   void SetMetadata(const ExecutionMetadata& metadata);
 
-  // The crossover algorithm based on the legacy ByteArrayMutator.
-  // TODO(ussuri): Implement and use the domain level crossover.
+  // The crossover algorithm based on the legacy ByteArrayMutator. Unlike the
+  // domain-level `CrossOver()` of `domain_`, it chooses between inserting and
+  // overwriting with `knob_cross_over_insert_or_overwrite`.
   void CrossOverInsert(ByteArray &data, const ByteArray &other);
   void CrossOverOverwrite(ByteArray &data, const ByteArray &other);
   void CrossOver(ByteArray &data, const ByteArray &other);
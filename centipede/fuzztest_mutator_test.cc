@@ -16,6 +16,7 @@
 
 #include <cstddef>
 #include <optional>
+#include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -33,6 +34,7 @@ namespace {
 
 using ::testing::AllOf;
 using ::testing::Each;
+using ::testing::Gt;
 using ::testing::IsSupersetOf;
 using ::testing::Le;
 using ::testing::SizeIs;
@@ -146,6 +148,41 @@ TEST(FuzzTestMutator, CrossOverOverwritesDataFromOtherInputs) {
                        }));
 }
 
+TEST(FuzzTestMutator, CrossOverInsertOrOverwriteFollowsKnob) {
+  for (const bool insert : {true, false}) {
+    // Always cross over, and always insert or always overwrite. Knob values of
+    // 127 and 128 (-128 as signed) make `GenerateBool()` always return true
+    // and false, respectively.
+    std::vector<Knobs::value_type> knob_values;
+    Knobs().ForEachKnob([&](std::string_view name, Knobs::value_type) {
+      if (name == "mutate_or_crossover") {
+        knob_values.push_back(127);
+      } else if (name == "cross_over_insert_or_overwrite") {
+        knob_values.push_back(insert ? 127 : 128);
+      } else {
+        knob_values.push_back(0);
+      }
+    });
+    Knobs knobs;
+    knobs.Set(knob_values);
+    FuzzTestMutator mutator(knobs, /*seed=*/1);
+    std::vector<ByteArray> mutants;
+
+    mutator.MutateMany(
+        {
+            {.data = {0, 1, 2, 3}},
+            {.data = {4, 5, 6, 7}},
+        },
+        /*num_mutants=*/1000, mutants);
+
+    if (insert) {
+      EXPECT_THAT(mutants, Each(SizeIs(Gt(4))));
+    } else {
+      EXPECT_THAT(mutants, Each(SizeIs(4)));
+    }
+  }
+}
+
 // Test parameter containing the mutation settings and the expectations of a
 // single mutation step.
 struct MutationStepTestParameter {
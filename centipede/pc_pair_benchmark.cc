@@ -0,0 +1,137 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the cost of the PC-pair features (see `AddPcPairFeatures()` in
+// feature_set.h) for various values of Centipede's --max_pc_pairs_per_input,
+// e.g.
+//
+//   pc_pair_benchmark --pcs_per_input=2000 --max_pairs=0,10000,100000
+//
+// The workload mimics `Centipede::RunBatch()`: the features of every synthetic
+// input are pruned against the set, the PC-pair features are added and, if
+// the input has unseen features, it is added to the set. For every value of
+// --max_pairs, the throughput (inputs/sec) and the number of PC-pair features
+// added to the set are reported, next to the throughput without PC-pair
+// features at all.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./centipede/config_init.h"
+#include "./centipede/feature.h"
+#include "./centipede/feature_set.h"
+#include "./centipede/util.h"
+
+ABSL_FLAG(std::string, max_pairs, "0,1000,10000,100000",
+          "Comma-separated values of --max_pc_pairs_per_input to benchmark.");
+ABSL_FLAG(size_t, num_inputs, 1000, "Number of synthetic inputs.");
+ABSL_FLAG(size_t, num_pcs, 100000, "Number of PCs in the synthetic target.");
+ABSL_FLAG(size_t, pcs_per_input, 2000,
+          "Number of PCs covered by every synthetic input.");
+ABSL_FLAG(size_t, frequency_threshold, 100,
+          "Same as Centipede's --feature_frequency_threshold.");
+
+namespace centipede {
+
+// Every input covers the same "hot" half of its PCs, mimicking the code that
+// every input executes, and a random "cold" half from the rest of the target.
+std::vector<FeatureVec> MakeSyntheticFeatureVecs() {
+  const size_t num_pcs = absl::GetFlag(FLAGS_num_pcs);
+  const size_t pcs_per_input = absl::GetFlag(FLAGS_pcs_per_input);
+  QCHECK_GT(num_pcs, pcs_per_input);
+  const size_t num_hot_pcs = pcs_per_input / 2;
+  Rng rng(1);
+  std::vector<FeatureVec> feature_vecs(absl::GetFlag(FLAGS_num_inputs));
+  for (auto &features : feature_vecs) {
+    std::vector<size_t> pcs;
+    pcs.reserve(pcs_per_input);
+    for (size_t pc = 0; pc < num_hot_pcs; ++pc) pcs.push_back(pc);
+    while (pcs.size() < pcs_per_input) {
+      pcs.push_back(num_hot_pcs + rng() % (num_pcs - num_hot_pcs));
+    }
+    std::sort(pcs.begin(), pcs.end());
+    pcs.erase(std::unique(pcs.begin(), pcs.end()), pcs.end());
+    for (size_t pc : pcs) {
+      features.push_back(feature_domains::kPCs.ConvertToMe(pc));
+    }
+  }
+  return feature_vecs;
+}
+
+// Runs the workload with --max_pc_pairs_per_input=`max_pairs`, or without
+// PC-pair features if `max_pairs` is nullopt.
+void RunBenchmark(const std::vector<FeatureVec> &feature_vecs,
+                  std::optional<size_t> max_pairs) {
+  FeatureSet feature_set(
+      static_cast<uint8_t>(absl::GetFlag(FLAGS_frequency_threshold)),
+      /*should_discard_domain=*/{});
+  const size_t num_pcs = absl::GetFlag(FLAGS_num_pcs);
+  std::vector<size_t> scratch;
+  size_t num_added_inputs = 0;
+  FeatureVec features;
+  const absl::Time start = absl::Now();
+  for (const auto &input_features : feature_vecs) {
+    features = input_features;
+    bool gained_new_coverage =
+        feature_set.PruneFeaturesAndCountUnseen(features) != 0;
+    if (max_pairs.has_value() &&
+        AddPcPairFeatures(feature_set, num_pcs, *max_pairs, features,
+                          scratch) != 0) {
+      gained_new_coverage = true;
+    }
+    if (!gained_new_coverage) continue;
+    feature_set.IncrementFrequencies(features);
+    ++num_added_inputs;
+  }
+  const absl::Duration duration = absl::Now() - start;
+  LOG(INFO) << absl::StrFormat(
+      "max pairs: %10s | inputs/sec: %10.0f | added inputs: %6d | "
+      "pair features: %10d",
+      max_pairs.has_value() ? absl::StrCat(*max_pairs) : "no pairs",
+      feature_vecs.size() / std::max(absl::ToDoubleSeconds(duration), 1e-9),
+      num_added_inputs, feature_set.CountFeatures(feature_domains::kPCPair));
+}
+
+}  // namespace centipede
+
+int main(int argc, absl::Nonnull<char **> argv) {
+  (void)centipede::config::InitRuntime(argc, argv);
+
+  const auto feature_vecs = centipede::MakeSyntheticFeatureVecs();
+  centipede::RunBenchmark(feature_vecs, std::nullopt);
+  const std::string max_pairs_list = absl::GetFlag(FLAGS_max_pairs);
+  for (const auto max_pairs_str :
+       absl::StrSplit(max_pairs_list, ',', absl::SkipEmpty())) {
+    size_t max_pairs = 0;
+    QCHECK(absl::SimpleAtoi(max_pairs_str, &max_pairs)) << max_pairs_str;
+    centipede::RunBenchmark(feature_vecs, max_pairs);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./centipede/remote_file_reader.h"
+
+#include <cstddef>
+#include <deque>
+#include <future>  // NOLINT(build/c++11)
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/types/span.h"
+#include "./centipede/defs.h"
+#include "./centipede/remote_file.h"
+
+namespace centipede {
+namespace {
+
+// Opens the file only once, rather than checking for its existence first: on a
+// network file system, that would cost another round trip per file, and the
+// file could still disappear in between.
+RemoteFileContents ReadRemoteFileIfExists(const std::string &path) {
+  RemoteFile *file = RemoteFileOpen(path, "r");
+  if (file == nullptr) return std::nullopt;
+  ByteArray contents;
+  RemoteFileRead(file, contents);
+  RemoteFileClose(file);
+  return contents;
+}
+
+}  // namespace
+
+std::future<RemoteFileContents> AsyncRemoteFileReader::Read(std::string path) {
+  return threads_.Submit(
+      [path = std::move(path)]() { return ReadRemoteFileIfExists(path); });
+}
+
+void AsyncRemoteFileReader::Read(
+    std::string path, absl::AnyInvocable<void(RemoteFileContents)> callback) {
+  threads_.Schedule(
+      [path = std::move(path), callback = std::move(callback)]() mutable {
+        std::move(callback)(ReadRemoteFileIfExists(path));
+      });
+}
+
+void ReadRemoteFilesWithReadahead(
+    AsyncRemoteFileReader &reader, absl::Span<const std::string> paths,
+    size_t readahead,
+    absl::FunctionRef<void(size_t, RemoteFileContents)> callback) {
+  std::deque<std::future<RemoteFileContents>> pending_reads;
+  size_t next_path_idx = 0;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    for (; next_path_idx < paths.size() && next_path_idx <= i + readahead;
+         ++next_path_idx) {
+      pending_reads.push_back(reader.Read(paths[next_path_idx]));
+    }
+    RemoteFileContents contents = pending_reads.front().get();
+    pending_reads.pop_front();
+    callback(i, std::move(contents));
+  }
+}
+
+}  // namespace centipede
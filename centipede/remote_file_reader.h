@@ -0,0 +1,79 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Asynchronous reading of whole (potentially remote) files. On network file
+// systems, reading many small files one after another is bound by the latency
+// of every read rather than by the bandwidth: these APIs keep several reads in
+// flight at once, and overlap them with the processing of the files already
+// read.
+//
+// The reads go through `RemoteFileGetContents()` on the reader's own threads,
+// so they work with any implementation of remote_file.h.
+
+#ifndef THIRD_PARTY_CENTIPEDE_REMOTE_FILE_READER_H_
+#define THIRD_PARTY_CENTIPEDE_REMOTE_FILE_READER_H_
+
+#include <cstddef>
+#include <future>  // NOLINT(build/c++11)
+#include <optional>
+#include <string>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/types/span.h"
+#include "./centipede/defs.h"
+#include "./centipede/thread_pool.h"
+
+namespace centipede {
+
+// The contents of a file read by `AsyncRemoteFileReader`, or `std::nullopt`
+// if the file doesn't exist (or otherwise can't be opened for reading).
+using RemoteFileContents = std::optional<ByteArray>;
+
+class AsyncRemoteFileReader {
+ public:
+  // Performs up to `concurrency` reads at a time.
+  explicit AsyncRemoteFileReader(int concurrency) : threads_{concurrency} {}
+
+  // Waits for all the submitted reads to complete.
+  ~AsyncRemoteFileReader() = default;
+
+  AsyncRemoteFileReader(const AsyncRemoteFileReader &) = delete;
+  AsyncRemoteFileReader &operator=(const AsyncRemoteFileReader &) = delete;
+
+  // Submits a read of the file at `path`. The returned future becomes ready
+  // when the read completes.
+  std::future<RemoteFileContents> Read(std::string path);
+
+  // Submits a read of the file at `path`. Calls `callback` with the contents
+  // on one of the reader's threads when the read completes.
+  void Read(std::string path,
+            absl::AnyInvocable<void(RemoteFileContents)> callback);
+
+ private:
+  ThreadPool threads_;
+};
+
+// Calls `callback(i, contents)` for every `paths[i]` in order, on the calling
+// thread. While `callback` runs for `paths[i]`, the files up to
+// `paths[i + readahead]` are being read by `reader` in the background, so at
+// most `readahead + 1` files are held in memory at a time.
+void ReadRemoteFilesWithReadahead(
+    AsyncRemoteFileReader &reader, absl::Span<const std::string> paths,
+    size_t readahead,
+    absl::FunctionRef<void(size_t, RemoteFileContents)> callback);
+
+}  // namespace centipede
+
+#endif  // THIRD_PARTY_CENTIPEDE_REMOTE_FILE_READER_H_
@@ -0,0 +1,110 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./centipede/remote_file_reader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <future>      // NOLINT(build/c++11)
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "./centipede/defs.h"
+#include "./centipede/remote_file.h"
+#include "./centipede/test_util.h"
+
+namespace centipede {
+namespace {
+
+namespace fs = std::filesystem;
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+TEST(AsyncRemoteFileReader, ReadsFilesIntoFutures) {
+  const fs::path temp_dir = GetTestTempDir(test_info_->name());
+  const std::string path1 = temp_dir / "file1";
+  const std::string path2 = temp_dir / "file2";
+  RemoteFileSetContents(path1, ByteArray{1, 2, 3});
+  RemoteFileSetContents(path2, ByteArray{});
+
+  AsyncRemoteFileReader reader{/*concurrency=*/2};
+  std::future<RemoteFileContents> contents1 = reader.Read(path1);
+  std::future<RemoteFileContents> contents2 = reader.Read(path2);
+  std::future<RemoteFileContents> missing =
+      reader.Read(temp_dir / "missing");
+  EXPECT_THAT(contents1.get(), Optional(ByteArray{1, 2, 3}));
+  EXPECT_THAT(contents2.get(), Optional(ByteArray{}));
+  EXPECT_EQ(missing.get(), std::nullopt);
+}
+
+TEST(AsyncRemoteFileReader, CallsCallbacksWithContents) {
+  const fs::path temp_dir = GetTestTempDir(test_info_->name());
+  constexpr size_t kNumFiles = 10;
+  std::vector<std::string> paths;
+  for (size_t i = 0; i < kNumFiles; ++i) {
+    paths.push_back(temp_dir / std::to_string(i));
+    RemoteFileSetContents(paths.back(), ByteArray(i, i));
+  }
+
+  std::vector<RemoteFileContents> contents(kNumFiles);
+  {
+    absl::BlockingCounter done(kNumFiles);
+    AsyncRemoteFileReader reader{/*concurrency=*/3};
+    for (size_t i = 0; i < kNumFiles; ++i) {
+      reader.Read(paths[i], [&contents, &done, i](RemoteFileContents c) {
+        contents[i] = std::move(c);
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+  for (size_t i = 0; i < kNumFiles; ++i) {
+    EXPECT_THAT(contents[i], Optional(ByteArray(i, i))) << i;
+  }
+}
+
+TEST(ReadRemoteFilesWithReadahead, VisitsFilesInOrder) {
+  const fs::path temp_dir = GetTestTempDir(test_info_->name());
+  std::vector<std::string> paths;
+  for (uint8_t i = 0; i < 5; ++i) {
+    paths.push_back(temp_dir / std::to_string(i));
+    if (i != 3) RemoteFileSetContents(paths.back(), ByteArray{i});
+  }
+
+  for (size_t readahead : {0, 1, 2, 100}) {
+    AsyncRemoteFileReader reader{/*concurrency=*/2};
+    std::vector<size_t> indices;
+    std::vector<RemoteFileContents> contents;
+    ReadRemoteFilesWithReadahead(
+        reader, paths, readahead, [&](size_t i, RemoteFileContents c) {
+          indices.push_back(i);
+          contents.push_back(std::move(c));
+        });
+    EXPECT_THAT(indices, ElementsAre(0, 1, 2, 3, 4)) << readahead;
+    EXPECT_THAT(contents, ElementsAre(Optional(ByteArray{0}),
+                                      Optional(ByteArray{1}),
+                                      Optional(ByteArray{2}), std::nullopt,
+                                      Optional(ByteArray{4})))
+        << readahead;
+  }
+}
+
+}  // namespace
+}  // namespace centipede
@@ -406,6 +406,7 @@ PrepareCoverage(bool full_clear) {
     state.cmp_moddiff_set.ForEachNonZeroBit([](size_t idx) {});
     state.cmp_hamming_set.ForEachNonZeroBit([](size_t idx) {});
     state.cmp_difflog_set.ForEachNonZeroBit([](size_t idx) {});
+    state.cmp_switch_set.ForEachNonZeroBit([](size_t idx) {});
   }
   if (state.run_time_flags.path_level != 0)
     state.path_feature_set.ForEachNonZeroBit([](size_t idx) {});
@@ -485,6 +486,9 @@ PostProcessCoverage(int target_return_value) {
     state.cmp_difflog_set.ForEachNonZeroBit([](size_t idx) {
       MaybeAddFeature(feature_domains::kCMPDiffLog.ConvertToMe(idx));
     });
+    state.cmp_switch_set.ForEachNonZeroBit([](size_t idx) {
+      MaybeAddFeature(feature_domains::kCMPSwitch.ConvertToMe(idx));
+    });
   }
 
   // Convert path bit set to features.
@@ -545,6 +549,10 @@ void RunnerCallbacks::GetSeeds(std::function<void(ByteSpan)> seed_callback) {
 
 std::string RunnerCallbacks::GetSerializedTargetConfig() { return ""; }
 
+uint64_t RunnerCallbacks::GetCrossOverLevel() {
+  return state.run_time_flags.crossover_level;
+}
+
 class LegacyRunnerCallbacks : public RunnerCallbacks {
  public:
   LegacyRunnerCallbacks(FuzzerTestOneInputCallback test_one_input_cb,
@@ -723,6 +731,17 @@ static bool FinishSendingOutputsToEngine(BlobSequence &outputs_blobseq) {
   return true;
 }
 
+// Defined by all sanitizer runtimes; null if the binary is not sanitized.
+extern "C" __attribute__((weak)) void __sanitizer_print_stack_trace();
+
+// Returns true if the inputs may be passed to the target right from the shared
+// memory where the engine has put them, without copying. A sanitized target
+// instead gets an exactly sized heap copy of every input, so that reads past
+// the end of the input are detected as heap-buffer-overflows.
+static bool CanExecuteInputsInPlace() {
+  return &__sanitizer_print_stack_trace == nullptr;
+}
+
 // Handles an ExecutionRequest, see RequestExecution(). Reads inputs from
 // `inputs_blobseq`, runs them, saves coverage features to `outputs_blobseq`.
 // Returns EXIT_SUCCESS on success and EXIT_FAILURE otherwise.
@@ -735,23 +754,37 @@ static int ExecuteInputsFromShmem(BlobSequence &inputs_blobseq,
   if (!runner_request::IsNumInputs(inputs_blobseq.Read(), num_inputs))
     return EXIT_FAILURE;
 
+  const bool execute_in_place = CanExecuteInputsInPlace();
   CentipedeBeginExecutionBatch();
 
   for (size_t i = 0; i < num_inputs; i++) {
     auto blob = inputs_blobseq.Read();
     // TODO(kcc): distinguish bad input from end of stream.
-    if (!blob.IsValid()) return EXIT_SUCCESS;  // no more blobs to read.
-    if (!runner_request::IsDataInput(blob)) return EXIT_FAILURE;
+    // No more blobs to read: the engine may have written fewer inputs than it
+    // announced if they didn't fit into the shared memory. Still end the
+    // batch below, or the next batch of a persistent runner would fail to
+    // begin.
+    if (!blob.IsValid()) break;
+    if (!runner_request::IsDataInput(blob)) {
+      CentipedeEndExecutionBatch();
+      return EXIT_FAILURE;
+    }
 
     // TODO(kcc): [impl] handle sizes larger than kMaxDataSize.
     size_t size = std::min(kMaxDataSize, blob.size);
-    // Copy from blob to data so that to not pass the shared memory further.
-    std::vector<uint8_t> data(blob.data, blob.data + size);
+    // Unless executing in place, copy from blob to data so that to not pass
+    // the shared memory further.
+    std::vector<uint8_t> data;
+    if (!execute_in_place) data.assign(blob.data, blob.data + size);
 
     // Starting execution of one more input.
     if (!StartSendingOutputsToEngine(outputs_blobseq)) break;
 
-    RunOneInput(data.data(), data.size(), callbacks);
+    if (execute_in_place) {
+      RunOneInput(blob.data, size, callbacks);
+    } else {
+      RunOneInput(data.data(), data.size(), callbacks);
+    }
 
     if (!FinishSendingOutputsToEngine(outputs_blobseq)) break;
   }
@@ -851,10 +884,10 @@ static unsigned GetRandomSeed() { return time(nullptr); }
 // writes the mutants to `outputs_blobseq`
 // Returns EXIT_SUCCESS on success and EXIT_FAILURE on failure
 // so that main() can return its result.
-// If both `custom_mutator_cb` and `custom_crossover_cb` are nullptr,
-// returns EXIT_FAILURE.
-//
-// TODO(kcc): [impl] make use of custom_crossover_cb, if available.
+// Returns EXIT_FAILURE if `callbacks` cannot mutate, e.g. for the legacy
+// callbacks without `custom_mutator_cb`. The callbacks cross inputs over
+// (with `custom_crossover_cb` or with the domains) `crossover_level`% of the
+// time.
 static int MutateInputsFromShmem(BlobSequence &inputs_blobseq,
                                  BlobSequence &outputs_blobseq,
                                  RunnerCallbacks &callbacks) {
@@ -906,6 +939,7 @@ static int MutateInputsFromShmem(BlobSequence &inputs_blobseq,
 bool LegacyRunnerCallbacks::Mutate(
     const std::vector<MutationInputRef> &inputs, size_t num_mutants,
     std::function<void(ByteSpan)> new_mutant_callback) {
+  // Without a custom mutator, let the engine mutate with its own mutator.
   if (custom_mutator_cb_ == nullptr) return false;
   unsigned int seed = GetRandomSeed();
   const size_t num_inputs = inputs.size();
@@ -922,7 +956,7 @@ bool LegacyRunnerCallbacks::Mutate(
     std::copy(input_data.cbegin(), input_data.cbegin() + size, mutant.begin());
     size_t new_size = 0;
     if ((custom_crossover_cb_ != nullptr) &&
-        rand_r(&seed) % 100 < state.run_time_flags.crossover_level) {
+        rand_r(&seed) % 100 < GetCrossOverLevel()) {
       // Perform crossover `crossover_level`% of the time.
       const auto &other_data = inputs[rand_r(&seed) % num_inputs].data;
       new_size = custom_crossover_cb_(
@@ -997,6 +1031,10 @@ static void MaybePopulateReversePcTable() {
 extern void ForkServerCallMeVeryEarly();
 [[maybe_unused]] auto fake_reference_for_fork_server =
     &ForkServerCallMeVeryEarly;
+// The persistent mode API of the fork server, see runner_fork_server.cc.
+extern bool IsPersistentForkServerChild();
+extern bool PersistentForkServerWaitForBatch();
+extern void PersistentForkServerReportBatchDone(int exit_code);
 // Same for runner_sancov.cc. Avoids the following situation:
 // * weak implementations of sancov callbacks are given in the command line
 //   before centipede.a.
@@ -1071,6 +1109,51 @@ GlobalRunnerState::~GlobalRunnerState() {
   CleanUpDetachedTls();
 }
 
+// Handles one request read from `inputs_blobseq`: either a mutation request
+// or an execution request. Returns the exit code of the request.
+static int HandleShmemRequest(BlobSequence &inputs_blobseq,
+                              BlobSequence &outputs_blobseq,
+                              RunnerCallbacks &callbacks) {
+  // Read the first blob. It indicates what further actions to take.
+  auto request_type_blob = inputs_blobseq.Read();
+  if (runner_request::IsMutationRequest(request_type_blob)) {
+    // Since we are mutating, no need to spend time collecting the coverage.
+    // We still pay for executing the coverage callbacks, but those will
+    // return immediately.
+    // TODO(kcc): do this more consistently, for all coverage types.
+    // The flags are restored afterwards, since in the persistent mode the
+    // same process may execute inputs next.
+    auto &flags = state.run_time_flags;
+    const bool use_cmp_features = flags.use_cmp_features;
+    const bool use_pc_features = flags.use_pc_features;
+    const bool use_dataflow_features = flags.use_dataflow_features;
+    const bool use_counter_features = flags.use_counter_features;
+    flags.use_cmp_features = false;
+    flags.use_pc_features = false;
+    flags.use_dataflow_features = false;
+    flags.use_counter_features = false;
+    // Mutation request.
+    inputs_blobseq.Reset();
+    if (state.byte_array_mutator == nullptr) {
+      state.byte_array_mutator =
+          new ByteArrayMutator(state.knobs, GetRandomSeed());
+    }
+    const int exit_code =
+        MutateInputsFromShmem(inputs_blobseq, outputs_blobseq, callbacks);
+    flags.use_cmp_features = use_cmp_features;
+    flags.use_pc_features = use_pc_features;
+    flags.use_dataflow_features = use_dataflow_features;
+    flags.use_counter_features = use_counter_features;
+    return exit_code;
+  }
+  if (runner_request::IsExecutionRequest(request_type_blob)) {
+    // Execution request.
+    inputs_blobseq.Reset();
+    return ExecuteInputsFromShmem(inputs_blobseq, outputs_blobseq, callbacks);
+  }
+  return EXIT_FAILURE;
+}
+
 // If HasFlag(:shmem:), state.arg1 and state.arg2 are the names
 //  of in/out shared memory locations.
 //  Read inputs and write outputs via shared memory.
@@ -1101,29 +1184,20 @@ int RunnerMain(int argc, char **argv, RunnerCallbacks &callbacks) {
     if (!state.arg1 || !state.arg2) return EXIT_FAILURE;
     SharedMemoryBlobSequence inputs_blobseq(state.arg1);
     SharedMemoryBlobSequence outputs_blobseq(state.arg2);
-    // Read the first blob. It indicates what further actions to take.
-    auto request_type_blob = inputs_blobseq.Read();
-    if (runner_request::IsMutationRequest(request_type_blob)) {
-      // Since we are mutating, no need to spend time collecting the coverage.
-      // We still pay for executing the coverage callbacks, but those will
-      // return immediately.
-      // TODO(kcc): do this more consistently, for all coverage types.
-      state.run_time_flags.use_cmp_features = false;
-      state.run_time_flags.use_pc_features = false;
-      state.run_time_flags.use_dataflow_features = false;
-      state.run_time_flags.use_counter_features = false;
-      // Mutation request.
-      inputs_blobseq.Reset();
-      state.byte_array_mutator =
-          new ByteArrayMutator(state.knobs, GetRandomSeed());
-      return MutateInputsFromShmem(inputs_blobseq, outputs_blobseq, callbacks);
+    if (!IsPersistentForkServerChild()) {
+      return HandleShmemRequest(inputs_blobseq, outputs_blobseq, callbacks);
     }
-    if (runner_request::IsExecutionRequest(request_type_blob)) {
-      // Execution request.
+    // Persistent mode: serve batches in this process until Centipede goes
+    // away. The shared memory regions stay mapped across the batches.
+    while (PersistentForkServerWaitForBatch()) {
       inputs_blobseq.Reset();
-      return ExecuteInputsFromShmem(inputs_blobseq, outputs_blobseq, callbacks);
+      outputs_blobseq.Reset();
+      const int exit_code =
+          HandleShmemRequest(inputs_blobseq, outputs_blobseq, callbacks);
+      fflush(stdout);
+      PersistentForkServerReportBatchDone(exit_code);
     }
-    return EXIT_FAILURE;
+    return EXIT_SUCCESS;
   }
 
   // By default, run every input file one-by-one.
@@ -261,7 +261,7 @@ struct GlobalRunnerState {
       absl::kConstInit};
 
   // Tracing CMP instructions, capture events from these domains:
-  // kCMPEq, kCMPModDiff, kCMPHamming, kCMPModDiffLog, kCMPMsbEq.
+  // kCMPEq, kCMPModDiff, kCMPHamming, kCMPModDiffLog, kCMPMsbEq, kCMPSwitch.
   // See https://clang.llvm.org/docs/SanitizerCoverage.html#tracing-data-flow.
   // An arbitrarily large size.
   static constexpr size_t kCmpFeatureSetSize = 1 << 18;
@@ -271,6 +271,7 @@ struct GlobalRunnerState {
   ConcurrentBitSet<kCmpFeatureSetSize> cmp_moddiff_set{absl::kConstInit};
   ConcurrentBitSet<kCmpFeatureSetSize> cmp_hamming_set{absl::kConstInit};
   ConcurrentBitSet<kCmpFeatureSetSize> cmp_difflog_set{absl::kConstInit};
+  ConcurrentBitSet<kCmpFeatureSetSize> cmp_switch_set{absl::kConstInit};
 
   // We think that call stack produces rich signal, so we give a few bits to it.
   static constexpr size_t kCallStackFeatureSetSize = 1 << 24;
@@ -44,6 +44,25 @@
 //
 // Other than performance, using fork server should be the same as not using it.
 //
+// Persistent mode:
+// * Centipede additionally creates a small shared memory file with two rings
+//   of control messages (see fork_server_ring.h) and passes its name to the
+//   runner using the CENTIPEDE_FORK_SERVER_RING environment variable.
+// * The FIFOs are still opened at startup as described above, but no longer
+//   carry any data: Centipede closing pipe0 tells the runner to exit.
+// * Runner forks when it sees a request in the ring while there is no child.
+// * The child (see RunnerMain) pops the request, executes the batch and
+//   pushes its exit status back to the ring, then waits for the next request,
+//   all in the same process. The coverage is reset between the batches.
+// * The fork server waits for the child to die. If the child dies with a
+//   request popped but not responded to (crash, timeout, OOM), or without
+//   ever popping the request (the binary doesn't support the persistent
+//   mode), the fork server pushes the child's exit status on its behalf.
+//   The next request is then served by a new child.
+// So in the persistent mode we fork only to recover from a crash or a
+// timeout, and a batch costs two futex-backed ring operations instead of a
+// fork and two FIFO round trips.
+//
 // Similar ideas:
 // * lcamtuf.blogspot.com/2014/10/fuzzing-binaries-without-execve.html
 // * Android Zygote.
@@ -53,14 +72,18 @@
 
 #include <fcntl.h>
 #include <linux/limits.h>  // ARG_MAX
+#include <poll.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
 #include "absl/base/nullability.h"
+#include "./centipede/fork_server_ring.h"
 
 namespace centipede {
 
@@ -111,6 +134,91 @@ absl::Nullable<const char *> GetOneEnv(absl::Nonnull<const char *> key) {
   return nullptr;
 }
 
+// The shared control block in the persistent mode, nullptr otherwise.
+static ForkServerControlBlock *control_block = nullptr;
+// The read end of pipe0, used to detect that Centipede has gone away.
+static int engine_pipe = -1;
+// True in the child process forked by the persistent-mode fork server.
+static bool is_persistent_child = false;
+
+// How often to check if Centipede is still alive while waiting for a request.
+static constexpr int64_t kEngineLivenessCheckIntervalNs = 100 * 1000 * 1000;
+
+// Returns true if Centipede has closed its end of pipe0.
+static bool EngineIsGone() {
+  struct pollfd poll_fd = {.fd = engine_pipe, .events = POLLIN};
+  return poll(&poll_fd, 1, /*timeout=*/0) == 1 &&
+         (poll_fd.revents & (POLLHUP | POLLERR)) != 0;
+}
+
+// Blocks until there is a request in `control_block->requests`. Returns false
+// if Centipede has gone away in the meantime.
+static bool WaitForRequest() {
+  while (!control_block->requests.WaitNotEmpty(kEngineLivenessCheckIntervalNs))
+    if (EngineIsGone()) return false;
+  return true;
+}
+
+// Rewinds and truncates stdout/stderr so that they contain only the output of
+// the current execution.
+static void ResetStdoutAndStderr() {
+  for (int fd = 1; fd <= 2; fd++) {
+    lseek(fd, 0, SEEK_SET);
+    // NOTE: Allow ftruncate() to fail by ignoring its return; that okay to
+    // happen when the stdout/stderr are not redirected to a file.
+    (void)ftruncate(fd, 0);
+  }
+}
+
+// Maps the persistent-mode control block from the file `path`.
+static void MapControlBlock(absl::Nonnull<const char *> path) {
+  int fd = open(path, O_RDWR);
+  if (fd < 0) Exit("###open ring failed\n");
+  void *addr = mmap(nullptr, sizeof(ForkServerControlBlock),
+                    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) Exit("###mmap ring failed\n");
+  if (close(fd) != 0) Exit("###close ring failed\n");
+  control_block = static_cast<ForkServerControlBlock *>(addr);
+}
+
+// Called by the persistent-mode fork server after the child with `status`
+// died. Responds to the request on the child's behalf if needed.
+static void RespondForDeadChild(int status) {
+  control_block->runner_pid.store(0);
+  if (!control_block->requests.Empty()) {
+    // The child never popped the request.
+    (void)control_block->requests.Pop();
+  } else if (control_block->requests.num_popped() ==
+             control_block->responses.num_pushed()) {
+    // The child died between the batches; nobody is waiting for a response.
+    return;
+  }
+  Log("###Centipede fork server pushing status to ring\n");
+  if (!control_block->responses.Push(status))
+    Exit("###push to ring failed\n");
+}
+
+bool IsPersistentForkServerChild() { return is_persistent_child; }
+
+// Blocks until Centipede requests the next batch. Returns false if Centipede
+// has gone away or sent something other than a batch request.
+// Must be called only if IsPersistentForkServerChild().
+bool PersistentForkServerWaitForBatch() {
+  if (!WaitForRequest()) return false;
+  if (control_block->requests.Pop() != ForkServerControlBlock::kRunBatch)
+    return false;
+  ResetStdoutAndStderr();
+  return true;
+}
+
+// Reports to Centipede that the current batch finished with `exit_code`.
+// Must be called only if IsPersistentForkServerChild().
+void PersistentForkServerReportBatchDone(int exit_code) {
+  // Encode the exit code the way waitpid() does.
+  if (!control_block->responses.Push((exit_code & 0xff) << 8))
+    Exit("###push to ring failed\n");
+}
+
 // Starts the fork server if the pipes are given.
 // This function is called from `.preinit_array` when linked statically,
 // or from the DSO constructor when injected via LD_PRELOAD.
@@ -139,25 +247,33 @@ __attribute__((constructor(150))) void ForkServerCallMeVeryEarly() {
   if (pipe0 < 0) Exit("###open pipe0 failed\n");
   int pipe1 = open(pipe1_name, O_WRONLY);
   if (pipe1 < 0) Exit("###open pipe1 failed\n");
+  engine_pipe = pipe0;
+  const char *ring_name = GetOneEnv("CENTIPEDE_FORK_SERVER_RING=");
+  if (ring_name != nullptr) MapControlBlock(ring_name);
   Log("###Centipede fork server ready\n");
 
   // Loop.
   while (true) {
-    Log("###Centipede fork server blocking on pipe0\n");
-    // This read will fail when Centipede shuts down the pipes.
-    char ch = 0;
-    if (read(pipe0, &ch, 1) != 1) Exit("###read from pipe0 failed\n");
+    if (control_block != nullptr) {
+      Log("###Centipede fork server blocking on ring\n");
+      // Don't pop the request: the child will.
+      if (!WaitForRequest()) Exit("###Centipede closed pipe0\n");
+    } else {
+      Log("###Centipede fork server blocking on pipe0\n");
+      // This read will fail when Centipede shuts down the pipes.
+      char ch = 0;
+      if (read(pipe0, &ch, 1) != 1) Exit("###read from pipe0 failed\n");
+    }
     Log("###Centipede starting fork\n");
     auto pid = fork();
     if (pid < 0) {
       Exit("###fork failed\n");
     } else if (pid == 0) {
       // Child process. Reset stdout/stderr and let it run normally.
-      for (int fd = 1; fd <= 2; fd++) {
-        lseek(fd, 0, SEEK_SET);
-        // NOTE: Allow ftruncate() to fail by ignoring its return; that okay to
-        // happen when the stdout/stderr are not redirected to a file.
-        (void)ftruncate(fd, 0);
+      ResetStdoutAndStderr();
+      if (control_block != nullptr) {
+        is_persistent_child = true;
+        control_block->runner_pid.store(getpid());
       }
       return;
     } else {
@@ -174,6 +290,10 @@ __attribute__((constructor(150))) void ForkServerCallMeVeryEarly() {
       } else {
         Log("###Centipede fork crashed\n");
       }
+      if (control_block != nullptr) {
+        RespondForDeadChild(status);
+        continue;
+      }
       Log("###Centipede fork writing status to pipe1\n");
       if (write(pipe1, &status, sizeof(status)) == -1)
         Exit("###write to pipe1 failed\n");
@@ -144,6 +144,11 @@ class RunnerCallbacks {
                       size_t num_mutants,
                       std::function<void(ByteSpan)> new_mutant_callback) = 0;
   virtual ~RunnerCallbacks() = default;
+
+ protected:
+  // Returns the percentage of the mutants that `Mutate()` should create by
+  // crossing inputs over, as set by the `crossover_level` runner flag.
+  static uint64_t GetCrossOverLevel();
 };
 
 // Wraps legacy fuzzer callbacks into a `RunnerCallbacks` instance.
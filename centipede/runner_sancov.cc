@@ -93,6 +93,97 @@ ENFORCE_INLINE static void TraceCmp(uint64_t Arg1, uint64_t Arg2) {
   }
 }
 
+// Captures the pair {`a`, `b`}, truncated to `T`, for the CMP dictionary.
+// Unlike `CmpTrace::Capture(T, T)`, keeps the small values too: the case
+// values of a switch statement are often small, e.g. opcodes or tags.
+template <typename T, typename CmpTraceT>
+static void CaptureSwitchPair(CmpTraceT &cmp_trace, uint64_t a, uint64_t b) {
+  const T a_value = a;
+  const T b_value = b;
+  cmp_trace.Capture(sizeof(T), reinterpret_cast<const uint8_t *>(&a_value),
+                    reinterpret_cast<const uint8_t *>(&b_value));
+}
+
+// Captures {`val`, `case_value`} for the CMP dictionary, so that the mutator
+// can replace one with the other. 1-byte values are too short for the
+// dictionary, same as for 1-byte CMPs.
+static void CaptureSwitchCase(uint64_t size_in_bits, uint64_t val,
+                              uint64_t case_value) {
+  switch (size_in_bits) {
+    case 16:
+      CaptureSwitchPair<uint16_t>(tls.cmp_trace2, val, case_value);
+      break;
+    case 32:
+      CaptureSwitchPair<uint32_t>(tls.cmp_trace4, val, case_value);
+      break;
+    case 64:
+      CaptureSwitchPair<uint64_t>(tls.cmp_trace8, val, case_value);
+      break;
+  }
+}
+
+// Tracing switch statements.
+// `cases[0]` is the number of case values, `cases[1]` is the size of `val` in
+// bits, and `cases[2:]` are the case values. See
+// https://clang.llvm.org/docs/SanitizerCoverage.html#tracing-data-flow.
+//
+// A switch is a multi-way CMP: the feature is formed from the same context as
+// in TraceCmp() and from either the index of the matched case or, if no case
+// matched, the log distance from `val` to the closest case. The closest case
+// values below and above `val` are captured for the CMP dictionary: if `val`
+// comes from the input, this lets the mutator steer it to a different case.
+//
+// NOTE: Enforce inlining so that `__builtin_return_address` works.
+ENFORCE_INLINE static void TraceSwitch(uint64_t val, const uint64_t *cases) {
+  const bool use_cmp_features = state.run_time_flags.use_cmp_features;
+  const bool use_auto_dictionary = state.run_time_flags.use_auto_dictionary;
+  if (!use_cmp_features && !use_auto_dictionary) return;
+  const uint64_t num_cases = cases[0];
+  const uint64_t size_in_bits = cases[1];
+  if (num_cases == 0) return;
+  const uint64_t mask =
+      size_in_bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << size_in_bits) - 1;
+  val &= mask;
+  // The case values are sorted by the compiler, but we don't rely on that.
+  bool has_below = false;
+  bool has_above = false;
+  uint64_t below = 0;  // The largest case value < `val`.
+  uint64_t above = 0;  // The smallest case value > `val`.
+  uint64_t matched_idx = num_cases;
+  for (uint64_t i = 0; i < num_cases; ++i) {
+    const uint64_t case_value = cases[2 + i] & mask;
+    if (case_value == val) {
+      matched_idx = i;
+    } else if (case_value < val) {
+      if (!has_below || case_value > below) below = case_value;
+      has_below = true;
+    } else {
+      if (!has_above || case_value < above) above = case_value;
+      has_above = true;
+    }
+  }
+  if (use_cmp_features) {
+    auto caller_pc = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
+    auto pc_offset = caller_pc - state.main_object.start_address;
+    uintptr_t hash =
+        centipede::Hash64Bits(pc_offset) ^ tls.path_ring_buffer.hash();
+    hash <<= 7;  // Matched: [0, 64), unmatched: 64 + ABToCmpDiffLog().
+    if (matched_idx != num_cases) {
+      state.cmp_switch_set.set(hash | (matched_idx % 64));
+    } else {
+      const uint64_t closest =
+          !has_above || (has_below && val - below <= above - val) ? below
+                                                                  : above;
+      state.cmp_switch_set.set(hash |
+                               (64 + centipede::ABToCmpDiffLog(val, closest)));
+    }
+  }
+  if (use_auto_dictionary) {
+    if (has_below) CaptureSwitchCase(size_in_bits, val, below);
+    if (has_above) CaptureSwitchCase(size_in_bits, val, above);
+  }
+}
+
 //------------------------------------------------------------------------------
 // Implementations of the external sanitizer coverage hooks.
 //------------------------------------------------------------------------------
@@ -148,9 +239,10 @@ void __sanitizer_cov_trace_cmp8(uint64_t Arg1, uint64_t Arg2) {
   if (Arg1 != Arg2 && state.run_time_flags.use_auto_dictionary)
     tls.cmp_trace8.Capture(Arg1, Arg2);
 }
-// TODO(kcc): [impl] handle switch.
 NO_SANITIZE
-void __sanitizer_cov_trace_switch(uint64_t Val, uint64_t *Cases) {}
+void __sanitizer_cov_trace_switch(uint64_t Val, uint64_t *Cases) {
+  TraceSwitch(Val, Cases);
+}
 
 // This function is called at startup when
 // -fsanitize-coverage=inline-8bit-counters is used.
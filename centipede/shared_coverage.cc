@@ -0,0 +1,59 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./centipede/shared_coverage.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+#include "./centipede/feature_set.h"
+
+namespace centipede {
+
+SharedCoverage::SharedCoverage(
+    uint8_t frequency_threshold,
+    FeatureSet::FeatureDomainSet should_discard_domain, size_t num_instances)
+    : feature_set_(frequency_threshold, should_discard_domain,
+                   /*use_sparse_storage=*/false, /*concurrent=*/true),
+      num_instances_(num_instances),
+      inboxes_(std::make_unique<Inbox[]>(num_instances)) {
+  CHECK_GE(num_instances, 1);
+}
+
+void SharedCoverage::Publish(size_t instance_index, SharedCorpusInput input) {
+  CHECK_LT(instance_index, num_instances_);
+  auto shared_input =
+      std::make_shared<const SharedCorpusInput>(std::move(input));
+  for (size_t i = 0; i < num_instances_; ++i) {
+    if (i == instance_index) continue;
+    absl::MutexLock lock(&inboxes_[i].mu);
+    inboxes_[i].inputs.push_back(shared_input);
+  }
+}
+
+std::vector<std::shared_ptr<const SharedCorpusInput>>
+SharedCoverage::TakePublished(size_t instance_index) {
+  CHECK_LT(instance_index, num_instances_);
+  std::vector<std::shared_ptr<const SharedCorpusInput>> inputs;
+  absl::MutexLock lock(&inboxes_[instance_index].mu);
+  inputs.swap(inboxes_[instance_index].inputs);
+  return inputs;
+}
+
+}  // namespace centipede
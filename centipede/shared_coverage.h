@@ -0,0 +1,90 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CENTIPEDE_SHARED_COVERAGE_H_
+#define THIRD_PARTY_CENTIPEDE_SHARED_COVERAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "./centipede/defs.h"
+#include "./centipede/execution_metadata.h"
+#include "./centipede/feature.h"
+#include "./centipede/feature_set.h"
+
+namespace centipede {
+
+// An input added to the corpus by one of the instances sharing a
+// `SharedCoverage`, along with its pruned features.
+struct SharedCorpusInput {
+  ByteArray data;
+  FeatureVec features;
+  ExecutionMetadata metadata;
+};
+
+// Coverage state shared by `num_instances` fuzzing instances (`Centipede`
+// objects) running in different threads of one process.
+//
+// The instances update one concurrent `FeatureSet`, so a feature observed by
+// any of them is no longer new for the others. An instance that adds an input
+// to its corpus publishes it, and the other instances take it into their own
+// corpora (see `Publish()` and `TakePublished()`), so that they can mutate it
+// without re-reading the corpus files.
+//
+// Thread-safe.
+class SharedCoverage {
+ public:
+  // The parameters of the shared feature set are as in `FeatureSet`.
+  SharedCoverage(uint8_t frequency_threshold,
+                 FeatureSet::FeatureDomainSet should_discard_domain,
+                 size_t num_instances);
+
+  // Non-copyable and non-movable.
+  SharedCoverage(const SharedCoverage &) = delete;
+  SharedCoverage &operator=(const SharedCoverage &) = delete;
+
+  // The feature set shared by all instances.
+  FeatureSet &feature_set() { return feature_set_; }
+
+  size_t num_instances() const { return num_instances_; }
+
+  // Makes `input` available to all instances except `instance_index`.
+  void Publish(size_t instance_index, SharedCorpusInput input);
+
+  // Returns the inputs published by other instances since the previous call
+  // for `instance_index`, in the order they were published.
+  std::vector<std::shared_ptr<const SharedCorpusInput>> TakePublished(
+      size_t instance_index);
+
+ private:
+  // The inputs published for one instance. An input is stored only once and
+  // referenced by the inboxes of all the instances that haven't taken it yet.
+  struct Inbox {
+    absl::Mutex mu;
+    std::vector<std::shared_ptr<const SharedCorpusInput>> inputs
+        ABSL_GUARDED_BY(mu);
+  };
+
+  FeatureSet feature_set_;
+  const size_t num_instances_;
+  std::unique_ptr<Inbox[]> inboxes_;
+};
+
+}  // namespace centipede
+
+#endif  // THIRD_PARTY_CENTIPEDE_SHARED_COVERAGE_H_
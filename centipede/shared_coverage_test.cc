@@ -0,0 +1,101 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./centipede/shared_coverage.h"
+
+#include <cstddef>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "./centipede/defs.h"
+#include "./centipede/feature.h"
+
+namespace centipede {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+std::vector<ByteArray> TakePublishedData(SharedCoverage &shared_coverage,
+                                         size_t instance_index) {
+  std::vector<ByteArray> data;
+  for (const auto &input : shared_coverage.TakePublished(instance_index)) {
+    data.push_back(input->data);
+  }
+  return data;
+}
+
+TEST(SharedCoverageTest, PublishesInputsToOtherInstances) {
+  SharedCoverage shared_coverage(/*frequency_threshold=*/100,
+                                 /*should_discard_domain=*/{},
+                                 /*num_instances=*/3);
+  EXPECT_TRUE(shared_coverage.feature_set().IsConcurrent());
+  shared_coverage.Publish(0, {.data = {1}, .features = {10}});
+  shared_coverage.Publish(1, {.data = {2}, .features = {20}});
+  shared_coverage.Publish(0, {.data = {3}, .features = {30}});
+
+  EXPECT_EQ(TakePublishedData(shared_coverage, 0),
+            (std::vector<ByteArray>{{2}}));
+  EXPECT_EQ(TakePublishedData(shared_coverage, 1),
+            (std::vector<ByteArray>{{1}, {3}}));
+  EXPECT_EQ(TakePublishedData(shared_coverage, 2),
+            (std::vector<ByteArray>{{1}, {2}, {3}}));
+  // Every input is taken only once.
+  for (size_t i = 0; i < shared_coverage.num_instances(); ++i) {
+    EXPECT_THAT(shared_coverage.TakePublished(i), IsEmpty());
+  }
+}
+
+TEST(SharedCoverageTest, SharesFeaturesAndInputsBetweenThreads) {
+  constexpr size_t kNumInstances = 4;
+  constexpr size_t kNumFeatures = 1000;
+  SharedCoverage shared_coverage(/*frequency_threshold=*/100,
+                                 /*should_discard_domain=*/{}, kNumInstances);
+  // All instances observe the same features; each admits only the inputs
+  // whose feature is still new, as `Centipede::RunBatch()` does.
+  std::vector<size_t> num_admitted(kNumInstances);
+  {
+    std::vector<std::thread> threads;
+    for (size_t instance = 0; instance < kNumInstances; ++instance) {
+      threads.emplace_back([&shared_coverage, &num_admitted, instance]() {
+        FeatureSet &feature_set = shared_coverage.feature_set();
+        for (size_t i = 0; i < kNumFeatures; ++i) {
+          FeatureVec features = {feature_domains::kPCs.ConvertToMe(i)};
+          if (feature_set.PruneFeaturesAndCountUnseen(features) == 0) continue;
+          feature_set.IncrementFrequencies(features);
+          shared_coverage.Publish(
+              instance, {.data = {static_cast<uint8_t>(i)}, .features = {}});
+          ++num_admitted[instance];
+        }
+      });
+    }
+    for (std::thread &thread : threads) thread.join();
+  }
+  EXPECT_EQ(shared_coverage.feature_set().size(), kNumFeatures);
+  size_t total_admitted = 0;
+  for (size_t admitted : num_admitted) total_admitted += admitted;
+  // Two instances may both see a feature as new before either one counts it,
+  // so a feature may be admitted more than once, but never zero times.
+  EXPECT_GE(total_admitted, kNumFeatures);
+  for (size_t instance = 0; instance < kNumInstances; ++instance) {
+    EXPECT_THAT(shared_coverage.TakePublished(instance),
+                SizeIs(total_admitted - num_admitted[instance]));
+  }
+}
+
+}  // namespace
+}  // namespace centipede
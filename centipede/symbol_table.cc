@@ -85,7 +85,7 @@ void SymbolTable::ReadFromLLVMSymbolizer(std::istream &in) {
   }
 }
 
-void SymbolTable::WriteToLLVMSymbolizer(std::ostream &out) {
+void SymbolTable::WriteToLLVMSymbolizer(std::ostream &out) const {
   for (const Entry &entry : entries_) {
     out << entry.func << '\n';
     out << entry.file_line_col() << '\n';
@@ -147,56 +147,76 @@ void SymbolTable::GetSymbolsFromOneDso(absl::Span<const PCInfo> pc_infos,
   }
 }
 
-void SymbolTable::GetSymbolsFromBinary(const PCTable &pc_table,
+bool SymbolTable::GetSymbolsFromBinary(const PCTable &pc_table,
                                        const DsoTable &dso_table,
                                        std::string_view symbolizer_path,
-                                       std::string_view tmp_dir_path) {
+                                       std::string_view tmp_dir_path,
+                                       size_t max_pcs_per_symbolizer_run) {
   // NOTE: --symbolizer_path=/dev/null is a somewhat expected alternative to
   // "" that users might pass.
   if (symbolizer_path.empty() || symbolizer_path == "/dev/null") {
     LOG(WARNING) << "Symbolizer unspecified: debug symbols will not be used";
     SetAllToUnknown(pc_table.size());
-    return;
+    return false;
+  }
+  CHECK_GT(max_pcs_per_symbolizer_run, 0);
+
+  // Split the PCs of every DSO into chunks, so that a DSO with many PCs is
+  // symbolized by several symbolizer processes.
+  struct Chunk {
+    const DsoInfo &dso_info;
+    absl::Span<const PCInfo> pc_infos;
+  };
+  std::vector<Chunk> chunks;
+  size_t pc_idx_begin = 0;
+  for (const auto &dso_info : dso_table) {
+    CHECK_LE(pc_idx_begin + dso_info.num_instrumented_pcs, pc_table.size())
+        << VV(pc_idx_begin) << VV(dso_info.num_instrumented_pcs);
+    for (size_t offset = 0; offset < dso_info.num_instrumented_pcs;
+         offset += max_pcs_per_symbolizer_run) {
+      const size_t chunk_size = std::min(
+          max_pcs_per_symbolizer_run, dso_info.num_instrumented_pcs - offset);
+      chunks.push_back(
+          {dso_info, {pc_table.data() + pc_idx_begin + offset, chunk_size}});
+    }
+    pc_idx_begin += dso_info.num_instrumented_pcs;
   }
+  CHECK_EQ(pc_idx_begin, pc_table.size());
 
-  LOG(INFO) << "Symbolizing " << dso_table.size() << " instrumented DSOs.";
+  LOG(INFO) << "Symbolizing " << dso_table.size() << " instrumented DSOs in "
+            << chunks.size() << " chunks.";
 
-  // Iterate all DSOs, symbolize their respective PCs.
   // Symbolizing the PCs can take time, so we
-  // record them in parallel into separate symbol tables,
+  // record the chunks in parallel into separate symbol tables,
   // and later merge.
-  std::vector<SymbolTable> symbol_tables(dso_table.size());
-  size_t pc_idx_begin = 0;
-  {
+  std::vector<SymbolTable> symbol_tables(chunks.size());
+  if (!chunks.empty()) {
     // Symbolization is quite IO-bound so we arbitrarily run 30 at once
     // even if we have few CPUs.
-    const size_t num_threads = std::min(dso_table.size(), 30UL);
+    const size_t num_threads = std::min(chunks.size(), 30UL);
     centipede::ThreadPool thread_pool(num_threads);
-    for (size_t dso_id = 0; dso_id < dso_table.size(); ++dso_id) {
-      const auto &dso_info = dso_table[dso_id];
-      auto &symbol_table = symbol_tables[dso_id];
-      CHECK_LE(pc_idx_begin + dso_info.num_instrumented_pcs, pc_table.size())
-          << VV(pc_idx_begin) << VV(dso_info.num_instrumented_pcs);
-      const absl::Span<const PCInfo> pc_infos = {pc_table.data() + pc_idx_begin,
-                                                 dso_info.num_instrumented_pcs};
-      thread_pool.Schedule([&dso_info, pc_infos, symbolizer_path, tmp_dir_path,
-                            &symbol_table]() {
-        symbol_table.GetSymbolsFromOneDso(pc_infos, dso_info.path,
-                                          symbolizer_path, tmp_dir_path);
-      });
-      pc_idx_begin += dso_info.num_instrumented_pcs;
+    for (size_t chunk_id = 0; chunk_id < chunks.size(); ++chunk_id) {
+      const Chunk &chunk = chunks[chunk_id];
+      auto &symbol_table = symbol_tables[chunk_id];
+      thread_pool.Schedule(
+          [&chunk, symbolizer_path, tmp_dir_path, &symbol_table]() {
+            symbol_table.GetSymbolsFromOneDso(chunk.pc_infos,
+                                              chunk.dso_info.path,
+                                              symbolizer_path, tmp_dir_path);
+          });
     }
   }
   for (const auto &table : symbol_tables) {
     AddEntries(table);
   }
-  CHECK_EQ(pc_idx_begin, pc_table.size());
 
   if (size() != pc_table.size()) {
     // Something went wrong. Set symbols to unknown so the sizes of pc_table and
     // symbols always match.
     SetAllToUnknown(pc_table.size());
+    return false;
   }
+  return true;
 }
 
 void SymbolTable::SetAllToUnknown(size_t size) {
@@ -74,16 +74,23 @@ class SymbolTable {
 
   // Writes the contents of `this` to `path` in the same format as read by
   // `ReadFromLLVMSymbolizer`.
-  void WriteToLLVMSymbolizer(std::ostream &out);
+  void WriteToLLVMSymbolizer(std::ostream &out) const;
+
+  // The default maximal number of PCs symbolized by one symbolizer process.
+  static constexpr size_t kMaxPCsPerSymbolizerRun = 50000;
 
   // Invokes `symbolizer_path --no-inlines` on all binaries from `dso_table`,
   // pipes through it all the PCs in `pc_table` that correspond to each of the
-  // binaries, and calls `ReadFromLLVMSymbolizer()` on the output.
-  // Possibly uses files `pcs_tmp_path` and `symbols_tmp_path` for temporary
-  // storage.
-  void GetSymbolsFromBinary(const PCTable &pc_table, const DsoTable &dso_table,
-                            std::string_view symbolizer_path,
-                            std::string_view tmp_dir_path);
+  // binaries, and calls `ReadFromLLVMSymbolizer()` on the output. The PCs of
+  // each binary are split into chunks of at most `max_pcs_per_symbolizer_run`
+  // PCs, symbolized in parallel.
+  // Uses files in `tmp_dir_path` for temporary storage.
+  // Returns false if the symbolization failed, in which case all the symbols
+  // are unknown.
+  bool GetSymbolsFromBinary(
+      const PCTable &pc_table, const DsoTable &dso_table,
+      std::string_view symbolizer_path, std::string_view tmp_dir_path,
+      size_t max_pcs_per_symbolizer_run = kMaxPCsPerSymbolizerRun);
 
   // Helper for `GetSymbolsFromBinary()`: symbolizes `pc_infos` for `dso_path`.
   // Possibly uses files `pcs_tmp_path` and `symbols_tmp_path` for temporary
@@ -16,28 +16,45 @@
 #ifndef THIRD_PARTY_CENTIPEDE_THREAD_POOL_H_
 #define THIRD_PARTY_CENTIPEDE_THREAD_POOL_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
-#include <queue>
+#include <deque>
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
 #include <thread>  // NOLINT(build/c++11)
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/synchronization/mutex.h"
 
 namespace centipede {
 
-// A simple ThreadPool implementation.
+// A work-stealing ThreadPool.
+//
+// Every worker thread owns a deque of tasks. Tasks scheduled from a worker
+// thread go to the back of its own deque and are popped from there (LIFO, for
+// cache locality); tasks scheduled from other threads are spread round-robin
+// over all the deques. A worker whose deque is empty steals from the front of
+// the other workers' deques, so one worker blocked in a long task does not
+// hold back the tasks queued behind it.
+//
+// The destructor waits for all the scheduled tasks, including the ones
+// scheduled by other tasks while the pool is shutting down, to finish.
 class ThreadPool {
  public:
   // Initializes this ThreadPool by starting the requested number of worker
   // threads.
-  explicit ThreadPool(int num_threads) {
+  explicit ThreadPool(int num_threads) : queues_(std::max(num_threads, 1)) {
     threads_.reserve(num_threads);
     for (int i = 0; i < num_threads; ++i) {
-      threads_.push_back(std::thread{&ThreadPool::WorkLoop, this});
+      threads_.push_back(std::thread{&ThreadPool::WorkLoop, this, i});
     }
   }
 
@@ -48,10 +65,8 @@ class ThreadPool {
   // threads and waiting for them to wrap up work and join.
   ~ThreadPool() {
     {
-      absl::MutexLock l{&mu_};
-      for (size_t i = 0; i < threads_.size(); ++i) {
-        queue_.push(nullptr);  // Shutdown signal.
-      }
+      absl::MutexLock l{&idle_mu_};
+      shutting_down_ = true;
     }
     for (auto &t : threads_) {
       t.join();
@@ -61,37 +76,161 @@ class ThreadPool {
   // Schedules a function to be run on a ThreadPool thread immediately.
   void Schedule(absl::AnyInvocable<void()> func) {
     CHECK(func != nullptr);
-    absl::MutexLock l{&mu_};
-    queue_.push(std::move(func));
+    const size_t queue_idx =
+        current_pool_ == this
+            ? current_worker_idx_
+            : next_queue_idx_.fetch_add(1, std::memory_order_relaxed) %
+                  queues_.size();
+    {
+      WorkerQueue &queue = queues_[queue_idx];
+      absl::MutexLock l{&queue.mu};
+      queue.tasks.push_back(std::move(func));
+    }
+    // See WaitForWork() for why this doesn't lose wakeups.
+    num_queued_.fetch_add(1);
+    if (num_sleeping_.load() > 0) {
+      // Any unlock of `idle_mu_` makes the sleeping workers re-evaluate their
+      // wakeup condition.
+      absl::MutexLock l{&idle_mu_};
+    }
   }
 
+  // Schedules `func` and returns a future for its result.
+  template <typename F, typename R = std::invoke_result_t<F &>>
+  std::future<R> Submit(F func) {
+    std::packaged_task<R()> task{std::move(func)};
+    std::future<R> result = task.get_future();
+    Schedule([task = std::move(task)]() mutable { task(); });
+    return result;
+  }
+
+  // Calls `body(i)` for every `i` in [`begin`, `end`), in parallel, and
+  // returns when all calls have returned. The range is split into chunks of
+  // `grain_size` indices (picked automatically if 0) that are claimed
+  // dynamically by the worker threads as well as by the calling thread, so
+  // it is safe to call `ParallelFor()` from within a task of the same pool.
+  void ParallelFor(size_t begin, size_t end,
+                   absl::FunctionRef<void(size_t)> body,
+                   size_t grain_size = 0) {
+    if (begin >= end) return;
+    const size_t num_indices = end - begin;
+    if (grain_size == 0) {
+      // Several chunks per thread to even out the load.
+      const size_t num_workers = std::max<size_t>(num_threads(), 1);
+      grain_size = std::max<size_t>(1, num_indices / (num_workers * 4));
+    }
+    const size_t num_chunks = (num_indices + grain_size - 1) / grain_size;
+    // Helper tasks may start after this call returns, so the state they share
+    // with it is ref-counted. Such late helpers find no chunks left and never
+    // touch `body`.
+    struct State {
+      explicit State(size_t num_chunks) : done(num_chunks) {}
+      std::atomic<size_t> next_chunk = 0;
+      absl::BlockingCounter done;
+    };
+    auto state = std::make_shared<State>(num_chunks);
+    auto run_chunks = [state, begin, end, grain_size, num_chunks, body]() {
+      for (size_t chunk = state->next_chunk.fetch_add(1); chunk < num_chunks;
+           chunk = state->next_chunk.fetch_add(1)) {
+        const size_t chunk_begin = begin + chunk * grain_size;
+        const size_t chunk_end = std::min(end, chunk_begin + grain_size);
+        for (size_t i = chunk_begin; i < chunk_end; ++i) body(i);
+        state->done.DecrementCount();
+      }
+    };
+    const size_t num_helpers = std::min(threads_.size(), num_chunks - 1);
+    for (size_t i = 0; i < num_helpers; ++i) Schedule(run_chunks);
+    run_chunks();
+    state->done.Wait();
+  }
+
+  // Returns the number of worker threads.
+  size_t num_threads() const { return threads_.size(); }
+
  private:
+  struct WorkerQueue {
+    absl::Mutex mu;
+    std::deque<absl::AnyInvocable<void()>> tasks ABSL_GUARDED_BY(mu);
+  };
+
+  // Pops a task from the back of the worker's own queue or, if that is empty,
+  // steals one from the front of another queue. Returns false if all the
+  // queues are empty.
+  bool PopOrSteal(size_t worker_idx, absl::AnyInvocable<void()> &task) {
+    {
+      WorkerQueue &queue = queues_[worker_idx];
+      absl::MutexLock l{&queue.mu};
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+      }
+    }
+    for (size_t i = 1; i < queues_.size(); ++i) {
+      WorkerQueue &queue = queues_[(worker_idx + i) % queues_.size()];
+      absl::MutexLock l{&queue.mu};
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
   // Tells the waiting worker threads when new work becomes available in the
-  // queue.
-  bool WorkAvailable() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    return !queue_.empty();
+  // queues or when it's time to exit.
+  bool WorkAvailable() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(idle_mu_) {
+    return num_queued_.load() > 0 || shutting_down_;
+  }
+
+  // Blocks until some task is queued or the pool is shutting down. Returns
+  // false if the worker should exit.
+  bool WaitForWork() {
+    absl::MutexLock l{&idle_mu_};
+    // `Schedule()` increments `num_queued_` before reading `num_sleeping_`,
+    // and we increment `num_sleeping_` before reading `num_queued_` (all
+    // sequentially consistent). So either `Schedule()` sees us sleeping and
+    // wakes us up, or we see its task and don't go to sleep.
+    num_sleeping_.fetch_add(1);
+    idle_mu_.Await(absl::Condition{this, &ThreadPool::WorkAvailable});
+    num_sleeping_.fetch_sub(1);
+    return num_queued_.load() > 0;
   }
 
   // The work loop that every worker thread iterates over, waiting and executing
   // newly scheduled work.
-  void WorkLoop() {
+  void WorkLoop(size_t worker_idx) {
+    current_pool_ = this;
+    current_worker_idx_ = worker_idx;
     while (true) {
-      absl::AnyInvocable<void()> func;
-      {
-        absl::MutexLock l{&mu_};
-        mu_.Await(absl::Condition{this, &ThreadPool::WorkAvailable});
-        func = std::move(queue_.front());
-        queue_.pop();
-      }
-      if (func == nullptr) {  // Shutdown signal.
-        break;
+      absl::AnyInvocable<void()> task;
+      if (PopOrSteal(worker_idx, task)) {
+        num_queued_.fetch_sub(1);
+        task();
+        continue;
       }
-      func();
+      // A task may be between being pushed and being counted, or between
+      // being popped and being uncounted: in both cases `WaitForWork()`
+      // returns right away and we retry.
+      if (!WaitForWork()) break;
     }
   }
 
-  absl::Mutex mu_;
-  std::queue<absl::AnyInvocable<void()>> queue_ ABSL_GUARDED_BY(mu_);
+  // The pool and the index of the worker running on the current thread, if
+  // it is a worker thread.
+  static inline thread_local ThreadPool *current_pool_ = nullptr;
+  static inline thread_local size_t current_worker_idx_ = 0;
+
+  std::vector<WorkerQueue> queues_;
+  // The queue to put the next task scheduled from a non-worker thread to.
+  std::atomic<size_t> next_queue_idx_ = 0;
+  // The number of tasks in all the queues.
+  std::atomic<size_t> num_queued_ = 0;
+  // The number of workers blocked in `WaitForWork()`.
+  std::atomic<size_t> num_sleeping_ = 0;
+  absl::Mutex idle_mu_;
+  bool shutting_down_ ABSL_GUARDED_BY(idle_mu_) = false;
   std::vector<std::thread> threads_;
 };
 
@@ -0,0 +1,202 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the throughput (tasks/sec) of `ThreadPool` (see thread_pool.h)
+// against a single mutex-guarded queue pool (the previous implementation of
+// `ThreadPool`) on many small tasks, e.g.
+//
+//   thread_pool_benchmark --num_threads=16 --num_tasks=1000000
+//
+// Three workloads are measured:
+// * "schedule": all tasks are scheduled from the main thread;
+// * "fan-out": every task scheduled from the main thread schedules
+//   --fan_out more tasks from a worker thread;
+// * "parallel-for": `ThreadPool::ParallelFor()` over --num_tasks indices
+//   (the work-stealing pool only).
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <queue>
+#include <string_view>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/flag.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./centipede/config_init.h"
+#include "./centipede/thread_pool.h"
+
+ABSL_FLAG(int, num_threads, 8, "Number of worker threads.");
+ABSL_FLAG(size_t, num_tasks, 1000000, "Number of tasks per workload.");
+ABSL_FLAG(size_t, fan_out, 100,
+          "Number of tasks scheduled by every task in the fan-out workload.");
+ABSL_FLAG(size_t, work_per_task, 100,
+          "Number of iterations of a dummy computation in every task.");
+
+namespace centipede {
+
+// The previous implementation of `ThreadPool`: a single queue guarded by a
+// single mutex.
+class SingleQueueThreadPool {
+ public:
+  explicit SingleQueueThreadPool(int num_threads) {
+    threads_.reserve(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.push_back(std::thread{&SingleQueueThreadPool::WorkLoop, this});
+    }
+  }
+
+  ~SingleQueueThreadPool() {
+    {
+      absl::MutexLock l{&mu_};
+      for (size_t i = 0; i < threads_.size(); ++i) {
+        queue_.push(nullptr);  // Shutdown signal.
+      }
+    }
+    for (auto &t : threads_) {
+      t.join();
+    }
+  }
+
+  void Schedule(absl::AnyInvocable<void()> func) {
+    CHECK(func != nullptr);
+    absl::MutexLock l{&mu_};
+    queue_.push(std::move(func));
+  }
+
+ private:
+  bool WorkAvailable() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return !queue_.empty();
+  }
+
+  void WorkLoop() {
+    while (true) {
+      absl::AnyInvocable<void()> func;
+      {
+        absl::MutexLock l{&mu_};
+        mu_.Await(
+            absl::Condition{this, &SingleQueueThreadPool::WorkAvailable});
+        func = std::move(queue_.front());
+        queue_.pop();
+      }
+      if (func == nullptr) {  // Shutdown signal.
+        break;
+      }
+      func();
+    }
+  }
+
+  absl::Mutex mu_;
+  std::queue<absl::AnyInvocable<void()>> queue_ ABSL_GUARDED_BY(mu_);
+  std::vector<std::thread> threads_;
+};
+
+// A small amount of work that the compiler can't optimize away.
+void DoWork(std::atomic<uint64_t> &checksum) {
+  uint64_t x = checksum.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < absl::GetFlag(FLAGS_work_per_task); ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  checksum.fetch_add(x & 1, std::memory_order_relaxed);
+}
+
+void LogThroughput(std::string_view pool, std::string_view workload,
+                   size_t num_tasks, absl::Duration duration) {
+  LOG(INFO) << absl::StrFormat(
+      "pool: %12s | workload: %12s | tasks: %9d | %12.0f tasks/sec", pool,
+      workload, num_tasks,
+      num_tasks / std::max(absl::ToDoubleSeconds(duration), 1e-9));
+}
+
+template <typename Pool>
+void RunScheduleBenchmark(std::string_view pool_name) {
+  const size_t num_tasks = absl::GetFlag(FLAGS_num_tasks);
+  std::atomic<uint64_t> checksum = 0;
+  const absl::Time start = absl::Now();
+  {
+    Pool pool{absl::GetFlag(FLAGS_num_threads)};
+    for (size_t i = 0; i < num_tasks; ++i) {
+      pool.Schedule([&checksum] { DoWork(checksum); });
+    }
+  }  // Threads join here.
+  LogThroughput(pool_name, "schedule", num_tasks, absl::Now() - start);
+}
+
+template <typename Pool>
+void RunFanOutBenchmark(std::string_view pool_name) {
+  const size_t fan_out = absl::GetFlag(FLAGS_fan_out);
+  const size_t num_roots =
+      std::max<size_t>(1, absl::GetFlag(FLAGS_num_tasks) / (fan_out + 1));
+  std::atomic<uint64_t> checksum = 0;
+  // The single-queue pool drops the tasks scheduled after its destruction has
+  // started, so wait for all the tasks before destroying the pool.
+  absl::BlockingCounter done(num_roots * (fan_out + 1));
+  const absl::Time start = absl::Now();
+  {
+    Pool pool{absl::GetFlag(FLAGS_num_threads)};
+    for (size_t i = 0; i < num_roots; ++i) {
+      pool.Schedule([&pool, &checksum, &done, fan_out] {
+        for (size_t j = 0; j < fan_out; ++j) {
+          pool.Schedule([&checksum, &done] {
+            DoWork(checksum);
+            done.DecrementCount();
+          });
+        }
+        DoWork(checksum);
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }  // Threads join here.
+  LogThroughput(pool_name, "fan-out", num_roots * (fan_out + 1),
+                absl::Now() - start);
+}
+
+void RunParallelForBenchmark() {
+  const size_t num_tasks = absl::GetFlag(FLAGS_num_tasks);
+  std::atomic<uint64_t> checksum = 0;
+  ThreadPool pool{absl::GetFlag(FLAGS_num_threads)};
+  const absl::Time start = absl::Now();
+  pool.ParallelFor(0, num_tasks, [&checksum](size_t) { DoWork(checksum); });
+  LogThroughput("ThreadPool", "parallel-for", num_tasks, absl::Now() - start);
+}
+
+}  // namespace centipede
+
+int main(int argc, absl::Nonnull<char **> argv) {
+  (void)centipede::config::InitRuntime(argc, argv);
+
+  centipede::RunScheduleBenchmark<centipede::SingleQueueThreadPool>(
+      "single-queue");
+  centipede::RunScheduleBenchmark<centipede::ThreadPool>("ThreadPool");
+  centipede::RunFanOutBenchmark<centipede::SingleQueueThreadPool>(
+      "single-queue");
+  centipede::RunFanOutBenchmark<centipede::ThreadPool>("ThreadPool");
+  centipede::RunParallelForBenchmark();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+// Copyright 2024 The Centipede Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./centipede/thread_pool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+
+namespace centipede {
+namespace {
+
+TEST(ThreadPoolTest, RunsAllScheduledTasksBeforeDestruction) {
+  constexpr size_t kNumTasks = 10000;
+  std::atomic<size_t> num_done = 0;
+  {
+    ThreadPool threads{4};
+    for (size_t i = 0; i < kNumTasks; ++i) {
+      threads.Schedule([&num_done] { ++num_done; });
+    }
+  }  // Threads join here.
+  EXPECT_EQ(num_done, kNumTasks);
+}
+
+TEST(ThreadPoolTest, RunsTasksScheduledByTasks) {
+  std::atomic<size_t> num_done = 0;
+  {
+    ThreadPool threads{3};
+    for (size_t i = 0; i < 100; ++i) {
+      threads.Schedule([&threads, &num_done] {
+        for (size_t j = 0; j < 10; ++j) {
+          threads.Schedule([&num_done] { ++num_done; });
+        }
+      });
+    }
+  }  // Threads join here.
+  EXPECT_EQ(num_done, 1000);
+}
+
+TEST(ThreadPoolTest, IdleWorkersStealFromBlockedWorker) {
+  ThreadPool threads{2};
+  absl::Notification unblock;
+  std::future<void> blocked = threads.Submit([&threads, &unblock] {
+    // Queued in this worker's own deque, behind the blocked task.
+    std::future<int> stolen = threads.Submit([] { return 42; });
+    EXPECT_EQ(stolen.get(), 42);
+    unblock.Notify();
+  });
+  unblock.WaitForNotification();
+  blocked.get();
+}
+
+TEST(ThreadPoolTest, SubmitReturnsResults) {
+  ThreadPool threads{4};
+  std::vector<std::future<size_t>> results;
+  for (size_t i = 0; i < 100; ++i) {
+    results.push_back(threads.Submit([i] { return i * i; }));
+  }
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].get(), i * i);
+  }
+  // Move-only functions are fine too.
+  auto ptr = std::make_unique<int>(7);
+  EXPECT_EQ(threads.Submit([ptr = std::move(ptr)] { return *ptr; }).get(), 7);
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+  ThreadPool threads{4};
+  for (size_t grain_size : {0, 1, 7, 1000}) {
+    std::vector<std::atomic<int>> visits(1003);
+    threads.ParallelFor(
+        3, visits.size(), [&visits](size_t i) { ++visits[i]; }, grain_size);
+    for (size_t i = 0; i < visits.size(); ++i) {
+      EXPECT_EQ(visits[i], i < 3 ? 0 : 1) << i << " " << grain_size;
+    }
+  }
+  // Empty range.
+  threads.ParallelFor(5, 5, [](size_t) { FAIL(); });
+}
+
+TEST(ThreadPoolTest, NestedParallelFor) {
+  ThreadPool threads{2};
+  std::atomic<size_t> sum = 0;
+  threads.ParallelFor(0, 10, [&threads, &sum](size_t) {
+    threads.ParallelFor(0, 100, [&sum](size_t j) { sum += j; });
+  });
+  EXPECT_EQ(sum, 10 * (99 * 100 / 2));
+}
+
+TEST(ThreadPoolTest, ParallelForWithoutWorkers) {
+  ThreadPool threads{0};
+  size_t sum = 0;
+  threads.ParallelFor(0, 100, [&sum](size_t i) { sum += i; });
+  EXPECT_EQ(sum, 99 * 100 / 2);
+}
+
+}  // namespace
+}  // namespace centipede
@@ -33,6 +33,7 @@
 #include <fstream>
 #include <functional>
 #include <ios>
+#include <optional>
 #include <queue>
 #include <random>
 #include <sstream>
@@ -265,6 +266,188 @@ void UnpackBytesFromAppendFile(
   }
 }
 
+// The index footer of a sequence of PackBytesForAppendFile() blobs (a
+// segment):
+//   * kIndexBegMagic
+//   * the offset of the segment in the file (8 bytes)
+//   * the number of blobs in the segment (8 bytes)
+//   * the offset of every blob in the file (8 bytes each)
+//   * the size of the footer (8 bytes)
+//   * kIndexEndMagic
+// The footer is located from its end, so a reader can walk back from the end
+// of the file through the chain of segments appended one after another.
+static const uint8_t kIndexBegMagic[] = "-CentiIndx-";
+static const uint8_t kIndexEndMagic[] = "-xdnIitneC-";
+static_assert(sizeof(kIndexBegMagic) == kMagicLen + 1);
+static_assert(sizeof(kIndexEndMagic) == kMagicLen + 1);
+static const size_t kMinIndexSize = 2 * kMagicLen + 3 * sizeof(uint64_t);
+
+ByteArray PackAppendFileIndex(uint64_t segment_begin,
+                              absl::Span<const uint64_t> blob_offsets) {
+  ByteArray res;
+  auto append_uint64 = [&res](uint64_t value) {
+    uint8_t value_bytes[sizeof(value)];
+    memcpy(value_bytes, &value, sizeof(value));
+    res.insert(res.end(), &value_bytes[0], &value_bytes[sizeof(value)]);
+  };
+  res.insert(res.end(), &kIndexBegMagic[0], &kIndexBegMagic[kMagicLen]);
+  append_uint64(segment_begin);
+  append_uint64(blob_offsets.size());
+  for (uint64_t offset : blob_offsets) append_uint64(offset);
+  append_uint64(kMinIndexSize + blob_offsets.size() * sizeof(uint64_t));
+  res.insert(res.end(), &kIndexEndMagic[0], &kIndexEndMagic[kMagicLen]);
+  return res;
+}
+
+namespace {
+
+uint64_t LoadUint64(const uint8_t *bytes) {
+  uint64_t value = 0;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+// The size of the PackBytesForAppendFile() prefix of a blob.
+constexpr size_t kPackedBlobHeaderSize = kMagicLen + kHashLen + sizeof(size_t);
+
+// Returns the blob packed by PackBytesForAppendFile() at `offset` of
+// `packed_data`, or std::nullopt if there is no well-formed packed blob there.
+// Doesn't check the hash.
+std::optional<ByteSpan> GetPackedBlobAt(ByteSpan packed_data, size_t offset) {
+  if (offset > packed_data.size() ||
+      packed_data.size() - offset < kPackedBlobHeaderSize + kMagicLen) {
+    return std::nullopt;
+  }
+  const uint8_t *packed_blob = packed_data.data() + offset;
+  if (memcmp(packed_blob, kPackBegMagic, kMagicLen) != 0) return std::nullopt;
+  const uint64_t size = LoadUint64(packed_blob + kMagicLen + kHashLen);
+  if (size > packed_data.size() - offset - kPackedBlobHeaderSize - kMagicLen)
+    return std::nullopt;
+  if (memcmp(packed_blob + kPackedBlobHeaderSize + size, kPackEndMagic,
+             kMagicLen) != 0) {
+    return std::nullopt;
+  }
+  return packed_data.subspan(offset + kPackedBlobHeaderSize, size);
+}
+
+// Same as UnpackBytesFromAppendFile(), but for the spans of the blobs in
+// `packed_data`.
+void ScanPackedBlobs(ByteSpan packed_data, std::vector<ByteSpan> &unpacked) {
+  auto pos = packed_data.begin();
+  while (true) {
+    pos = std::search(pos, packed_data.end(), &kPackBegMagic[0],
+                      &kPackBegMagic[kMagicLen]);
+    if (pos == packed_data.end()) return;
+    const uint8_t *hash = &*pos + kMagicLen;
+    pos += kMagicLen;
+    if (packed_data.end() - pos < kHashLen) return;
+    pos += kHashLen;
+    size_t size = 0;
+    if (packed_data.end() - pos < sizeof(size)) return;
+    memcpy(&size, &*pos, sizeof(size));
+    pos += sizeof(size);
+    if (packed_data.end() - pos < size) return;
+    const ByteSpan blob{&*pos, size};
+    pos += size;
+    if (packed_data.end() - pos < kMagicLen) return;
+    if (memcmp(&*pos, kPackEndMagic, kMagicLen) != 0) continue;
+    pos += kMagicLen;
+    if (Hash(blob) != std::string_view(reinterpret_cast<const char *>(hash),
+                                       kHashLen)) {
+      continue;
+    }
+    unpacked.push_back(blob);
+  }
+}
+
+// If `packed_data` ends with a valid index footer, appends the blobs of its
+// segment to `unpacked` and returns the offset of the first byte of the
+// segment that is not a part of the blobs or the footer: the data before it
+// may contain more blobs. Otherwise, returns std::nullopt.
+std::optional<size_t> UnpackIndexedSegment(ByteSpan packed_data,
+                                           std::vector<ByteSpan> &unpacked) {
+  const size_t end = packed_data.size();
+  if (end < kMinIndexSize) return std::nullopt;
+  const uint8_t *data = packed_data.data();
+  if (memcmp(data + end - kMagicLen, kIndexEndMagic, kMagicLen) != 0)
+    return std::nullopt;
+  const uint64_t index_size = LoadUint64(data + end - kMagicLen - 8);
+  if (index_size < kMinIndexSize || index_size > end) return std::nullopt;
+  const size_t index_begin = end - index_size;
+  if (memcmp(data + index_begin, kIndexBegMagic, kMagicLen) != 0)
+    return std::nullopt;
+  const uint8_t *fields = data + index_begin + kMagicLen;
+  const uint64_t segment_begin = LoadUint64(fields);
+  const uint64_t num_blobs = LoadUint64(fields + 8);
+  if (num_blobs != (index_size - kMinIndexSize) / 8 ||
+      index_size != kMinIndexSize + num_blobs * 8 ||
+      segment_begin > index_begin) {
+    return std::nullopt;
+  }
+  const ByteSpan segment_data = packed_data.subspan(0, index_begin);
+  const size_t initial_num_unpacked = unpacked.size();
+  uint64_t prev_blob_end = segment_begin;
+  for (uint64_t i = 0; i < num_blobs; ++i) {
+    const uint64_t offset = LoadUint64(fields + 16 + i * 8);
+    const std::optional<ByteSpan> blob =
+        offset >= prev_blob_end ? GetPackedBlobAt(segment_data, offset)
+                                : std::nullopt;
+    if (!blob.has_value()) {
+      unpacked.resize(initial_num_unpacked);
+      return std::nullopt;
+    }
+    unpacked.push_back(*blob);
+    prev_blob_end = offset + kPackedBlobHeaderSize + blob->size() + kMagicLen;
+  }
+  // Don't trust `segment_begin` to skip any data: it only affects how much
+  // data is left to be scanned.
+  return num_blobs == 0 ? index_begin : LoadUint64(fields + 16);
+}
+
+}  // namespace
+
+void UnpackSpansFromAppendFile(ByteSpan packed_data,
+                               std::vector<ByteSpan> &unpacked) {
+  // Walk back from the end of `packed_data`: find the last valid footer, scan
+  // the blobs appended after it, take the blobs of its segment from the
+  // footer and continue from the first blob of the segment. The pieces are
+  // collected in the reverse order.
+  std::vector<std::vector<ByteSpan>> pieces;
+  size_t end = packed_data.size();
+  while (end > 0) {
+    std::vector<ByteSpan> segment_blobs;
+    std::optional<size_t> segment_begin;
+    size_t index_end = end;
+    while (true) {
+      // Usually, the footer of the previous segment ends right where the
+      // current segment begins.
+      segment_begin = UnpackIndexedSegment(packed_data.subspan(0, index_end),
+                                           segment_blobs);
+      if (segment_begin.has_value() || index_end <= kMagicLen) break;
+      // Try the previous occurrence of kIndexEndMagic.
+      const auto prev_end_magic = std::find_end(
+          packed_data.begin(), packed_data.begin() + index_end - 1,
+          &kIndexEndMagic[0], &kIndexEndMagic[kMagicLen]);
+      if (prev_end_magic == packed_data.begin() + index_end - 1) break;
+      index_end = prev_end_magic - packed_data.begin() + kMagicLen;
+    }
+    if (!segment_begin.has_value()) {
+      // No more footers: scan everything before `end`.
+      pieces.emplace_back();
+      ScanPackedBlobs(packed_data.subspan(0, end), pieces.back());
+      break;
+    }
+    pieces.emplace_back();
+    ScanPackedBlobs(packed_data.subspan(index_end, end - index_end),
+                    pieces.back());
+    pieces.push_back(std::move(segment_blobs));
+    end = *segment_begin;
+  }
+  for (auto piece = pieces.rbegin(); piece != pieces.rend(); ++piece) {
+    unpacked.insert(unpacked.end(), piece->begin(), piece->end());
+  }
+}
+
 void AppendHashToArray(ByteArray &ba, std::string_view hash) {
   CHECK_EQ(hash.size(), kHashLen);
   ba.insert(ba.end(), hash.begin(), hash.end());
@@ -153,6 +153,21 @@ void UnpackBytesFromAppendFile(
     const ByteArray &packed_data,
     absl::Nullable<std::vector<ByteArray> *> unpacked,
     absl::Nullable<std::vector<std::string> *> hashes = nullptr);
+// Returns the index footer to be appended after a sequence of
+// PackBytesForAppendFile() blobs that starts at the byte offset
+// `segment_begin` of a file and has its blobs at the byte offsets
+// `blob_offsets` of the file. Readers use the footers to find the blobs
+// without scanning for them (see UnpackSpansFromAppendFile()); files without
+// footers, or with more blobs appended after a footer, remain readable.
+ByteArray PackAppendFileIndex(uint64_t segment_begin,
+                              absl::Span<const uint64_t> blob_offsets);
+// Same as UnpackBytesFromAppendFile(), but appends the spans of the unpacked
+// blobs within `packed_data` to `unpacked`, without copying. The blobs covered
+// by the index footers written by PackAppendFileIndex() are located through
+// the footers and are not hash-checked; the rest of `packed_data` is scanned
+// as by UnpackBytesFromAppendFile().
+void UnpackSpansFromAppendFile(ByteSpan packed_data,
+                               std::vector<ByteSpan> &unpacked);
 // Append the bytes from 'hash' to 'ba'.
 void AppendHashToArray(ByteArray &ba, std::string_view hash);
 // Reverse to AppendHashToArray.
@@ -208,6 +223,9 @@ class MmapNoReserveArray {
     CHECK_LT(i, kSize);
     return array_[i];
   }
+  // Returns the raw array, e.g. for batched or vectorized reads. The callers
+  // are responsible for staying within [0, kSize).
+  const uint8_t *data() const { return array_; }
 
  private:
   uint8_t *array_;
@@ -50,6 +50,46 @@ TEST(UtilTest, AppendFile) {
   EXPECT_EQ(c, unpacked[2]);
 }
 
+TEST(UtilTest, AppendFileWithIndex) {
+  const ByteArray a{1, 2, 3};
+  const ByteArray b{3, 4, 5};
+  const ByteArray c{111, 112, 113, 114, 115};
+  const ByteArray d{};
+  ByteArray packed;
+  // A segment without an index.
+  Append(packed, PackBytesForAppendFile(a));
+  // An indexed segment, preceded by a partially written blob.
+  ByteArray partial = PackBytesForAppendFile(c);
+  partial.resize(partial.size() / 2);
+  Append(packed, partial);
+  const uint64_t segment_begin = packed.size();
+  const uint64_t b_offset = packed.size();
+  Append(packed, PackBytesForAppendFile(b));
+  const uint64_t c_offset = packed.size();
+  Append(packed, PackBytesForAppendFile(c));
+  Append(packed, PackAppendFileIndex(segment_begin, {b_offset, c_offset}));
+  // A segment appended after the index.
+  Append(packed, PackBytesForAppendFile(d));
+
+  const std::vector<ByteArray> expected = {a, b, c, d};
+  auto unpack_spans = [&packed]() {
+    std::vector<ByteSpan> spans;
+    UnpackSpansFromAppendFile(packed, spans);
+    std::vector<ByteArray> res;
+    for (ByteSpan span : spans) res.emplace_back(span.begin(), span.end());
+    return res;
+  };
+  EXPECT_EQ(unpack_spans(), expected);
+  // The index is invisible to the readers unaware of it.
+  std::vector<ByteArray> unpacked;
+  UnpackBytesFromAppendFile(packed, &unpacked);
+  EXPECT_EQ(unpacked, expected);
+
+  // An index pointing at something other than blobs is ignored.
+  Append(packed, PackAppendFileIndex(0, {1}));
+  EXPECT_EQ(unpack_spans(), expected);
+}
+
 TEST(UtilTest, Hash) {
   // The current implementation of Hash() is sha1.
   // Here we test a couple of inputs against their known sha1 values
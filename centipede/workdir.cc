@@ -144,6 +144,10 @@ std::string WorkDir::BinaryInfoDirPath() const {
   return std::filesystem::path(CoverageDirPath()) / "binary-info";
 }
 
+std::string WorkDir::SymbolTableCachePath() const {
+  return std::filesystem::path(CoverageDirPath()) / "symbol-table-cache";
+}
+
 std::string WorkDir::DebugInfoDirPath() const {
   return std::filesystem::path(workdir_) / "debug";
 }
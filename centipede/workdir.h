@@ -108,6 +108,10 @@ class WorkDir {
   std::string CrashReproducerDirPath() const;
   // Returns the path where the BinaryInfo will be serialized within workdir.
   std::string BinaryInfoDirPath() const;
+  // Returns the path where the symbol table of the binary is cached, to be
+  // shared by all the shards fuzzing the same binary. Like the rest of the
+  // coverage dir, the path is keyed by the binary hash.
+  std::string SymbolTableCachePath() const;
 
   // Returns the path info for the corpus files.
   ShardedFileInfo CorpusFiles() const;
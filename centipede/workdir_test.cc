@@ -58,6 +58,7 @@ TEST(WorkDirTest, Api) {
   EXPECT_EQ(wd.CoverageDirPath(), "/dir/bin-hash");
   EXPECT_EQ(wd.CrashReproducerDirPath(), "/dir/crashes");
   EXPECT_EQ(wd.BinaryInfoDirPath(), "/dir/bin-hash/binary-info");
+  EXPECT_EQ(wd.SymbolTableCachePath(), "/dir/bin-hash/symbol-table-cache");
 
   EXPECT_EQ(wd.CorpusFiles().MyShardPath(), "/dir/corpus.000003");
   EXPECT_EQ(wd.CorpusFiles().ShardPath(7), "/dir/corpus.000007");
@@ -89,6 +89,33 @@ TEST(StructOf, MutateGeneratesValidValues) {
   }
 }
 
+TEST(StructOf, CrossOverTakesOrCrossesOverFieldsOfOtherValue) {
+  auto domain =
+      StructOf<MyStruct>(ElementOf({5, 10}), Arbitrary<std::string>());
+  absl::BitGen bitgen;
+  const Value val(domain, MyStruct{5, "abc"});
+  const Value other(domain, MyStruct{10, "xyz"});
+  bool took_a = false;
+  bool took_s = false;
+  bool crossed_s = false;
+  for (int i = 0; i < 1000; ++i) {
+    auto corpus_value = val.corpus_value;
+    domain.CrossOver(corpus_value, other.corpus_value, bitgen);
+    const MyStruct crossed = domain.GetValue(corpus_value);
+    if (crossed.a == 10) {
+      // Only one field is crossed over at a time.
+      EXPECT_EQ(crossed.s, "abc");
+      took_a = true;
+    } else if (crossed.s == "xyz") {
+      took_s = true;
+    } else if (crossed.s != "abc") {
+      EXPECT_THAT(crossed.s, testing::ContainsRegex("[xyz]"));
+      crossed_s = true;
+    }
+  }
+  EXPECT_TRUE(took_a && took_s && crossed_s);
+}
+
 TEST(StructOf, WorksWithStructWithUpTo16Fields) {
   struct Agg16 {
     uint32_t a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p;
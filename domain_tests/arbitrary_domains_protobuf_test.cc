@@ -17,6 +17,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -445,6 +446,62 @@ TEST(ProtocolBuffer, SerializeAndParseCanHandleExtensions) {
             user_value_after_serialize_parse.GetExtension(ProtoExtender::ext));
 }
 
+TEST(ProtocolBuffer, ConstMethodsCanCreateSubdomainsConcurrently) {
+  absl::BitGen bitgen;
+  auto source_domain = Arbitrary<TestProtobuf>();
+  auto source_value = source_domain.Init(bitgen);
+  for (int i = 0; i < 100; ++i) {
+    source_domain.Mutate(source_value, bitgen, /*only_shrink=*/false);
+  }
+  const TestProtobuf expected = source_domain.GetValue(source_value);
+  const internal::IRObject obj = source_domain.SerializeCorpus(source_value);
+
+  // The field domains of `domain` are created by the threads racing to parse
+  // and get the values of the fields for the first time.
+  const auto domain = Arbitrary<TestProtobuf>();
+  constexpr int kNumThreads = 8;
+  std::vector<int> num_equal(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&domain, &obj, &expected, &num_equal, i] {
+      for (int j = 0; j < 100; ++j) {
+        auto parsed = domain.ParseCorpus(obj);
+        if (!parsed.has_value()) return;
+        num_equal[i] += Eq{}(domain.GetValue(*parsed), expected);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_THAT(num_equal, Each(100));
+}
+
+TEST(ProtocolBuffer, CrossOverTakesFieldsAndSubmessagesOfOtherMessage) {
+  absl::BitGen bitgen;
+  auto domain = Arbitrary<TestProtobuf>();
+  TestProtobuf message;
+  message.set_i32(1);
+  message.set_oneof_i32(1);
+  TestProtobuf other_message;
+  other_message.set_str("other");
+  other_message.mutable_subproto()->set_subproto_i32(2);
+  other_message.set_oneof_i64(2);
+  const Value val(domain, message);
+  const Value other(domain, other_message);
+  bool took_str = false;
+  bool took_subproto = false;
+  bool took_oneof = false;
+  for (int i = 0; i < 1000; ++i) {
+    auto corpus_value = val.corpus_value;
+    domain.CrossOver(corpus_value, other.corpus_value, bitgen);
+    ASSERT_OK(domain.ValidateCorpusValue(corpus_value));
+    const TestProtobuf crossed = domain.GetValue(corpus_value);
+    took_str |= crossed.str() == "other";
+    took_subproto |= crossed.subproto().subproto_i32() == 2;
+    took_oneof |= crossed.oneof_i64() == 2;
+  }
+  EXPECT_TRUE(took_str && took_subproto && took_oneof);
+}
+
 TEST(ProtocolBuffer, ValidationRejectsUnexpectedSingularField) {
   absl::BitGen bitgen;
 
@@ -238,6 +238,48 @@ TEST(Container, ValidationRejectsInvalidElements) {
           R"(Invalid value in container at index 0 >> The value .+ is not InRange\(10, 12\))")));
 }
 
+TEST(Container, CrossOverSplicesElementsOfOtherValue) {
+  auto domain = VectorOf(Arbitrary<int>()).WithMaxSize(6);
+  absl::BitGen bitgen;
+  const std::vector<int> other = {4, 5, 6};
+  absl::flat_hash_set<std::vector<int>> crossed;
+  for (int i = 0; i < 10000; ++i) {
+    std::vector<int> val = {0, 1, 2, 3};
+    domain.CrossOver(val, other, bitgen);
+    ASSERT_THAT(val.size(), testing::Le(6));
+    crossed.insert(val);
+  }
+
+  EXPECT_THAT(crossed, testing::IsSupersetOf(std::vector<std::vector<int>>{
+                           // Inserted ranges of `other`.
+                           {4, 5, 0, 1, 2, 3},
+                           {0, 1, 6, 2, 3},
+                           {0, 1, 2, 3, 5, 6},
+                           // Overwritten ranges of `val`.
+                           {4, 5, 2, 3},
+                           {0, 6, 2, 3},
+                           {0, 1, 5, 6},
+                       }));
+}
+
+TEST(Container, CrossOverInsertsNewElementsOfOtherSet) {
+  auto domain = SetOf(Arbitrary<int>()).WithMaxSize(4);
+  absl::BitGen bitgen;
+  const Value val(domain, std::set<int>{1, 2, 3});
+  const Value other(domain, std::set<int>{3, 4, 5});
+  Set<std::set<int>> crossed;
+  for (int i = 0; i < 1000; ++i) {
+    auto corpus_value = val.corpus_value;
+    domain.CrossOver(corpus_value, other.corpus_value, bitgen);
+    ASSERT_OK(domain.ValidateCorpusValue(corpus_value));
+    crossed.insert(domain.GetValue(corpus_value));
+  }
+
+  EXPECT_THAT(crossed, UnorderedElementsAre(std::set<int>{1, 2, 3},
+                                            std::set<int>{1, 2, 3, 4},
+                                            std::set<int>{1, 2, 3, 5}));
+}
+
 // This should apply to all container types with memory dictionary mutation
 // enabled, but we test on strings for simplification.
 TEST(Container, MemoryDictionaryMutationMutatesEveryPossibleMatch) {
@@ -35,6 +35,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "./fuzztest/internal/domains/domain_type_erasure.h"
 #include "./fuzztest/internal/logging.h"
 #include "./fuzztest/internal/meta.h"
 #include "./fuzztest/internal/serialization.h"
@@ -241,6 +242,21 @@ void VerifyRoundTripThroughConversion(const Value<Domain>& v,
     ASSERT_OK(domain.ValidateCorpusValue(*parsed_corpus));
     EXPECT_TRUE(Eq{}(v.user_value, domain.GetValue(*parsed_corpus)));
   }
+  {
+    // Serializing and parsing without the intermediate `IRObject` must be
+    // equivalent to going through it.
+    std::string serialized;
+    internal::IRObjectWriter writer(serialized);
+    internal::SerializeCorpusToWriter(domain, v.corpus_value, writer);
+    EXPECT_EQ(serialized, domain.SerializeCorpus(v.corpus_value).ToString());
+    auto view = internal::IRObjectView::FromString(serialized);
+    ASSERT_TRUE(view);
+    auto parsed_corpus = internal::ParseCorpusFromView(domain, *view);
+    ASSERT_TRUE(parsed_corpus)
+        << serialized << " value = " << testing::PrintToString(v.user_value);
+    ASSERT_OK(domain.ValidateCorpusValue(*parsed_corpus));
+    EXPECT_TRUE(Eq{}(v.user_value, domain.GetValue(*parsed_corpus)));
+  }
 }
 
 template <typename Container, typename Domain>
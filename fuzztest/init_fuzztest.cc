@@ -105,6 +105,14 @@ FUZZTEST_DEFINE_FLAG(
     "a given test. This is useful for measuring the coverage of the corpus "
     "built up during previously ran fuzzing sessions.");
 
+FUZZTEST_DEFINE_FLAG(
+    size_t, replay_jobs, 0,
+    "The number of subprocesses that replay the regression and coverage "
+    "inputs in the database for a given test in parallel. Each input is "
+    "reported as passed or failed, and a failing input is then replayed in "
+    "the test process to fail the test. With 0 or 1, the inputs are replayed "
+    "in the test process one by one.");
+
 FUZZTEST_DEFINE_FLAG(
     size_t, stack_limit_kb, 128,
     "The soft limit of the stack size in kibibytes to abort when "
@@ -182,6 +190,7 @@ internal::Configuration CreateConfigurationsFromFlags(
       /*fuzz_tests=*/ListRegisteredTests(),
       reproduce_findings_as_separate_tests,
       absl::GetFlag(FUZZTEST_FLAG(replay_coverage_inputs)),
+      absl::GetFlag(FUZZTEST_FLAG(replay_jobs)),
       /*stack_limit=*/absl::GetFlag(FUZZTEST_FLAG(stack_limit_kb)) * 1024,
       /*rss_limit=*/absl::GetFlag(FUZZTEST_FLAG(rss_limit_mb)) * 1024 * 1024,
       absl::GetFlag(FUZZTEST_FLAG(time_limit_per_input)),
@@ -66,6 +66,7 @@
 #include "./fuzztest/internal/domains/domain.h"
 #include "./fuzztest/internal/fixture_driver.h"
 #include "./fuzztest/internal/logging.h"
+#include "./fuzztest/internal/parsed_input_cache.h"
 #include "./fuzztest/internal/runtime.h"
 
 namespace fuzztest::internal {
@@ -170,9 +171,21 @@ class CentipedeAdaptorRunnerCallbacks : public centipede::RunnerCallbacks {
   }
 
   bool Execute(centipede::ByteSpan input) override {
-    if (auto parsed_input =
-            fuzzer_impl_.TryParse({(char*)input.data(), input.size()})) {
-      fuzzer_impl_.RunOneInput({*std::move(parsed_input)});
+    const absl::string_view serialized_input{(const char*)input.data(),
+                                             input.size()};
+    if (auto* cached_input = parsed_input_cache_.Find(serialized_input)) {
+      // Move the value out of the cache and back instead of copying it.
+      FuzzTestFuzzerImpl::Input parsed_input{std::move(*cached_input)};
+      fuzzer_impl_.RunOneInput(parsed_input);
+      *cached_input = std::move(parsed_input.args);
+      return true;
+    }
+    if (auto parsed_args = fuzzer_impl_.TryParse(serialized_input)) {
+      FuzzTestFuzzerImpl::Input parsed_input{*std::move(parsed_args)};
+      fuzzer_impl_.RunOneInput(parsed_input);
+      // The input may be mutated later if it gets into the corpus.
+      parsed_input_cache_.Insert(std::string(serialized_input),
+                                 std::move(parsed_input.args));
       return true;
     }
     return false;
@@ -186,9 +199,10 @@ class CentipedeAdaptorRunnerCallbacks : public centipede::RunnerCallbacks {
     for (const std::string& corpus_file :
          corpus_database.GetCoverageInputsIfAny(
              fuzzer_impl_.test_.full_name())) {
-      auto corpus_value = fuzzer_impl_.GetCorpusValueFromFile(corpus_file);
-      if (!corpus_value) continue;
-      seeds.push_back(*corpus_value);
+      for (auto& corpus_value :
+           fuzzer_impl_.GetCorpusValuesFromFile(corpus_file)) {
+        seeds.push_back(std::move(corpus_value));
+      }
     }
     constexpr int kInitialValuesInSeeds = 32;
     for (int i = 0; i < kInitialValuesInSeeds; ++i) {
@@ -196,8 +210,7 @@ class CentipedeAdaptorRunnerCallbacks : public centipede::RunnerCallbacks {
     }
     absl::c_shuffle(seeds, prng_);
     for (const auto& seed : seeds) {
-      const auto seed_serialized =
-          fuzzer_impl_.params_domain_.SerializeCorpus(seed).ToString();
+      const auto seed_serialized = fuzzer_impl_.SerializeArgs(seed);
       seed_callback(centipede::AsByteSpan(seed_serialized));
     }
   }
@@ -214,31 +227,40 @@ class CentipedeAdaptorRunnerCallbacks : public centipede::RunnerCallbacks {
     SetMetadata(inputs[0].metadata);
     for (size_t i = 0; i < num_mutants; ++i) {
       const auto choice = absl::Uniform<double>(prng_, 0, 1);
-      std::string mutant_data;
+      FuzzTestFuzzerImpl::Input mutant;
       constexpr double kDomainInitRatio = 0.0001;
       if (choice < kDomainInitRatio) {
-        mutant_data =
-            fuzzer_impl_.params_domain_
-                .SerializeCorpus(fuzzer_impl_.params_domain_.Init(prng_))
-                .ToString();
+        mutant.args = fuzzer_impl_.params_domain_.Init(prng_);
       } else {
-        const auto& origin =
-            inputs[absl::Uniform<size_t>(prng_, 0, inputs.size())].data;
-        auto parsed_origin =
-            fuzzer_impl_.TryParse({(const char*)origin.data(), origin.size()});
-        if (!parsed_origin)
-          parsed_origin = fuzzer_impl_.params_domain_.Init(prng_);
-        auto mutant = FuzzTestFuzzerImpl::Input{*parsed_origin};
-        fuzzer_impl_.MutateValue(mutant, prng_);
-        mutant_data =
-            fuzzer_impl_.params_domain_.SerializeCorpus(mutant.args).ToString();
+        if (auto origin = ParseInput(PickInput(inputs))) {
+          mutant.args = *std::move(origin);
+        } else {
+          mutant.args = fuzzer_impl_.params_domain_.Init(prng_);
+        }
+        std::optional<GenericDomainCorpusType> other;
+        if (absl::Uniform<uint64_t>(prng_, 0, 100) < GetCrossOverLevel()) {
+          // Cross over with some other input. It may be the same input.
+          other = ParseInput(PickInput(inputs));
+        }
+        if (other.has_value()) {
+          fuzzer_impl_.params_domain_.CrossOver(mutant.args, *other, prng_);
+        } else {
+          fuzzer_impl_.MutateValue(mutant, prng_);
+        }
       }
+      // The mutant isn't cached: it may not be what its serialization parses
+      // to, or may not even be valid, so it is executed as parsed.
+      std::string mutant_data = fuzzer_impl_.SerializeArgs(mutant.args);
       new_mutant_callback(
           {(unsigned char*)mutant_data.data(), mutant_data.size()});
     }
     return true;
   }
 
+  const ParsedInputCache<GenericDomainCorpusType>& parsed_input_cache() const {
+    return parsed_input_cache_;
+  }
+
   ~CentipedeAdaptorRunnerCallbacks() override {
     runtime_.UnsetCurrentArgs();
     if (GetExecutionCoverage() == execution_coverage_.get())
@@ -259,6 +281,28 @@ class CentipedeAdaptorRunnerCallbacks : public centipede::RunnerCallbacks {
         .Insert(a_int, b_int);
   }
 
+  const centipede::ByteArray& PickInput(
+      const std::vector<centipede::MutationInputRef>& inputs) {
+    return inputs[absl::Uniform<size_t>(prng_, 0, inputs.size())].data;
+  }
+
+  // Returns the parsed args of the serialized `input`, looking them up in
+  // `parsed_input_cache_` first, or nullopt if `input` cannot be parsed.
+  std::optional<GenericDomainCorpusType> ParseInput(
+      const centipede::ByteArray& input) {
+    const absl::string_view serialized{(const char*)input.data(),
+                                       input.size()};
+    if (const auto* cached = parsed_input_cache_.Find(serialized)) {
+      return *cached;
+    }
+    std::optional<GenericDomainCorpusType> parsed =
+        fuzzer_impl_.TryParse(serialized);
+    if (parsed.has_value()) {
+      parsed_input_cache_.Insert(std::string(serialized), *parsed);
+    }
+    return parsed;
+  }
+
   void SetMetadata(const centipede::ExecutionMetadata* metadata) {
     if (metadata == nullptr) return;
     metadata->ForEachCmpEntry([](centipede::ByteSpan a, centipede::ByteSpan b) {
@@ -284,12 +328,20 @@ class CentipedeAdaptorRunnerCallbacks : public centipede::RunnerCallbacks {
   // Size limits on the cmp entries to be used in mutation.
   static constexpr uint8_t kMaxCmpEntrySize = 15;
   static constexpr uint8_t kMinCmpEntrySize = 2;
+  // The number of recently parsed inputs whose values are kept.
+  static constexpr size_t kParsedInputCacheCapacity = 4096;
 
   Runtime& runtime_;
   FuzzTestFuzzerImpl& fuzzer_impl_;
   const Configuration& configuration_;
   std::unique_ptr<ExecutionCoverage> execution_coverage_;
   absl::BitGen prng_;
+  // Holds only values returned by `fuzzer_impl_.TryParse()`, i.e., what the
+  // exact serialized bytes parse to in `fuzzer_impl_.params_domain_`, which
+  // passed validation. Since the domain is fixed for the lifetime of these
+  // callbacks, the bytes alone identify a value.
+  ParsedInputCache<GenericDomainCorpusType> parsed_input_cache_{
+      kParsedInputCacheCapacity};
 };
 
 namespace {
@@ -309,6 +361,14 @@ class CentipedeAdaptorEngineCallbacks : public centipede::CentipedeCallbacks {
   ~CentipedeAdaptorEngineCallbacks() {
     if (batch_result_buffer_ != nullptr)
       munmap(batch_result_buffer_, batch_result_buffer_size_);
+    const auto& cache = runner_callbacks_.parsed_input_cache();
+    if (cache.lookups() > 0) {
+      absl::FPrintF(GetStderr(),
+                    "[.] Parsed input cache: %d hits out of %d lookups "
+                    "(%.1f%%)\n",
+                    cache.hits(), cache.lookups(),
+                    100.0 * cache.hits() / cache.lookups());
+    }
   }
 
   bool Execute(std::string_view binary,
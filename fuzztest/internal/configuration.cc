@@ -170,8 +170,9 @@ std::string Configuration::Serialize() const {
   out.resize(SpaceFor(corpus_database) + SpaceFor(binary_identifier) +
              SpaceFor(fuzz_tests) +
              SpaceFor(reproduce_findings_as_separate_tests) +
-             SpaceFor(replay_coverage_inputs) + SpaceFor(stack_limit) +
-             SpaceFor(rss_limit) + SpaceFor(time_limit_per_input_str) +
+             SpaceFor(replay_coverage_inputs) + SpaceFor(replay_jobs) +
+             SpaceFor(stack_limit) + SpaceFor(rss_limit) +
+             SpaceFor(time_limit_per_input_str) +
              SpaceFor(time_limit_per_test_str) +
              SpaceFor(crashing_input_to_reproduce) +
              SpaceFor(reproduction_command_template));
@@ -181,6 +182,7 @@ std::string Configuration::Serialize() const {
   offset = WriteVectorOfStrings(out, offset, fuzz_tests);
   offset = WriteIntegral(out, offset, reproduce_findings_as_separate_tests);
   offset = WriteIntegral(out, offset, replay_coverage_inputs);
+  offset = WriteIntegral(out, offset, replay_jobs);
   offset = WriteIntegral(out, offset, stack_limit);
   offset = WriteIntegral(out, offset, rss_limit);
   offset = WriteString(out, offset, time_limit_per_input_str);
@@ -200,6 +202,7 @@ absl::StatusOr<Configuration> Configuration::Deserialize(
     ASSIGN_OR_RETURN(reproduce_findings_as_separate_tests,
                      Consume<bool>(serialized));
     ASSIGN_OR_RETURN(replay_coverage_inputs, Consume<bool>(serialized));
+    ASSIGN_OR_RETURN(replay_jobs, Consume<size_t>(serialized));
     ASSIGN_OR_RETURN(stack_limit, Consume<size_t>(serialized));
     ASSIGN_OR_RETURN(rss_limit, Consume<size_t>(serialized));
     ASSIGN_OR_RETURN(time_limit_per_input_str, ConsumeString(serialized));
@@ -221,6 +224,7 @@ absl::StatusOr<Configuration> Configuration::Deserialize(
                          *std::move(fuzz_tests),
                          *reproduce_findings_as_separate_tests,
                          *replay_coverage_inputs,
+                         *replay_jobs,
                          *stack_limit,
                          *rss_limit,
                          *time_limit_per_input,
@@ -43,6 +43,10 @@ struct Configuration {
   bool reproduce_findings_as_separate_tests = false;
   // Replay coverage inputs for the selected fuzz tests.
   bool replay_coverage_inputs = false;
+  // The number of subprocesses replaying the regression and coverage inputs of
+  // a fuzz test in parallel. With 0 or 1, the inputs are replayed in the test
+  // process.
+  size_t replay_jobs = 0;
 
   // Stack limit in bytes.
   size_t stack_limit = 128 * 1024;
@@ -19,6 +19,7 @@ MATCHER_P(IsOkAndEquals, config, "") {
          config.reproduce_findings_as_separate_tests ==
              other->reproduce_findings_as_separate_tests &&
          config.replay_coverage_inputs == other->replay_coverage_inputs &&
+         config.replay_jobs == other->replay_jobs &&
          config.stack_limit == other->stack_limit &&
          config.rss_limit == other->rss_limit &&
          config.time_limit_per_input == other->time_limit_per_input &&
@@ -36,6 +37,7 @@ TEST(ConfigurationTest,
                               /*fuzz_tests=*/{},
                               /*reproduce_findings_as_separate_tests=*/true,
                               /*replay_coverage_inputs=*/false,
+                              /*replay_jobs=*/8,
                               /*stack_limit=*/100,
                               /*rss_limit=*/200,
                               /*time_limit_per_input=*/absl::Seconds(42),
@@ -54,6 +56,7 @@ TEST(ConfigurationTest,
                               {"FuzzTest1", "FuzzTest2"},
                               /*reproduce_findings_as_separate_tests=*/true,
                               /*replay_coverage_inputs=*/false,
+                              /*replay_jobs=*/8,
                               /*stack_limit=*/100,
                               /*rss_limit=*/200,
                               /*time_limit_per_input=*/absl::Seconds(42),
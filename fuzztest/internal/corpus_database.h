@@ -25,6 +25,10 @@ namespace fuzztest::internal {
 
 // Encapsulates a file-system-based corpus database that contains the coverage,
 // regression, and crashing inputs for each fuzz test in a test binary.
+//
+// The input getters return file paths. Each file contains either a single
+// serialized input or many inputs in a packed corpus file (see io.h), which
+// avoids a file per input in large databases.
 class CorpusDatabase {
  public:
   // Constructs a corpus database for `binary_identifier` located at
@@ -0,0 +1,120 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./fuzztest/internal/corpus_sampler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/numeric/bits.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/distributions.h"
+#include "absl/time/time.h"
+#include "./fuzztest/internal/logging.h"
+
+namespace fuzztest::internal {
+namespace {
+
+// The bucket boundaries of `GetWeight()`, as fractions of the average run
+// time.
+struct Fraction {
+  int64_t numerator;
+  int64_t denominator;
+};
+constexpr Fraction kBucketBoundaries[] = {{1, 4}, {1, 3}, {1, 2}, {4, 3},
+                                          {2, 1}, {4, 1}, {10, 1}};
+
+size_t LowestBit(size_t i) { return i & (~i + 1); }
+
+}  // namespace
+
+uint64_t CorpusSampler::GetWeight(absl::Duration run_time,
+                                  absl::Duration average_time) {
+  if (run_time > average_time * 10) return 10;
+  if (run_time > average_time * 4) return 25;
+  if (run_time > average_time * 2) return 50;
+  if (run_time * 3 > average_time * 4) return 75;
+  if (run_time * 4 < average_time) return 300;
+  if (run_time * 3 < average_time) return 200;
+  if (run_time * 2 < average_time) return 150;
+  return 100;
+}
+
+void CorpusSampler::Add(absl::Duration run_time) {
+  const size_t idx = run_times_.size();
+  run_times_.push_back(run_time);
+  by_run_time_.insert({run_time, idx});
+  total_time_ += run_time;
+  const absl::Duration old_average_time = average_time_;
+  average_time_ = total_time_ / static_cast<int64_t>(run_times_.size());
+
+  // Append the new input with a zero weight: `tree_[idx + 1]` covers the
+  // inputs in [idx + 1 - LowestBit(idx + 1), idx + 1).
+  weights_.push_back(0);
+  tree_.push_back(PrefixSum(idx) - PrefixSum(idx + 1 - LowestBit(idx + 1)));
+  SetWeight(idx, GetWeight(run_time, average_time_));
+  if (idx == 0 || average_time_ == old_average_time) return;
+
+  // Only the inputs with run times between the old and the new position of a
+  // bucket boundary may have changed buckets. The ranges are widened by 1ns
+  // to be robust to the rounding of the boundaries.
+  const absl::Duration min_average = std::min(old_average_time, average_time_);
+  const absl::Duration max_average = std::max(old_average_time, average_time_);
+  for (const Fraction& boundary : kBucketBoundaries) {
+    const absl::Duration low = min_average * boundary.numerator /
+                                   boundary.denominator -
+                               absl::Nanoseconds(1);
+    const absl::Duration high = max_average * boundary.numerator /
+                                    boundary.denominator +
+                                absl::Nanoseconds(1);
+    for (auto it = by_run_time_.lower_bound({low, 0});
+         it != by_run_time_.end() && it->first <= high; ++it) {
+      const uint64_t weight = GetWeight(it->first, average_time_);
+      if (weight != weights_[it->second]) SetWeight(it->second, weight);
+    }
+  }
+}
+
+size_t CorpusSampler::Sample(absl::BitGenRef prng) const {
+  FUZZTEST_INTERNAL_CHECK(size() > 0, "Cannot sample from an empty corpus!");
+  // Find the input whose cumulative weight range contains `target` by
+  // descending the Fenwick tree.
+  uint64_t target = absl::Uniform<uint64_t>(prng, 0, PrefixSum(size()));
+  size_t pos = 0;
+  for (size_t step = absl::bit_floor(size()); step != 0; step >>= 1) {
+    if (pos + step <= size() && tree_[pos + step] <= target) {
+      pos += step;
+      target -= tree_[pos];
+    }
+  }
+  return pos;
+}
+
+void CorpusSampler::SetWeight(size_t idx, uint64_t weight) {
+  // Unsigned wrap-around makes this work for decreasing weights too.
+  const uint64_t delta = weight - weights_[idx];
+  weights_[idx] = weight;
+  for (size_t i = idx + 1; i < tree_.size(); i += LowestBit(i)) {
+    tree_[i] += delta;
+  }
+}
+
+uint64_t CorpusSampler::PrefixSum(size_t end) const {
+  uint64_t sum = 0;
+  for (size_t i = end; i != 0; i -= LowestBit(i)) sum += tree_[i];
+  return sum;
+}
+
+}  // namespace fuzztest::internal
@@ -0,0 +1,82 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUZZTEST_FUZZTEST_INTERNAL_CORPUS_SAMPLER_H_
+#define FUZZTEST_FUZZTEST_INTERNAL_CORPUS_SAMPLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/time/time.h"
+
+namespace fuzztest::internal {
+
+// Samples the indices of the corpus inputs with weights based on their run
+// times relative to the average run time of the corpus (see `GetWeight()`).
+//
+// Adding an input changes the average run time, and thus possibly the weights
+// of all the inputs. Instead of recomputing all of them, `Add()` only
+// revisits the inputs whose run times lie between the old and the new bucket
+// boundaries, found in a run-time-ordered set. The weights are kept in a
+// Fenwick tree, so that updating a weight and sampling are O(log n).
+class CorpusSampler {
+ public:
+  // Adds an input with `run_time` to the corpus. Its index is `size()` before
+  // the call.
+  void Add(absl::Duration run_time);
+
+  // Returns a random index in [0, `size()`), sampled proportionally to the
+  // weights of the inputs. Requires `size() > 0`.
+  size_t Sample(absl::BitGenRef prng) const;
+
+  // Returns the number of inputs in the corpus.
+  size_t size() const { return run_times_.size(); }
+
+  // Returns the current weight of the input at `idx`.
+  uint64_t GetWeight(size_t idx) const { return weights_[idx]; }
+
+  // Returns the weight of an input with `run_time` in a corpus with
+  // `average_time`. Prefers faster inputs over slower ones, with the maximum
+  // bias of 30x. The weights are dynamic and don't make slow-but-interesting
+  // inputs neglected: as more and more "slow but touched new coverage" inputs
+  // come in, the average run time gets larger and slow inputs get higher
+  // weights.
+  static uint64_t GetWeight(absl::Duration run_time,
+                            absl::Duration average_time);
+
+ private:
+  // Sets the weight of the input at `idx` to `weight`.
+  void SetWeight(size_t idx, uint64_t weight);
+
+  // Returns the sum of the weights of the inputs in [0, `end`).
+  uint64_t PrefixSum(size_t end) const;
+
+  std::vector<absl::Duration> run_times_;
+  absl::Duration total_time_ = absl::ZeroDuration();
+  absl::Duration average_time_ = absl::ZeroDuration();
+  // {run time, index} of every input, ordered by run time.
+  absl::btree_set<std::pair<absl::Duration, size_t>> by_run_time_;
+  std::vector<uint64_t> weights_;
+  // 1-based Fenwick tree over `weights_`: `tree_[i]` is the sum of the
+  // weights of the inputs in [i - LowestBit(i), i).
+  std::vector<uint64_t> tree_ = {0};
+};
+
+}  // namespace fuzztest::internal
+
+#endif  // FUZZTEST_FUZZTEST_INTERNAL_CORPUS_SAMPLER_H_
@@ -0,0 +1,85 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./fuzztest/internal/corpus_sampler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/random/random.h"
+#include "absl/time/time.h"
+
+namespace fuzztest::internal {
+namespace {
+
+TEST(CorpusSamplerTest, WeightsMatchFullRecomputation) {
+  std::mt19937 prng(1);
+  CorpusSampler sampler;
+  std::vector<absl::Duration> run_times;
+  for (int i = 0; i < 2000; ++i) {
+    // Mostly similar run times, with occasional very fast and very slow ones,
+    // so that the average moves and the inputs change buckets.
+    absl::Duration run_time = absl::Microseconds(50 + prng() % 100);
+    if (prng() % 20 == 0) run_time = absl::Nanoseconds(prng() % 1000);
+    if (prng() % 50 == 0) run_time = absl::Milliseconds(1 + prng() % 10);
+    run_times.push_back(run_time);
+    sampler.Add(run_time);
+
+    absl::Duration average_time = absl::ZeroDuration();
+    for (absl::Duration t : run_times) average_time += t;
+    average_time /= run_times.size();
+    ASSERT_EQ(sampler.size(), run_times.size());
+    for (size_t j = 0; j < run_times.size(); ++j) {
+      ASSERT_EQ(sampler.GetWeight(j),
+                CorpusSampler::GetWeight(run_times[j], average_time))
+          << i << " " << j;
+    }
+  }
+}
+
+TEST(CorpusSamplerTest, SamplesProportionallyToWeights) {
+  CorpusSampler sampler;
+  // The average is 11ms: weights 300, 300, 100 and 50.
+  sampler.Add(absl::Milliseconds(1));
+  sampler.Add(absl::Milliseconds(1));
+  sampler.Add(absl::Milliseconds(10));
+  sampler.Add(absl::Milliseconds(32));
+  ASSERT_EQ(sampler.GetWeight(0), 300);
+  ASSERT_EQ(sampler.GetWeight(1), 300);
+  ASSERT_EQ(sampler.GetWeight(2), 100);
+  ASSERT_EQ(sampler.GetWeight(3), 50);
+
+  absl::BitGen prng;
+  constexpr int kNumSamples = 75000;
+  std::vector<int> counts(sampler.size());
+  for (int i = 0; i < kNumSamples; ++i) ++counts[sampler.Sample(prng)];
+  // Expected counts: 30000, 30000, 10000, 5000.
+  EXPECT_NEAR(counts[0], 30000, 1000);
+  EXPECT_NEAR(counts[1], 30000, 1000);
+  EXPECT_NEAR(counts[2], 10000, 600);
+  EXPECT_NEAR(counts[3], 5000, 400);
+}
+
+TEST(CorpusSamplerTest, SamplesTheOnlyInput) {
+  CorpusSampler sampler;
+  sampler.Add(absl::Seconds(1));
+  absl::BitGen prng;
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(sampler.Sample(prng), 0);
+}
+
+}  // namespace
+}  // namespace fuzztest::internal
@@ -84,6 +84,32 @@ class AggregateOfImpl
     }
   }
 
+  // Picks a random mutable field, and either replaces it in `val` with the
+  // field of `other` or crosses the two fields over.
+  void CrossOver(corpus_type& val, const corpus_type& other,
+                 absl::BitGenRef prng) {
+    std::integral_constant<int, sizeof...(Inner)> size;
+    auto bound = internal::BindAggregate(val, size);
+    auto other_bound = internal::BindAggregate(other, size);
+    static constexpr auto to_mutate =
+        GetMutableSubtuple<decltype(internal::BindAggregate(std::declval<T&>(),
+                                                            size))>();
+    static constexpr size_t actual_size =
+        std::tuple_size_v<decltype(to_mutate)>;
+    if constexpr (actual_size > 0) {
+      int offset = absl::Uniform<int>(prng, 0, actual_size);
+      Switch<actual_size>(offset, [&](auto I) {
+        auto& field = std::get<to_mutate[I]>(bound);
+        const auto& other_field = std::get<to_mutate[I]>(other_bound);
+        if (absl::Bernoulli(prng, 0.5)) {
+          field = other_field;
+        } else {
+          std::get<to_mutate[I]>(inner_).CrossOver(field, other_field, prng);
+        }
+      });
+    }
+  }
+
   void UpdateMemoryDictionary(const corpus_type& val) {
     // Copy codes from Mutate that does the mutable domain filtering things.
     std::integral_constant<int, sizeof...(Inner)> size;
@@ -155,6 +181,14 @@ class AggregateOfImpl
     }
   }
 
+  std::optional<corpus_type> ParseCorpus(const IRObjectView& view) const {
+    if constexpr (has_custom_corpus_type) {
+      return ParseWithDomainTuple(inner_, view);
+    } else {
+      return view.ToCorpus<corpus_type>();
+    }
+  }
+
   IRObject SerializeCorpus(const corpus_type& v) const {
     if constexpr (has_custom_corpus_type) {
       return SerializeWithDomainTuple(inner_, v);
@@ -163,6 +197,14 @@ class AggregateOfImpl
     }
   }
 
+  void SerializeCorpus(const corpus_type& v, IRObjectWriter& writer) const {
+    if constexpr (has_custom_corpus_type) {
+      SerializeWithDomainTuple(inner_, v, writer);
+    } else {
+      writer.WriteCorpus(v);
+    }
+  }
+
   absl::Status ValidateCorpusValue(const corpus_type& corpus_value) const {
     absl::Status result = absl::OkStatus();
     ApplyIndex<sizeof...(Inner)>([&](auto... I) {
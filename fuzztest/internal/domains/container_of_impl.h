@@ -303,6 +303,24 @@ class ContainerOfImplBase : public domain_implementor::DomainBase<
     }
   }
 
+  std::optional<corpus_type> ParseCorpus(const IRObjectView& view) const {
+    if constexpr (has_custom_corpus_type) {
+      auto subs = view.Subs();
+      if (!subs) return std::nullopt;
+      corpus_type res;
+      for (const auto& elem : *subs) {
+        if (auto parsed_elem = ParseCorpusFromView(inner_, elem)) {
+          res.insert(res.end(), std::move(*parsed_elem));
+        } else {
+          return std::nullopt;
+        }
+      }
+      return res;
+    } else {
+      return view.ToCorpus<corpus_type>();
+    }
+  }
+
   IRObject SerializeCorpus(const corpus_type& v) const {
     if constexpr (has_custom_corpus_type) {
       IRObject obj;
@@ -316,6 +334,17 @@ class ContainerOfImplBase : public domain_implementor::DomainBase<
     }
   }
 
+  void SerializeCorpus(const corpus_type& v, IRObjectWriter& writer) const {
+    if constexpr (has_custom_corpus_type) {
+      writer.BeginObject(v.size());
+      for (const auto& elem : v) {
+        SerializeCorpusToWriter(inner_, elem, writer);
+      }
+    } else {
+      writer.WriteCorpus(v);
+    }
+  }
+
   absl::Status ValidateCorpusValue(const corpus_type& corpus_value) const {
     // Check size.
     if (corpus_value.size() < min_size()) {
@@ -460,6 +489,24 @@ Please verify that the inner domain can provide enough values.
     return val;
   }
 
+  // Inserts the elements of a random range of `other` that are not already in
+  // `val`, while `val` has room for them.
+  void CrossOver(corpus_type& val, const corpus_type& other,
+                 absl::BitGenRef prng) {
+    if (other.empty() || val.size() >= this->max_size()) return;
+    const size_t first = absl::Uniform<size_t>(prng, 0, other.size());
+    const size_t size = absl::Uniform<size_t>(absl::IntervalClosedClosed, prng,
+                                              1, other.size() - first);
+    // Use the real value to dedup the elements, as in `Grow()`.
+    auto real_value = this->GetValue(val);
+    auto it = std::next(other.begin(), first);
+    for (size_t i = 0; i < size && val.size() < this->max_size(); ++i, ++it) {
+      if (real_value.insert(this->inner_.GetValue(*it)).second) {
+        val.push_back(*it);
+      }
+    }
+  }
+
  private:
   friend Base;
 
@@ -565,6 +612,39 @@ class SequenceContainerOfImpl
     return field_counter;
   }
 
+  // Splices a random range of the elements of `other` into `val`: inserts it
+  // at a random position if `val` has room for it, and otherwise overwrites
+  // with it no more than half of the elements of `val`.
+  void CrossOver(corpus_type& val, const corpus_type& other,
+                 absl::BitGenRef prng) {
+    if (other.empty()) return;
+    const size_t max_size = this->max_size();
+    if (val.size() < max_size && (val.empty() || absl::Bernoulli(prng, 0.5))) {
+      // Insert other[first:first+size] at val[pos].
+      const size_t size =
+          absl::Uniform<size_t>(absl::IntervalClosedClosed, prng, 1,
+                                std::min(max_size - val.size(), other.size()));
+      const size_t first = absl::Uniform<size_t>(absl::IntervalClosedClosed,
+                                                 prng, 0, other.size() - size);
+      const size_t pos = absl::Uniform<size_t>(absl::IntervalClosedClosed,
+                                               prng, 0, val.size());
+      const auto other_first = std::next(other.begin(), first);
+      val.insert(std::next(val.begin(), pos), other_first,
+                 std::next(other_first, size));
+    } else if (!val.empty()) {
+      // Overwrite val[pos:pos+size] with other[first:first+size].
+      const size_t first = absl::Uniform<size_t>(prng, 0, other.size());
+      const size_t size = absl::Uniform<size_t>(
+          absl::IntervalClosedClosed, prng, 1,
+          std::min(std::max<size_t>(1, val.size() / 2), other.size() - first));
+      const size_t pos = absl::Uniform<size_t>(absl::IntervalClosedClosed,
+                                               prng, 0, val.size() - size);
+      const auto other_first = std::next(other.begin(), first);
+      std::copy(other_first, std::next(other_first, size),
+                std::next(val.begin(), pos));
+    }
+  }
+
  private:
   friend Base;
 
@@ -165,6 +165,20 @@ class Domain {
     return inner_->UntypedMutate(val, prng, only_shrink);
   }
 
+  // CrossOver() brings parts of `other`, another value of the domain's
+  // `corpus_type`, into `val`. For example, containers splice in a range of
+  // the elements of `other`, aggregates take one of the fields of `other`, and
+  // protocol buffers take one of the fields or submessages of `other`.
+  //
+  // Used during coverage-guided fuzzing to combine inputs while preserving
+  // their structure. Domains without internal structure leave `val` unchanged.
+  //
+  // ENSURES: That `val` remains a valid value of the domain.
+  void CrossOver(corpus_type& val, const corpus_type& other,
+                 absl::BitGenRef prng) {
+    return inner_->UntypedCrossOver(val, other, prng);
+  }
+
   // The methods below are responsible for transforming between the above
   // described three types that domains deal with. Here's a quick overview:
   //
@@ -207,11 +221,26 @@ class Domain {
     return inner_->UntypedParseCorpus(obj);
   }
 
+  // Like above, but parses the corpus value directly from a view of a
+  // serialized `IRObject`, without building the `IRObject` if the domain
+  // supports it.
+  std::optional<corpus_type> ParseCorpus(
+      const internal::IRObjectView& view) const {
+    return inner_->UntypedParseCorpus(view);
+  }
+
   // Turns `corpus_value` to an `IRObject`.
   internal::IRObject SerializeCorpus(const corpus_type& corpus_value) const {
     return inner_->UntypedSerializeCorpus(corpus_value);
   }
 
+  // Like above, but writes the serialized `corpus_value` with `writer`,
+  // without building the `IRObject` if the domain supports it.
+  void SerializeCorpus(const corpus_type& corpus_value,
+                       internal::IRObjectWriter& writer) const {
+    inner_->UntypedSerializeCorpus(corpus_value, writer);
+  }
+
   // Checks the validity of `corpus_value`, e.g., if it matches the domain's
   // constraints.
   //
@@ -307,6 +336,11 @@ class UntypedDomain {
     return inner_->UntypedMutate(corpus_value, prng, only_shrink);
   }
 
+  void CrossOver(corpus_type& corpus_value, const corpus_type& other,
+                 absl::BitGenRef prng) {
+    return inner_->UntypedCrossOver(corpus_value, other, prng);
+  }
+
   value_type GetValue(const corpus_type& corpus_value) const {
     return inner_->UntypedGetValue(corpus_value);
   }
@@ -315,10 +349,20 @@ class UntypedDomain {
     return inner_->UntypedParseCorpus(obj);
   }
 
+  std::optional<corpus_type> ParseCorpus(
+      const internal::IRObjectView& view) const {
+    return inner_->UntypedParseCorpus(view);
+  }
+
   internal::IRObject SerializeCorpus(const corpus_type& corpus_value) const {
     return inner_->UntypedSerializeCorpus(corpus_value);
   }
 
+  void SerializeCorpus(const corpus_type& corpus_value,
+                       internal::IRObjectWriter& writer) const {
+    inner_->UntypedSerializeCorpus(corpus_value, writer);
+  }
+
   absl::Status ValidateCorpusValue(const corpus_type& corpus_value) const {
     return inner_->UntypedValidateCorpusValue(corpus_value);
   }
@@ -165,6 +165,23 @@ class DomainBase {
     return internal::IRObject::FromCorpus(v);
   }
 
+  // Default parsing and serialization of the corpus values directly from/to
+  // the binary format, without building the `IRObject`s. Shadowing
+  // `ParseCorpus()` and `SerializeCorpus()` above hides these too, in which
+  // case `Domain<T>` falls back to going through `IRObject`s. Domains that
+  // shadow them may also provide these overloads, to avoid the fallback.
+  std::optional<CorpusType> ParseCorpus(
+      const internal::IRObjectView& view) const {
+    static_assert(!has_custom_corpus_type);
+    return view.ToCorpus<CorpusType>();
+  }
+
+  void SerializeCorpus(const CorpusType& v,
+                       internal::IRObjectWriter& writer) const {
+    static_assert(!has_custom_corpus_type);
+    writer.WriteCorpus(v);
+  }
+
   void UpdateMemoryDictionary(const CorpusType& val) {}
 
   uint64_t CountNumberOfFields(const CorpusType&) { return 0; }
@@ -173,6 +190,12 @@ class DomainBase {
     return 0;
   }
 
+  // Default crossover, which leaves `val` unchanged. Domains with structure
+  // shadow it to bring parts of `other`, a corpus value of the same domain,
+  // into `val`. See `Domain<T>::CrossOver()`.
+  void CrossOver(CorpusType& val, const CorpusType& other,
+                 absl::BitGenRef prng) {}
+
   // Stores `seeds` to be occasionally sampled from during value initialization.
   // When called multiple times, appends to the previously added seeds.
   //
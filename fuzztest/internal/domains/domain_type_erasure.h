@@ -58,14 +58,21 @@ class UntypedDomainConcept {
   virtual GenericDomainCorpusType UntypedInit(absl::BitGenRef) = 0;
   virtual void UntypedMutate(GenericDomainCorpusType& val, absl::BitGenRef prng,
                              bool only_shrink) = 0;
+  virtual void UntypedCrossOver(GenericDomainCorpusType& val,
+                                const GenericDomainCorpusType& other,
+                                absl::BitGenRef prng) = 0;
   virtual void UntypedUpdateMemoryDictionary(
       const GenericDomainCorpusType& val) = 0;
   virtual std::optional<GenericDomainCorpusType> UntypedParseCorpus(
       const IRObject& obj) const = 0;
+  virtual std::optional<GenericDomainCorpusType> UntypedParseCorpus(
+      const IRObjectView& view) const = 0;
   virtual absl::Status UntypedValidateCorpusValue(
       const GenericDomainCorpusType& corpus_value) const = 0;
   virtual IRObject UntypedSerializeCorpus(
       const GenericDomainCorpusType& v) const = 0;
+  virtual void UntypedSerializeCorpus(const GenericDomainCorpusType& v,
+                                      IRObjectWriter& writer) const = 0;
   virtual uint64_t UntypedCountNumberOfFields(
       const GenericDomainCorpusType&) = 0;
   virtual uint64_t UntypedMutateSelectedField(GenericDomainCorpusType&,
@@ -112,6 +119,36 @@ class TypedDomainConcept : public UntypedDomainConcept {
   }
 };
 
+// Parses the corpus value of `domain` directly from `view` if the domain
+// supports it (see `DomainBase::ParseCorpus()`). Otherwise, falls back to
+// parsing the corpus value from the `IRObject` built from `view`.
+template <typename D>
+std::optional<corpus_type_t<D>> ParseCorpusFromView(const D& domain,
+                                                    const IRObjectView& view) {
+  if constexpr (Requires<const D&, const IRObjectView&>(
+                    [](const auto& d, const auto& view)
+                        -> decltype(d.ParseCorpus(view)) {})) {
+    return domain.ParseCorpus(view);
+  } else {
+    return domain.ParseCorpus(view.ToIRObject());
+  }
+}
+
+// Serializes the corpus value `v` of `domain` directly with `writer` if the
+// domain supports it (see `DomainBase::SerializeCorpus()`). Otherwise, falls
+// back to writing the `IRObject` returned by the domain.
+template <typename D>
+void SerializeCorpusToWriter(const D& domain, const corpus_type_t<D>& v,
+                             IRObjectWriter& writer) {
+  if constexpr (Requires<const D&, const corpus_type_t<D>&, IRObjectWriter&>(
+                    [](const auto& d, const auto& v, auto& writer)
+                        -> decltype(d.SerializeCorpus(v, writer)) {})) {
+    domain.SerializeCorpus(v, writer);
+  } else {
+    writer.Write(domain.SerializeCorpus(v));
+  }
+}
+
 // `DomainModel<D>` is a wrapper around a concrete domain `D`. It implements the
 // concept classes `UntypedDomainConcept` and `TypedDomainConcept<ValueType>` by
 // delegating the calls to `Untyped[Name]` and `Typed[Name]` functions to the
@@ -139,6 +176,13 @@ class DomainModel final : public TypedDomainConcept<value_type_t<D>> {
     domain_.Mutate(val.GetAs<CorpusType>(), prng, only_shrink);
   }
 
+  void UntypedCrossOver(GenericDomainCorpusType& val,
+                        const GenericDomainCorpusType& other,
+                        absl::BitGenRef prng) final {
+    domain_.CrossOver(val.GetAs<CorpusType>(), other.GetAs<CorpusType>(),
+                      prng);
+  }
+
   void UntypedUpdateMemoryDictionary(const GenericDomainCorpusType& val) final {
     domain_.UpdateMemoryDictionary(val.GetAs<CorpusType>());
   }
@@ -171,11 +215,26 @@ class DomainModel final : public TypedDomainConcept<value_type_t<D>> {
     }
   }
 
+  std::optional<GenericDomainCorpusType> UntypedParseCorpus(
+      const IRObjectView& view) const final {
+    if (auto res = ParseCorpusFromView(domain_, view)) {
+      return GenericDomainCorpusType(std::in_place_type<CorpusType>,
+                                     *std::move(res));
+    } else {
+      return std::nullopt;
+    }
+  }
+
   IRObject UntypedSerializeCorpus(
       const GenericDomainCorpusType& v) const final {
     return domain_.SerializeCorpus(v.template GetAs<CorpusType>());
   }
 
+  void UntypedSerializeCorpus(const GenericDomainCorpusType& v,
+                              IRObjectWriter& writer) const final {
+    SerializeCorpusToWriter(domain_, v.template GetAs<CorpusType>(), writer);
+  }
+
   absl::Status UntypedValidateCorpusValue(
       const GenericDomainCorpusType& corpus_value) const final {
     return domain_.ValidateCorpusValue(corpus_value.GetAs<CorpusType>());
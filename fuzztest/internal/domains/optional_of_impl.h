@@ -92,6 +92,13 @@ class OptionalOfImpl
     }
   }
 
+  void CrossOver(corpus_type& val, const corpus_type& other,
+                 absl::BitGenRef prng) {
+    if (val.index() == 1 && other.index() == 1) {
+      inner_.CrossOver(std::get<1>(val), std::get<1>(other), prng);
+    }
+  }
+
   auto GetPrinter() const { return Printer{inner_}; }
 
   value_type GetValue(const corpus_type& v) const {
@@ -15,9 +15,11 @@
 #ifndef FUZZTEST_FUZZTEST_INTERNAL_DOMAINS_PROTOBUF_DOMAIN_IMPL_H_
 #define FUZZTEST_FUZZTEST_INTERNAL_DOMAINS_PROTOBUF_DOMAIN_IMPL_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -28,6 +30,7 @@
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/random/bit_gen_ref.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
@@ -682,6 +685,39 @@ class ProtobufDomainUntypedImpl
     MutateSelectedField(val, prng, only_shrink, selected_weight);
   }
 
+  // Picks a random field set in `other`, and either copies it to `val`, which
+  // swaps in whole submessages, or, for message fields set in both, crosses
+  // the submessages over. Map fields are only copied, as crossing their
+  // entries over could add duplicate keys (see `MutateVisitor`).
+  void CrossOver(corpus_type& val, const corpus_type& other,
+                 absl::BitGenRef prng) {
+    if (other.empty()) return;
+    const auto other_it =
+        std::next(other.begin(), absl::Uniform<size_t>(prng, 0, other.size()));
+    const FieldDescriptor* field = GetField(other_it->first);
+    if (field == nullptr) return;
+    auto val_it = val.find(field->number());
+    if (val_it != val.end() &&
+        field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE &&
+        !field->is_map() && absl::Bernoulli(prng, 0.5)) {
+      if (field->is_repeated()) {
+        GetSubDomain<ProtoMessageTag, true>(field).CrossOver(
+            val_it->second, other_it->second, prng);
+      } else {
+        GetSubDomain<ProtoMessageTag, false>(field).CrossOver(
+            val_it->second, other_it->second, prng);
+      }
+      return;
+    }
+    // At most one field of a oneof can be set.
+    if (const OneofDescriptor* oneof = field->containing_oneof()) {
+      for (int i = 0; i < oneof->field_count(); ++i) {
+        if (oneof->field(i) != field) val.erase(oneof->field(i)->number());
+      }
+    }
+    val.insert_or_assign(field->number(), other_it->second);
+  }
+
   struct GetValueVisitor {
     Message& message;
     const ProtobufDomainUntypedImpl& self;
@@ -1299,6 +1335,18 @@ class ProtobufDomainUntypedImpl
   template <typename T, bool is_repeated>
   auto& GetSubDomain(const FieldDescriptor* field) const {
     using DomainT = decltype(GetDefaultDomainForField<T, is_repeated>(field));
+    // Fast path: the domain of a non-extension field is published in
+    // `field_domains_` once it exists, and can be read without the lock.
+    const bool can_publish = !field->is_extension();
+    if (can_publish) {
+      if (std::atomic<CopyableAny*>* table =
+              field_domains_.load(std::memory_order_acquire)) {
+        if (CopyableAny* domain =
+                table[field->index()].load(std::memory_order_acquire)) {
+          return domain->template GetAs<DomainT>();
+        }
+      }
+    }
     // Do the operation under a lock to prevent race conditions in `const`
     // methods.
     absl::MutexLock l(&mutex_);
@@ -1309,6 +1357,23 @@ class ProtobufDomainUntypedImpl
                             GetDomainForField<T, is_repeated>(field))
                .first;
     }
+    if (can_publish) {
+      if (field_domains_table_ == nullptr) {
+        // Created on first use rather than in the constructor, which must not
+        // access the prototype.
+        const int field_count =
+            prototype_.Get()->GetDescriptor()->field_count();
+        // Value-initialized, so all the slots are null.
+        field_domains_table_ =
+            std::make_unique<std::atomic<CopyableAny*>[]>(field_count);
+        field_domains_.store(field_domains_table_.get(),
+                             std::memory_order_release);
+      }
+      // `domains_` has pointer stability, and its elements are never removed
+      // or replaced, so the pointer stays valid for the lifetime of `this`.
+      field_domains_table_[field->index()].store(&it->second,
+                                                 std::memory_order_release);
+    }
     return it->second.template GetAs<DomainT>();
   }
 
@@ -1546,8 +1611,16 @@ class ProtobufDomainUntypedImpl
   bool use_lazy_initialization_;
 
   mutable absl::Mutex mutex_;
-  mutable absl::flat_hash_map<int, CopyableAny> domains_
+  // The domains of the fields, keyed by field number. A node map, so that the
+  // domains can be referenced from `field_domains_`.
+  mutable absl::node_hash_map<int, CopyableAny> domains_
+      ABSL_GUARDED_BY(mutex_);
+  // The domains of the non-extension fields indexed by
+  // `FieldDescriptor::index()`, published from `domains_` once they are
+  // created, so that looking them up takes no lock. See `GetSubDomain()`.
+  mutable std::unique_ptr<std::atomic<CopyableAny*>[]> field_domains_table_
       ABSL_GUARDED_BY(mutex_);
+  mutable std::atomic<std::atomic<CopyableAny*>*> field_domains_{nullptr};
 
   ProtoPolicy<Message> policy_;
   absl::flat_hash_set<int> customized_fields_;
@@ -1586,6 +1659,11 @@ class ProtobufDomainImpl
     inner_.Mutate(val, prng, only_shrink);
   }
 
+  void CrossOver(corpus_type& val, const corpus_type& other,
+                 absl::BitGenRef prng) {
+    inner_.CrossOver(val, other, prng);
+  }
+
   value_type GetValue(const corpus_type& v) const {
     auto inner_v = inner_.GetValue(v);
     return std::move(static_cast<T&>(*inner_v));
@@ -124,6 +124,40 @@ std::optional<std::tuple<corpus_type_t<Domain>...>> ParseWithDomainTuple(
   });
 }
 
+// Like above, but write the serialized corpus directly with `writer`.
+template <typename... Domain>
+void SerializeWithDomainTuple(
+    const std::tuple<Domain...>& domains,
+    const std::tuple<corpus_type_t<Domain>...>& corpus,
+    IRObjectWriter& writer) {
+  writer.BeginObject(sizeof...(Domain));
+  ApplyIndex<sizeof...(Domain)>([&](auto... I) {
+    (SerializeCorpusToWriter(std::get<I>(domains), std::get<I>(corpus), writer),
+     ...);
+  });
+}
+
+// Like above, but parse the corpus directly from `view`.
+template <typename... Domain>
+std::optional<std::tuple<corpus_type_t<Domain>...>> ParseWithDomainTuple(
+    const std::tuple<Domain...>& domains, const IRObjectView& view,
+    int skip = 0) {
+  auto subs = view.Subs();
+  if (!subs || subs->size() != sizeof...(Domain) + skip) return std::nullopt;
+  auto it = subs->begin();
+  for (int i = 0; i < skip; ++i) ++it;
+  return ApplyIndex<sizeof...(Domain)>([&](auto... I) {
+    // Braced initialization guarantees the left-to-right evaluation order that
+    // the iteration over the subs relies on.
+    std::tuple<std::optional<corpus_type_t<Domain>>...> opts{
+        ParseCorpusFromView(std::get<I>(domains), *it++)...};
+    return (!std::get<I>(opts) || ...)
+               ? std::nullopt
+               : std::optional(std::tuple<corpus_type_t<Domain>...>{
+                     *std::move(std::get<I>(opts))...});
+  });
+}
+
 }  // namespace fuzztest::internal
 
 #endif  // FUZZTEST_FUZZTEST_INTERNAL_DOMAINS_SERIALIZATION_HELPERS_H_
@@ -14,7 +14,9 @@
 
 #include "./fuzztest/internal/io.h"
 
+#include <algorithm>
 #include <cerrno>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <filesystem>
@@ -23,11 +25,14 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/hash/hash.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "./fuzztest/internal/logging.h"
@@ -44,6 +49,23 @@
 #endif
 
 namespace fuzztest::internal {
+namespace {
+
+// Unlike the headers of `IRObject::ToString()`, which start with "FUZZTESTv1".
+constexpr absl::string_view kPackedCorpusHeader = "FUZZTEST_PACKED_CORPUS\n";
+constexpr size_t kPackedSizeBytes = sizeof(uint64_t);
+
+// Decodes the size prefix of an input in a packed corpus file. Requires
+// `bytes.size() >= kPackedSizeBytes`.
+uint64_t DecodePackedSize(absl::string_view bytes) {
+  uint64_t size = 0;
+  for (size_t i = 0; i < kPackedSizeBytes; ++i) {
+    size |= uint64_t{static_cast<unsigned char>(bytes[i])} << (8 * i);
+  }
+  return size;
+}
+
+}  // namespace
 
 #if defined(FUZZTEST_STUB_FILESYSTEM)
 
@@ -73,6 +95,10 @@ std::vector<std::string> ListDirectoryRecursively(absl::string_view path) {
   FUZZTEST_INTERNAL_CHECK(false, "Filesystem API not supported in iOS/MacOS");
 }
 
+bool PackedCorpusFileWriter::Append(absl::string_view data) {
+  FUZZTEST_INTERNAL_CHECK(false, "Filesystem API not supported in iOS/MacOS");
+}
+
 #else
 
 bool WriteFile(absl::string_view path, absl::string_view contents) {
@@ -149,8 +175,133 @@ std::vector<std::string> ListDirectoryRecursively(absl::string_view path) {
   return output_paths;
 }
 
+namespace {
+
+// Returns the size of the longest prefix of the packed corpus file at `path`
+// that ends with a complete input, or std::nullopt if the file isn't a packed
+// corpus file. Reads only the header and the size prefixes of the inputs.
+std::optional<std::uintmax_t> GetCompletePackedCorpusSize(
+    const std::filesystem::path& path, std::uintmax_t file_size) {
+  std::ifstream file(path, std::ios::binary);
+  std::string header(std::min<std::uintmax_t>(file_size,
+                                               kPackedCorpusHeader.size()),
+                     '\0');
+  if (!file.read(header.data(), header.size())) return std::nullopt;
+  if (!absl::StartsWith(kPackedCorpusHeader, header)) return std::nullopt;
+  // A truncated header is left by an interrupted first append.
+  if (header.size() < kPackedCorpusHeader.size()) return 0;
+  std::uintmax_t complete_size = kPackedCorpusHeader.size();
+  std::string size_bytes(kPackedSizeBytes, '\0');
+  while (file_size - complete_size >= kPackedSizeBytes) {
+    if (!file.seekg(complete_size) ||
+        !file.read(size_bytes.data(), kPackedSizeBytes)) {
+      return std::nullopt;
+    }
+    const uint64_t size = DecodePackedSize(size_bytes);
+    if (size > file_size - complete_size - kPackedSizeBytes) break;
+    complete_size += kPackedSizeBytes + size;
+  }
+  return complete_size;
+}
+
+}  // namespace
+
+bool PackedCorpusFileWriter::Append(absl::string_view data) {
+  const std::filesystem::path fs_path{path_};
+
+  // Just in case the directory does not currently exist.
+  // If it does, this is a noop.
+  CreateDirectory(fs_path.parent_path().string());
+
+  std::error_code error;
+  std::uintmax_t file_size = std::filesystem::file_size(fs_path, error);
+  if (error) file_size = 0;
+  // Find the end of the last complete input on the first append, or if the
+  // file was truncated since the previous one.
+  if (!complete_size_.has_value() || file_size < *complete_size_) {
+    std::optional<std::uintmax_t> complete_size = 0;
+    if (file_size > 0) {
+      complete_size = GetCompletePackedCorpusSize(fs_path, file_size);
+    }
+    if (!complete_size.has_value()) {
+      absl::FPrintF(GetStderr(), "[!] %s:%d: Not a packed corpus file: %s\n",
+                    __FILE__, __LINE__, path_);
+      return false;
+    }
+    complete_size_ = complete_size;
+  }
+  // Drop a truncated last input left by an interrupted append. Otherwise, its
+  // size prefix would swallow the inputs appended after it.
+  if (*complete_size_ < file_size) {
+    absl::FPrintF(GetStderr(),
+                  "[!] Dropping a truncated input at the end of %s.\n", path_);
+    std::filesystem::resize_file(fs_path, *complete_size_, error);
+    if (error) {
+      absl::FPrintF(GetStderr(), "[!] %s:%d: Error truncating %s: %s\n",
+                    __FILE__, __LINE__, path_, error.message());
+      return false;
+    }
+    file_size = *complete_size_;
+  }
+  // Write the whole record at once, so that a failed write is more likely to
+  // leave a truncated last input than a corrupted one.
+  std::string record;
+  if (file_size == 0) {
+    record.append(kPackedCorpusHeader.data(), kPackedCorpusHeader.size());
+  }
+  for (size_t i = 0; i < kPackedSizeBytes; ++i) {
+    record.push_back(static_cast<char>(uint64_t{data.size()} >> (8 * i)));
+  }
+  record.append(data.data(), data.size());
+
+  std::ofstream file(fs_path, std::ios::binary | std::ios::app);
+  file << record;
+  file.close();
+  if (!file.good()) {
+    absl::FPrintF(GetStderr(), "[!] %s:%d: Error writing %s: (%d) %s\n",
+                  __FILE__, __LINE__, path_, errno, strerror(errno));
+    return false;
+  }
+  complete_size_ = file_size + record.size();
+  return true;
+}
+
 #endif  // FUZZTEST_STUB_FILESYSTEM
 
+bool IsPackedCorpus(absl::string_view contents) {
+  return absl::StartsWith(contents, kPackedCorpusHeader);
+}
+
+std::vector<absl::string_view> UnpackCorpus(absl::string_view contents) {
+  FUZZTEST_INTERNAL_CHECK(IsPackedCorpus(contents), "Not a packed corpus!");
+  contents.remove_prefix(kPackedCorpusHeader.size());
+  std::vector<absl::string_view> inputs;
+  while (contents.size() >= kPackedSizeBytes) {
+    const uint64_t size = DecodePackedSize(contents);
+    if (size > contents.size() - kPackedSizeBytes) break;
+    inputs.push_back(contents.substr(kPackedSizeBytes, size));
+    contents.remove_prefix(kPackedSizeBytes + size);
+  }
+  if (!contents.empty()) {
+    absl::FPrintF(GetStderr(),
+                  "[!] Ignoring a truncated input at the end of a packed "
+                  "corpus file.\n");
+  }
+  return inputs;
+}
+
+bool ForEachInputInFile(absl::string_view path,
+                        absl::FunctionRef<void(absl::string_view)> consume) {
+  const std::optional<std::string> contents = ReadFile(path);
+  if (!contents.has_value()) return false;
+  if (!IsPackedCorpus(*contents)) {
+    consume(*contents);
+    return true;
+  }
+  for (absl::string_view input : UnpackCorpus(*contents)) consume(input);
+  return true;
+}
+
 std::string WriteDataToDir(absl::string_view data, absl::string_view outdir) {
   std::string filename(outdir);
   if (filename.back() != '/') filename += '/';
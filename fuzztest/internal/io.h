@@ -15,10 +15,13 @@
 #ifndef FUZZTEST_FUZZTEST_INTERNAL_IO_H_
 #define FUZZTEST_FUZZTEST_INTERNAL_IO_H_
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/strings/string_view.h"
 
 namespace fuzztest::internal {
@@ -49,6 +52,49 @@ std::vector<std::string> ListDirectoryRecursively(absl::string_view path);
 // path to the file.
 std::string WriteDataToDir(absl::string_view data, absl::string_view dir);
 
+// A packed corpus file stores many inputs in a single append-only file, which
+// avoids the per-file overhead of corpora with many tiny inputs. It starts with
+// a magic header, followed by the inputs, each prefixed with its size as a
+// 64-bit little-endian integer.
+
+// Appends inputs to the packed corpus file at `path`, creating the file if it
+// doesn't exist.
+//
+// A packed corpus file must have a single writer: appending to the same `path`
+// concurrently, from several threads, processes or writers, can corrupt it.
+class PackedCorpusFileWriter {
+ public:
+  explicit PackedCorpusFileWriter(std::string path) : path_(std::move(path)) {}
+
+  // Appends `data` to the file. Returns true on success, false otherwise,
+  // including when the file isn't a packed corpus file.
+  //
+  // First drops a truncated last input, e.g., from an interrupted append, so
+  // that it doesn't hide the appended input. Only the first append reads the
+  // file to find its last complete input; the later ones rely on the file's
+  // size after the previous append, unless the file got shorter since.
+  bool Append(absl::string_view data);
+
+ private:
+  std::string path_;
+  // The size of the file up to the end of its last complete input, once known.
+  std::optional<std::uintmax_t> complete_size_;
+};
+
+// Returns true if `contents` are the contents of a packed corpus file.
+bool IsPackedCorpus(absl::string_view contents);
+
+// Returns the inputs in the packed corpus file `contents`, as views into
+// `contents`. Ignores a truncated last input, e.g., from an interrupted append.
+// Requires `IsPackedCorpus(contents)`.
+std::vector<absl::string_view> UnpackCorpus(absl::string_view contents);
+
+// Reads the file at `path` and calls `consume` on every input in it: on each
+// input of a packed corpus file, or on the whole contents of any other file.
+// Returns false if the file couldn't be read, true otherwise.
+bool ForEachInputInFile(absl::string_view path,
+                        absl::FunctionRef<void(absl::string_view)> consume);
+
 struct FilePathAndData {
   std::string path;
   std::string data;
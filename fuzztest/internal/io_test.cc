@@ -18,21 +18,26 @@
 
 #include <cerrno>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "./fuzztest/fuzztest_core.h"
 
 namespace fuzztest::internal {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::FieldsAre;
 using ::testing::IsEmpty;
@@ -98,6 +103,114 @@ TEST(IOTest, WriteDataToDirWritesToSameFileOnSameData) {
   std::filesystem::remove_all(tmp_dir);
 }
 
+TEST(IOTest, PackedCorpusFileRoundTrips) {
+  const std::string tmp_dir = TmpDir("packed_test_dir");
+  const std::string path = absl::StrCat(tmp_dir, "/subdir/packed");
+  const std::string binary_input("a\0b", 3);
+  PackedCorpusFileWriter writer(path);
+  EXPECT_TRUE(writer.Append("Payload1"));
+  EXPECT_TRUE(writer.Append(""));
+  EXPECT_TRUE(writer.Append(binary_input));
+  const std::optional<std::string> contents = ReadFile(path);
+  ASSERT_TRUE(contents.has_value());
+  EXPECT_TRUE(IsPackedCorpus(*contents));
+  EXPECT_THAT(UnpackCorpus(*contents),
+              ElementsAre("Payload1", "", binary_input));
+  std::filesystem::remove_all(tmp_dir);
+}
+
+TEST(IOTest, UnpackCorpusIgnoresTruncatedLastInput) {
+  const std::string tmp_name = TmpFile("packed_test");
+  PackedCorpusFileWriter writer(tmp_name);
+  EXPECT_TRUE(writer.Append("Payload1"));
+  EXPECT_TRUE(writer.Append("Payload2"));
+  const std::optional<std::string> contents = ReadFile(tmp_name);
+  ASSERT_TRUE(contents.has_value());
+  const absl::string_view packed(*contents);
+  EXPECT_THAT(UnpackCorpus(packed.substr(0, contents->size() - 12)),
+              ElementsAre("Payload1"));
+  EXPECT_THAT(UnpackCorpus(packed.substr(0, contents->size() - 1)),
+              ElementsAre("Payload1"));
+  std::filesystem::remove(tmp_name);
+}
+
+TEST(IOTest, PackedCorpusFileWriterDropsTruncatedLastInput) {
+  const std::string tmp_name = TmpFile("packed_test");
+  EXPECT_TRUE(PackedCorpusFileWriter(tmp_name).Append("Payload1"));
+  EXPECT_TRUE(PackedCorpusFileWriter(tmp_name).Append("Payload2"));
+  // Simulate an append interrupted in the middle of "Payload2", by a previous
+  // writer.
+  std::filesystem::resize_file(tmp_name,
+                               std::filesystem::file_size(tmp_name) - 3);
+  PackedCorpusFileWriter writer(tmp_name);
+  EXPECT_TRUE(writer.Append("Payload3"));
+  std::optional<std::string> contents = ReadFile(tmp_name);
+  ASSERT_TRUE(contents.has_value());
+  EXPECT_THAT(UnpackCorpus(*contents), ElementsAre("Payload1", "Payload3"));
+
+  // Simulate a failed append of this writer, which left a partial input.
+  std::ofstream(tmp_name, std::ios::binary | std::ios::app)
+      << std::string("\x20\0\0", 3);
+  EXPECT_TRUE(writer.Append("Payload4"));
+  contents = ReadFile(tmp_name);
+  ASSERT_TRUE(contents.has_value());
+  EXPECT_THAT(UnpackCorpus(*contents),
+              ElementsAre("Payload1", "Payload3", "Payload4"));
+
+  // Simulate a first append interrupted in the middle of the header.
+  std::filesystem::resize_file(tmp_name, 5);
+  EXPECT_TRUE(writer.Append("Payload5"));
+  contents = ReadFile(tmp_name);
+  ASSERT_TRUE(contents.has_value());
+  EXPECT_THAT(UnpackCorpus(*contents), ElementsAre("Payload5"));
+  std::filesystem::remove(tmp_name);
+}
+
+TEST(IOTest, PackedCorpusFileWriterReadsTheFileOnlyOnFirstAppend) {
+  const std::string tmp_name = TmpFile("packed_test");
+  PackedCorpusFileWriter writer(tmp_name);
+  EXPECT_TRUE(writer.Append("Payload1"));
+  // Make the file unreadable as a packed corpus without changing its size. A
+  // writer that checked the whole file again would refuse to append.
+  const std::uintmax_t file_size = std::filesystem::file_size(tmp_name);
+  TestWrite(tmp_name, std::string(file_size, 'x'));
+  EXPECT_TRUE(writer.Append("Payload2"));
+  EXPECT_FALSE(PackedCorpusFileWriter(tmp_name).Append("Payload3"));
+  std::filesystem::remove(tmp_name);
+}
+
+TEST(IOTest, PackedCorpusFileWriterFailsOnRegularFile) {
+  const std::string tmp_name = TmpFile("regular_test");
+  TestWrite(tmp_name, "Payload1");
+  EXPECT_FALSE(PackedCorpusFileWriter(tmp_name).Append("Payload2"));
+  EXPECT_THAT(ReadFile(tmp_name), Optional(Eq("Payload1")));
+  std::filesystem::remove(tmp_name);
+}
+
+TEST(IOTest, ForEachInputInFileWorksForRegularAndPackedFiles) {
+  const std::string tmp_dir = TmpDir("packed_test_dir");
+  const std::string regular_path = absl::StrCat(tmp_dir, "/regular");
+  TestWrite(regular_path, "Payload1");
+  const std::string packed_path = absl::StrCat(tmp_dir, "/packed");
+  PackedCorpusFileWriter writer(packed_path);
+  EXPECT_TRUE(writer.Append("Payload2"));
+  EXPECT_TRUE(writer.Append("Payload3"));
+
+  std::vector<std::string> inputs;
+  auto consume = [&inputs](absl::string_view input) {
+    inputs.emplace_back(input);
+  };
+  EXPECT_TRUE(ForEachInputInFile(regular_path, consume));
+  EXPECT_THAT(inputs, ElementsAre("Payload1"));
+  inputs.clear();
+  EXPECT_TRUE(ForEachInputInFile(packed_path, consume));
+  EXPECT_THAT(inputs, ElementsAre("Payload2", "Payload3"));
+  inputs.clear();
+  EXPECT_FALSE(ForEachInputInFile("/doesnt_exist/file", consume));
+  EXPECT_THAT(inputs, IsEmpty());
+  std::filesystem::remove_all(tmp_dir);
+}
+
 TEST(IOTest, ReadFileReturnsNulloptWhenMissing) {
   EXPECT_THAT(ReadFile("/doesnt_exist/file"), Eq(std::nullopt));
   EXPECT_THAT(ReadFileOrDirectory("/doesnt_exist/file"),
@@ -0,0 +1,224 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./fuzztest/internal/parallel_replay.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#if !defined(_MSC_VER)
+#include <unistd.h>
+#endif  // !defined(_MSC_VER)
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "./fuzztest/internal/io.h"
+#include "./fuzztest/internal/logging.h"
+#include "./fuzztest/internal/subprocess.h"
+
+#if !defined(_MSC_VER)
+extern char** environ;
+#endif  // !defined(_MSC_VER)
+
+namespace fuzztest::internal {
+namespace {
+
+// Replays the files at `file_indices` in `files` with `run_worker`, starting a
+// new worker after each failure, and records the outcomes in `results`.
+void ReplayShard(
+    const std::vector<std::string>& files, std::vector<size_t> file_indices,
+    absl::FunctionRef<RunResults(const std::vector<std::string>& batch)>
+        run_worker,
+    std::vector<ReplayResult>& results) {
+  while (!file_indices.empty()) {
+    std::vector<std::string> batch;
+    batch.reserve(file_indices.size());
+    for (size_t idx : file_indices) batch.push_back(files[idx]);
+    const RunResults run_results = run_worker(batch);
+    const absl::string_view output = run_results.stderr_output;
+
+    // Count the files that the worker started replaying, in order. A packed
+    // corpus file prints a marker for each of its inputs.
+    size_t num_started = 0;
+    size_t last_started_output_offset = 0;
+    for (absl::string_view line : absl::StrSplit(output, '\n')) {
+      const size_t line_offset = line.data() - output.data();
+      if (!absl::ConsumePrefix(&line, kReplayingInputMarker)) continue;
+      if (num_started < batch.size() && line == batch[num_started]) {
+        ++num_started;
+        last_started_output_offset = line_offset;
+      }
+    }
+
+    if (run_results.status == ExitCode(0)) {
+      for (size_t i = 0; i < file_indices.size(); ++i) {
+        ReplayResult& result = results[file_indices[i]];
+        result.passed = i < num_started;
+        if (!result.passed) {
+          result.output = absl::StrCat(
+              "The replay subprocess exited without replaying the input:\n",
+              output);
+        }
+      }
+      return;
+    }
+    if (num_started == 0) {
+      // The worker failed before replaying any of the files, e.g., in the test
+      // setup. There's no point in retrying.
+      for (size_t idx : file_indices) {
+        results[idx].output =
+            absl::StrCat("The replay subprocess terminated with ",
+                         run_results.status, " before replaying the input:\n",
+                         output);
+      }
+      return;
+    }
+    if (num_started == batch.size() && batch.size() > 1) {
+      // The worker failed after starting the last file, but not necessarily
+      // because of it: e.g., a failure in the test's teardown, or a non-fatal
+      // failure that the worker didn't stop on, is only reported at the end.
+      // Replay the files one at a time to find the failing ones.
+      for (size_t idx : file_indices) {
+        ReplayShard(files, {idx}, run_worker, results);
+      }
+      return;
+    }
+    for (size_t i = 0; i + 1 < num_started; ++i) {
+      results[file_indices[i]].passed = true;
+    }
+    results[file_indices[num_started - 1]].output = absl::StrCat(
+        "The replay subprocess terminated with ", run_results.status, ":\n",
+        output.substr(last_started_output_offset));
+    file_indices.erase(file_indices.begin(),
+                       file_indices.begin() + num_started);
+  }
+}
+
+// Returns the command line arguments of the current process.
+std::vector<std::string> GetSelfCommandLine() {
+  const std::optional<std::string> cmdline = ReadFile("/proc/self/cmdline");
+  FUZZTEST_INTERNAL_CHECK(cmdline.has_value() && !cmdline->empty(),
+                          "Cannot read the command line of the test binary.");
+  std::vector<std::string> args =
+      absl::StrSplit(*cmdline, absl::ByChar('\0'), absl::SkipEmpty());
+  return args;
+}
+
+// Returns the environment of the current process, without the variables that
+// would make a replay subprocess interfere with the test process, e.g., by
+// writing the same test result files or by running only a test shard.
+absl::flat_hash_map<std::string, std::string> GetReplayWorkerEnvironment() {
+  constexpr absl::string_view kVariablesToDrop[] = {
+      "GTEST_OUTPUT",           "GTEST_SHARD_INDEX",
+      "GTEST_SHARD_STATUS_FILE", "GTEST_TOTAL_SHARDS",
+      "TEST_PREMATURE_EXIT_FILE", "TEST_SHARD_INDEX",
+      "TEST_SHARD_STATUS_FILE",  "TEST_TOTAL_SHARDS",
+      "XML_OUTPUT_FILE",
+  };
+  absl::flat_hash_map<std::string, std::string> environment;
+#if !defined(_MSC_VER)
+  for (char** var = environ; *var != nullptr; ++var) {
+    const absl::string_view var_str = *var;
+    const size_t eq = var_str.find('=');
+    if (eq == absl::string_view::npos) continue;
+    const absl::string_view name = var_str.substr(0, eq);
+    if (std::find(std::begin(kVariablesToDrop), std::end(kVariablesToDrop),
+                  name) != std::end(kVariablesToDrop)) {
+      continue;
+    }
+    environment.emplace(std::string(name),
+                        std::string(var_str.substr(eq + 1)));
+  }
+#endif  // !defined(_MSC_VER)
+  return environment;
+}
+
+}  // namespace
+
+std::vector<ReplayResult> ReplayInParallel(
+    const std::vector<std::string>& files, size_t num_workers,
+    absl::FunctionRef<RunResults(const std::vector<std::string>& batch)>
+        run_worker) {
+  std::vector<ReplayResult> results(files.size());
+  for (size_t i = 0; i < files.size(); ++i) results[i].path = files[i];
+  if (files.empty()) return results;
+  num_workers = std::clamp<size_t>(num_workers, 1, files.size());
+
+  // Each worker only writes the results of its own files.
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (size_t worker = 0; worker < num_workers; ++worker) {
+    std::vector<size_t> file_indices;
+    for (size_t i = worker; i < files.size(); i += num_workers) {
+      file_indices.push_back(i);
+    }
+    workers.emplace_back([&files, file_indices = std::move(file_indices),
+                          run_worker, &results]() mutable {
+      ReplayShard(files, std::move(file_indices), run_worker, results);
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+  return results;
+}
+
+RunResults RunReplayWorker(absl::string_view test_name,
+                           const std::vector<std::string>& files) {
+  std::string list_path =
+      (std::filesystem::temp_directory_path() / "fuzztest-replay-list-XXXXXX")
+          .string();
+#if !defined(_MSC_VER)
+  const int list_fd = mkstemp(list_path.data());
+  FUZZTEST_INTERNAL_CHECK(list_fd != -1,
+                          "Cannot create a temporary file: ", strerror(errno));
+  close(list_fd);
+#endif  // !defined(_MSC_VER)
+  FUZZTEST_INTERNAL_CHECK(WriteFile(list_path, absl::StrJoin(files, "\n")),
+                          "Cannot write the replay list file ", list_path);
+
+  std::vector<std::string> command_line;
+  for (std::string& arg : GetSelfCommandLine()) {
+    // The subprocess runs only `test_name` and must not overwrite the test
+    // result files of this process.
+    if (absl::StartsWith(arg, "--gtest_output") ||
+        absl::StartsWith(arg, "--gtest_filter")) {
+      continue;
+    }
+    command_line.push_back(std::move(arg));
+  }
+  command_line.push_back(absl::StrCat("--gtest_filter=", test_name));
+  absl::flat_hash_map<std::string, std::string> environment =
+      GetReplayWorkerEnvironment();
+  environment[kReplayListEnvVar] = list_path;
+
+  RunResults run_results = RunCommand(command_line, environment);
+  std::remove(list_path.c_str());
+  return run_results;
+}
+
+}  // namespace fuzztest::internal
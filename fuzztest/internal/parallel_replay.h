@@ -0,0 +1,69 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUZZTEST_FUZZTEST_INTERNAL_PARALLEL_REPLAY_H_
+#define FUZZTEST_FUZZTEST_INTERNAL_PARALLEL_REPLAY_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/strings/string_view.h"
+#include "./fuzztest/internal/subprocess.h"
+
+namespace fuzztest::internal {
+
+// The environment variable with the path to a file that lists the input files
+// to replay, one per line and in order. Set for the replay subprocesses.
+inline constexpr absl::string_view kReplayListEnvVar = "FUZZTEST_REPLAY_LIST";
+
+// The prefix of the line that the replaying process prints to stderr right
+// before replaying an input file, followed by the file's path.
+inline constexpr absl::string_view kReplayingInputMarker = "[.] Replaying ";
+
+// The outcome of replaying one input file in a replay subprocess.
+struct ReplayResult {
+  std::string path;
+  bool passed = false;
+  // For a failed input, the termination status and the relevant stderr output
+  // of the subprocess that replayed it.
+  std::string output;
+};
+
+// Replays `files` in up to `num_workers` concurrent workers and returns the
+// result for each of the files, in the same order.
+//
+// `run_worker(batch)` must replay the files in `batch` in order in a new
+// process, printing `kReplayingInputMarker` before each of them, and stop on
+// the first failing one. It is called concurrently from several threads. The
+// files are split between the workers up front. When a worker fails, the file
+// it was replaying is marked as failed, the files before it as passed, and the
+// files after it are replayed by a new worker. When a worker fails after
+// starting the last file of its batch, which doesn't tell whether that file
+// failed, the files of the batch are replayed again one at a time.
+std::vector<ReplayResult> ReplayInParallel(
+    const std::vector<std::string>& files, size_t num_workers,
+    absl::FunctionRef<RunResults(const std::vector<std::string>& batch)>
+        run_worker);
+
+// Replays `files` in order in a subprocess running only the test `test_name`
+// of the current test binary, with the same command line flags. The
+// subprocess finds `files` through `kReplayListEnvVar`. Linux only.
+RunResults RunReplayWorker(absl::string_view test_name,
+                           const std::vector<std::string>& files);
+
+}  // namespace fuzztest::internal
+
+#endif  // FUZZTEST_FUZZTEST_INTERNAL_PARALLEL_REPLAY_H_
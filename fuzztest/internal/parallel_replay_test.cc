@@ -0,0 +1,130 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./fuzztest/internal/parallel_replay.h"
+
+#include <atomic>
+#include <csignal>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "./fuzztest/internal/subprocess.h"
+
+namespace fuzztest::internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+MATCHER_P(Passed, path, "") {
+  return arg.path == path && arg.passed && arg.output.empty();
+}
+
+MATCHER_P2(Failed, path, output_substr, "") {
+  return arg.path == path && !arg.passed &&
+         absl::StrContains(arg.output, output_substr);
+}
+
+// Replays `batch` like a replay subprocess: crashes on the files containing
+// "crash", and exits with `exit_code` otherwise, or with 1 if the batch
+// contains files containing "fail" (like a failure reported only at the end of
+// the test).
+RunResults FakeWorker(const std::vector<std::string>& batch,
+                      int exit_code = 0) {
+  std::string stderr_output = "Test setup\n";
+  for (const std::string& file : batch) {
+    absl::StrAppend(&stderr_output, kReplayingInputMarker, file, "\n");
+    if (absl::StrContains(file, "crash")) {
+      absl::StrAppend(&stderr_output, "Crashed on ", file, "\n");
+      return {TerminationStatus(SIGABRT), "", stderr_output};
+    }
+    if (absl::StrContains(file, "fail")) exit_code = 1;
+  }
+  return {TerminationStatus(exit_code << 8), "", stderr_output};
+}
+
+TEST(ReplayInParallelTest, ReportsAllPassingInputs) {
+  std::atomic<int> num_workers = 0;
+  EXPECT_THAT(ReplayInParallel({"a", "b", "c", "d", "e"}, /*num_workers=*/2,
+                               [&](const std::vector<std::string>& batch) {
+                                 ++num_workers;
+                                 return FakeWorker(batch);
+                               }),
+              ElementsAre(Passed("a"), Passed("b"), Passed("c"), Passed("d"),
+                          Passed("e")));
+  EXPECT_EQ(num_workers, 2);
+}
+
+TEST(ReplayInParallelTest, ContinuesAfterFailingInputsInNewWorkers) {
+  std::atomic<int> num_workers = 0;
+  EXPECT_THAT(
+      ReplayInParallel({"a", "crash1", "c", "crash2", "e", "f"},
+                       /*num_workers=*/1,
+                       [&](const std::vector<std::string>& batch) {
+                         ++num_workers;
+                         return FakeWorker(batch);
+                       }),
+      ElementsAre(Passed("a"),
+                  Failed("crash1", "Replaying crash1\nCrashed on crash1"),
+                  Passed("c"),
+                  Failed("crash2", "Replaying crash2\nCrashed on crash2"),
+                  Passed("e"), Passed("f")));
+  EXPECT_EQ(num_workers, 3);
+}
+
+TEST(ReplayInParallelTest, ReplaysOneAtATimeWhenWorkerFailsAfterLastInput) {
+  std::atomic<int> num_workers = 0;
+  EXPECT_THAT(ReplayInParallel({"a", "fail", "c"}, /*num_workers=*/1,
+                               [&](const std::vector<std::string>& batch) {
+                                 ++num_workers;
+                                 return FakeWorker(batch);
+                               }),
+              ElementsAre(Passed("a"), Failed("fail", "Replaying fail"),
+                          Passed("c")));
+  EXPECT_EQ(num_workers, 4);
+}
+
+TEST(ReplayInParallelTest, FailsAllInputsWhenWorkerFailsBeforeReplaying) {
+  EXPECT_THAT(ReplayInParallel({"a", "b"}, /*num_workers=*/1,
+                               [](const std::vector<std::string>& batch) {
+                                 return RunResults{TerminationStatus(1 << 8),
+                                                   "", "Setup failed\n"};
+                               }),
+              ElementsAre(Failed("a", "Setup failed"),
+                          Failed("b", "Setup failed")));
+}
+
+TEST(ReplayInParallelTest, FailsInputsNotReplayedByExitingWorker) {
+  EXPECT_THAT(ReplayInParallel({"a", "b", "c"}, /*num_workers=*/1,
+                               [](const std::vector<std::string>& batch) {
+                                 return FakeWorker({batch[0]});
+                               }),
+              ElementsAre(Passed("a"), Failed("b", "without replaying"),
+                          Failed("c", "without replaying")));
+}
+
+TEST(ReplayInParallelTest, ReturnsNoResultsForNoInputs) {
+  EXPECT_THAT(ReplayInParallel({}, /*num_workers=*/4,
+                               [](const std::vector<std::string>& batch) {
+                                 return FakeWorker(batch);
+                               }),
+              IsEmpty());
+}
+
+}  // namespace
+}  // namespace fuzztest::internal
@@ -0,0 +1,82 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUZZTEST_FUZZTEST_INTERNAL_PARSED_INPUT_CACHE_H_
+#define FUZZTEST_FUZZTEST_INTERNAL_PARSED_INPUT_CACHE_H_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "./fuzztest/internal/logging.h"
+
+namespace fuzztest::internal {
+
+// A bounded cache from serialized inputs to their parsed values of type `T`,
+// which saves re-parsing the inputs that were recently parsed. A cached value
+// is used instead of parsing its serialized input again, so it must be exactly
+// what the input parses to (and have passed the same validation), in the one
+// domain that the cache is used with.
+//
+// The cache keeps at least the `capacity` most recently inserted values, and
+// at most 2 * `capacity` values: once `capacity` values have been inserted,
+// they become the older generation, replacing the previous one.
+//
+// Not thread-safe.
+template <typename T>
+class ParsedInputCache {
+ public:
+  explicit ParsedInputCache(size_t capacity) : capacity_(capacity) {
+    FUZZTEST_INTERNAL_CHECK(capacity > 0, "capacity must be positive");
+  }
+
+  // Caches `value` as the parsed form of `serialized`.
+  void Insert(std::string serialized, T value) {
+    if (recent_.size() >= capacity_) {
+      older_ = std::move(recent_);
+      recent_.clear();
+    }
+    recent_.insert_or_assign(std::move(serialized), std::move(value));
+  }
+
+  // Returns the cached value parsed from `serialized`, or nullptr if there is
+  // none. The returned pointer is valid until the next call to `Insert()`.
+  T* Find(absl::string_view serialized) {
+    ++lookups_;
+    auto it = recent_.find(serialized);
+    if (it == recent_.end()) {
+      it = older_.find(serialized);
+      if (it == older_.end()) return nullptr;
+    }
+    ++hits_;
+    return &it->second;
+  }
+
+  // The number of calls to `Find()`, and of those that found a value.
+  size_t lookups() const { return lookups_; }
+  size_t hits() const { return hits_; }
+
+ private:
+  const size_t capacity_;
+  absl::flat_hash_map<std::string, T> recent_;
+  absl::flat_hash_map<std::string, T> older_;
+  size_t lookups_ = 0;
+  size_t hits_ = 0;
+};
+
+}  // namespace fuzztest::internal
+
+#endif  // FUZZTEST_FUZZTEST_INTERNAL_PARSED_INPUT_CACHE_H_
@@ -0,0 +1,75 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./fuzztest/internal/parsed_input_cache.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace fuzztest::internal {
+namespace {
+
+using ::testing::IsNull;
+using ::testing::Pointee;
+
+TEST(ParsedInputCacheTest, FindsInsertedValuesAndCountsHits) {
+  ParsedInputCache<int> cache(/*capacity=*/10);
+  cache.Insert("one", 1);
+  cache.Insert("two", 2);
+
+  EXPECT_THAT(cache.Find("one"), Pointee(1));
+  EXPECT_THAT(cache.Find("two"), Pointee(2));
+  EXPECT_THAT(cache.Find("three"), IsNull());
+  EXPECT_EQ(cache.lookups(), 3);
+  EXPECT_EQ(cache.hits(), 2);
+}
+
+TEST(ParsedInputCacheTest, ReplacesValueOfSameInput) {
+  ParsedInputCache<int> cache(/*capacity=*/10);
+  cache.Insert("input", 1);
+  cache.Insert("input", 2);
+
+  EXPECT_THAT(cache.Find("input"), Pointee(2));
+}
+
+TEST(ParsedInputCacheTest, ValuesCanBeModifiedInPlace) {
+  ParsedInputCache<std::string> cache(/*capacity=*/10);
+  cache.Insert("input", "value");
+  *cache.Find("input") = "new value";
+
+  EXPECT_THAT(cache.Find("input"), Pointee(std::string("new value")));
+}
+
+TEST(ParsedInputCacheTest, EvictsOldestGenerationWhenFull) {
+  ParsedInputCache<int> cache(/*capacity=*/2);
+  cache.Insert("1", 1);
+  cache.Insert("2", 2);
+  cache.Insert("3", 3);
+  cache.Insert("4", 4);
+  // The last `capacity` values are always kept.
+  EXPECT_THAT(cache.Find("3"), Pointee(3));
+  EXPECT_THAT(cache.Find("4"), Pointee(4));
+  // Inserting "5" starts a new generation and evicts "1" and "2".
+  cache.Insert("5", 5);
+  EXPECT_THAT(cache.Find("1"), IsNull());
+  EXPECT_THAT(cache.Find("2"), IsNull());
+  EXPECT_THAT(cache.Find("3"), Pointee(3));
+  EXPECT_THAT(cache.Find("4"), Pointee(4));
+  EXPECT_THAT(cache.Find("5"), Pointee(5));
+}
+
+}  // namespace
+}  // namespace fuzztest::internal
@@ -38,7 +38,6 @@
 #include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/random/bit_gen_ref.h"
-#include "absl/random/discrete_distribution.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
@@ -46,18 +45,21 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "./fuzztest/internal/configuration.h"
 #include "./fuzztest/internal/corpus_database.h"
+#include "./fuzztest/internal/corpus_sampler.h"
 #include "./fuzztest/internal/coverage.h"
 #include "./fuzztest/internal/domains/domain_base.h"
 #include "./fuzztest/internal/fixture_driver.h"
 #include "./fuzztest/internal/flag_name.h"
 #include "./fuzztest/internal/io.h"
 #include "./fuzztest/internal/logging.h"
+#include "./fuzztest/internal/parallel_replay.h"
 #include "./fuzztest/internal/printer.h"
 #include "./fuzztest/internal/serialization.h"
 
@@ -76,6 +78,19 @@ using ::fuzztest::domain_implementor::RawSink;
 
 void (*crash_handler_hook)();
 
+// Whether `RunReplayWorker()` is supported.
+#if defined(__linux__)
+constexpr bool kCanReplayInSubprocesses = true;
+#else
+constexpr bool kCanReplayInSubprocesses = false;
+#endif  // defined(__linux__)
+
+// The name of the packed corpus file that `TryWriteCorpusFile()` appends to
+// with FUZZTEST_TESTSUITE_OUT_PACKED. Packed corpus files must have a single
+// writer, so a FUZZTEST_TESTSUITE_OUT_DIR must not be shared between fuzzing
+// processes in that mode.
+constexpr absl::string_view kPackedCorpusFileName = "packed_corpus";
+
 void Runtime::DumpReproducer(absl::string_view outdir) const {
   const std::string content =
       current_args_->domain.SerializeCorpus(current_args_->corpus_value)
@@ -444,10 +459,12 @@ FuzzTestFuzzerImpl::FuzzTestFuzzerImpl(
   stats_.start_time = absl::Now();
   const char* corpus_out_dir_chars = getenv("FUZZTEST_TESTSUITE_OUT_DIR");
   if (corpus_out_dir_chars) corpus_out_dir_ = corpus_out_dir_chars;
-
-  std::vector<double> weights = {100.};
-  corpus_distribution_ =
-      absl::discrete_distribution<>(weights.begin(), weights.end());
+  if (!corpus_out_dir_.empty() &&
+      !absl::NullSafeStringView(getenv("FUZZTEST_TESTSUITE_OUT_PACKED"))
+           .empty()) {
+    packed_corpus_out_.emplace(
+        absl::StrCat(corpus_out_dir_, "/", kPackedCorpusFileName));
+  }
 }
 
 FuzzTestFuzzerImpl::~FuzzTestFuzzerImpl() {
@@ -456,12 +473,18 @@ FuzzTestFuzzerImpl::~FuzzTestFuzzerImpl() {
 
 std::optional<corpus_type> FuzzTestFuzzerImpl::TryParse(
     absl::string_view data) {
-  auto ir_value = IRObject::FromString(data);
-  if (!ir_value) {
-    absl::FPrintF(GetStderr(), "[!] Unexpected file format.\n");
-    return std::nullopt;
+  std::optional<corpus_type> corpus_value;
+  // Parse the binary format directly, without building the `IRObject`.
+  if (auto view = IRObjectView::FromString(data)) {
+    corpus_value = params_domain_.ParseCorpus(*view);
+  } else {
+    auto ir_value = IRObject::FromString(data);
+    if (!ir_value) {
+      absl::FPrintF(GetStderr(), "[!] Unexpected file format.\n");
+      return std::nullopt;
+    }
+    corpus_value = params_domain_.ParseCorpus(*ir_value);
   }
-  auto corpus_value = params_domain_.ParseCorpus(*ir_value);
   if (!corpus_value) {
     absl::FPrintF(GetStderr(), "[!] Unexpected intermediate representation.\n");
     return std::nullopt;
@@ -476,29 +499,69 @@ std::optional<corpus_type> FuzzTestFuzzerImpl::TryParse(
   return corpus_value;
 }
 
-std::optional<GenericDomainCorpusType>
-FuzzTestFuzzerImpl::GetCorpusValueFromFile(const std::string& path) {
-  const auto content = ReadFile(path);
-  if (!content) {
+std::string FuzzTestFuzzerImpl::SerializeArgs(const corpus_type& args) const {
+  std::string out;
+  IRObjectWriter writer(out);
+  params_domain_.SerializeCorpus(args, writer);
+  return out;
+}
+
+std::vector<GenericDomainCorpusType>
+FuzzTestFuzzerImpl::GetCorpusValuesFromFile(const std::string& path) {
+  std::vector<GenericDomainCorpusType> corpus_values;
+  const bool read = ForEachInputInFile(path, [&](absl::string_view data) {
+    auto corpus_value = TryParse(data);
+    if (!corpus_value) {
+      absl::FPrintF(GetStderr(),
+                    "[!] Skipping invalid input in file %s.\n===\n%s\n===\n",
+                    path, data);
+      return;
+    }
+    corpus_values.push_back(*std::move(corpus_value));
+  });
+  if (!read) {
     absl::FPrintF(GetStderr(),
                   "[!] Failed to read file or directory (might be empty): %s\n",
                   path);
-    return std::nullopt;
-  }
-  auto corpus_value = TryParse(*content);
-  if (!corpus_value) {
-    absl::FPrintF(GetStderr(),
-                  "[!] Skipping invalid input file %s.\n===\n%s\n===\n", path,
-                  *content);
   }
-  return corpus_value;
+  return corpus_values;
 }
 
 void FuzzTestFuzzerImpl::ReplayInput(const std::string& path) {
-  auto corpus_value = GetCorpusValueFromFile(path);
-  if (!corpus_value) return;
-  absl::FPrintF(GetStderr(), "[.] Replaying %s\n", path);
-  RunOneInput({*corpus_value});
+  for (auto& corpus_value : GetCorpusValuesFromFile(path)) {
+    absl::FPrintF(GetStderr(), "%s%s\n", kReplayingInputMarker, path);
+    RunOneInput({std::move(corpus_value)});
+  }
+}
+
+void FuzzTestFuzzerImpl::ReplayInputsInSubprocesses(
+    const std::vector<std::string>& files, size_t num_jobs) {
+  absl::FPrintF(GetStderr(), "[*] Using %d subprocesses to replay %d inputs.\n",
+                std::min(num_jobs, files.size()), files.size());
+  const std::vector<ReplayResult> results = ReplayInParallel(
+      files, num_jobs, [this](const std::vector<std::string>& batch) {
+        return RunReplayWorker(test_.full_name(), batch);
+      });
+  const ReplayResult* first_failure = nullptr;
+  size_t num_failed = 0;
+  for (const ReplayResult& result : results) {
+    if (result.passed) continue;
+    ++num_failed;
+    if (first_failure == nullptr) first_failure = &result;
+    absl::FPrintF(GetStderr(), "[!] Failed to replay %s:\n%s\n", result.path,
+                  result.output);
+  }
+  absl::FPrintF(GetStderr(),
+                "[*] Replayed %d inputs in subprocesses: %d passed, %d "
+                "failed.\n",
+                results.size(), results.size() - num_failed, num_failed);
+  if (first_failure == nullptr) return;
+  // Replay the first failing input in this process, so that the test fails
+  // and reports the failure the same way as without subprocesses.
+  ReplayInput(first_failure->path);
+  FUZZTEST_INTERNAL_CHECK(false, "Input ", first_failure->path,
+                          " failed in a replay subprocess, but not in the "
+                          "test process. See the output above.");
 }
 
 bool FuzzTestFuzzerImpl::ReplayInputsIfAvailable(
@@ -508,8 +571,16 @@ bool FuzzTestFuzzerImpl::ReplayInputsIfAvailable(
   runtime_.SetRunMode(RunMode::kFuzz);
 
   if (const auto file_paths = GetFilesToReplay()) {
+    // A subprocess of `ReplayInputsInSubprocesses()` stops on the first input
+    // with a non-fatal failure, so that the failure is attributed to it rather
+    // than to the last input.
+    const bool is_replay_subprocess =
+        !absl::NullSafeStringView(getenv(kReplayListEnvVar.data())).empty();
     for (const std::string& path : *file_paths) {
       ReplayInput(path);
+      if (is_replay_subprocess && runtime_.external_failure_detected()) {
+        std::exit(1);
+      }
     }
     return true;
   }
@@ -526,8 +597,7 @@ bool FuzzTestFuzzerImpl::ReplayInputsIfAvailable(
 
     PRNG prng(seed_sequence_);
 
-    const auto original_serialized =
-        params_domain_.SerializeCorpus(*to_minimize).ToString();
+    const auto original_serialized = SerializeArgs(*to_minimize);
 
     // In minimize mode we keep mutating the given reproducer value with
     // `only_shrink=true` until we crash. We drop mutations that don't
@@ -546,8 +616,7 @@ bool FuzzTestFuzzerImpl::ReplayInputsIfAvailable(
       num_mutations = std::max(1, num_mutations - 1);
       // We compare the serialized version. Not very efficient but works for
       // now.
-      if (params_domain_.SerializeCorpus(copy).ToString() ==
-          original_serialized) {
+      if (SerializeArgs(copy) == original_serialized) {
         continue;
       }
 
@@ -566,6 +635,17 @@ bool FuzzTestFuzzerImpl::ReplayInputsIfAvailable(
 }
 
 std::optional<std::vector<std::string>> FuzzTestFuzzerImpl::GetFilesToReplay() {
+  // Set for the subprocesses of `ReplayInputsInSubprocesses()`.
+  if (const auto list_file =
+          absl::NullSafeStringView(getenv(kReplayListEnvVar.data()));
+      !list_file.empty()) {
+    const std::optional<std::string> list = ReadFile(list_file);
+    FUZZTEST_INTERNAL_CHECK(list.has_value(),
+                            "Cannot read the replay list file ", list_file);
+    std::vector<std::string> files =
+        absl::StrSplit(*list, '\n', absl::SkipEmpty());
+    return files;
+  }
   auto file_or_dir = absl::NullSafeStringView(getenv("FUZZTEST_REPLAY"));
   if (file_or_dir.empty()) return std::nullopt;
   // Try as a directory path first.
@@ -621,39 +701,6 @@ void FuzzTestFuzzerImpl::MutateValue(Input& input, absl::BitGenRef prng) {
   }
 }
 
-void FuzzTestFuzzerImpl::UpdateCorpusDistribution() {
-  std::vector<double> weights(corpus_.size());
-  absl::Duration average_time = absl::ZeroDuration();
-  for (const Input& i : corpus_) {
-    average_time += i.run_time;
-  }
-  average_time /= corpus_.size();
-  // Prefer faster inputs than slower inputs, the maximum bias
-  // is 30x. These weights are dynamic and won't make slow-but-interesting
-  // inputs neglected: As more and more "slow but touched new coverage"
-  // inputs come in, the average execution time will be larger and slow input
-  // will get higher weights.
-  for (size_t i = 0; i < corpus_.size(); ++i) {
-    weights[i] = 100;
-    if (corpus_[i].run_time > average_time * 10)
-      weights[i] = 10;
-    else if (corpus_[i].run_time > average_time * 4)
-      weights[i] = 25;
-    else if (corpus_[i].run_time > average_time * 2)
-      weights[i] = 50;
-    else if (corpus_[i].run_time * 3 > average_time * 4)
-      weights[i] = 75;
-    else if (corpus_[i].run_time * 4 < average_time)
-      weights[i] = 300;
-    else if (corpus_[i].run_time * 3 < average_time)
-      weights[i] = 200;
-    else if (corpus_[i].run_time * 2 < average_time)
-      weights[i] = 150;
-  }
-  corpus_distribution_ =
-      absl::discrete_distribution<>(weights.begin(), weights.end());
-}
-
 FuzzTestFuzzerImpl::RunResult FuzzTestFuzzerImpl::TrySample(
     const Input& sample, bool write_to_file) {
   RunResult run_result = RunOneInput(sample);
@@ -690,8 +737,8 @@ void FuzzTestFuzzerImpl::TrySampleAndUpdateInMemoryCorpus(Input sample,
   if (!new_coverage) return;
   // New coverage, update corpus and weights.
   sample.run_time = run_time;
+  corpus_sampler_.Add(run_time);
   corpus_.push_back(std::move(sample));
-  UpdateCorpusDistribution();
 }
 
 void FuzzTestFuzzerImpl::ForEachInputFile(
@@ -700,15 +747,15 @@ void FuzzTestFuzzerImpl::ForEachInputFile(
   int parsed_input_counter = 0;
   int invalid_input_counter = 0;
   for (const auto& path : files) {
-    std::optional<std::string> data = ReadFile(path);
-    if (!data) continue;
-    if (auto corpus_value = TryParse(*data)) {
-      ++parsed_input_counter;
-      consume(Input{*std::move(corpus_value)});
-    } else {
-      ++invalid_input_counter;
-      absl::FPrintF(GetStderr(), "[!] Invalid input file %s.\n", path);
-    }
+    ForEachInputInFile(path, [&](absl::string_view data) {
+      if (auto corpus_value = TryParse(data)) {
+        ++parsed_input_counter;
+        consume(Input{*std::move(corpus_value)});
+      } else {
+        ++invalid_input_counter;
+        absl::FPrintF(GetStderr(), "[!] Invalid input in file %s.\n", path);
+      }
+    });
   }
   absl::FPrintF(GetStderr(),
                 "[*] Parsed %d inputs and ignored %d inputs from the test "
@@ -743,9 +790,12 @@ FuzzTestFuzzerImpl::TryReadCorpusFromFiles() {
 
 void FuzzTestFuzzerImpl::TryWriteCorpusFile(const Input& input) {
   if (corpus_out_dir_.empty()) return;
-  if (WriteDataToDir(params_domain_.SerializeCorpus(input.args).ToString(),
-                     corpus_out_dir_)
-          .empty()) {
+  const std::string data = SerializeArgs(input.args);
+  const bool written =
+      packed_corpus_out_.has_value()
+          ? packed_corpus_out_->Append(data)
+          : !WriteDataToDir(data, corpus_out_dir_).empty();
+  if (!written) {
     absl::FPrintF(GetStderr(), "[!] Failed to write corpus file.\n");
   }
 }
@@ -781,13 +831,13 @@ void FuzzTestFuzzerImpl::PopulateFromSeeds(
         /*write_to_file=*/true);
   }
   for (const auto& corpus_file : corpus_files) {
-    auto seed = GetCorpusValueFromFile(corpus_file);
-    if (!seed) continue;
-    TrySampleAndUpdateInMemoryCorpus(
-        Input{*seed},
-        // Dump the seed to the corpus so that it is present when the corpus is
-        // used in minimization or coverage replay.
-        /*write_to_file=*/true);
+    for (auto& seed : GetCorpusValuesFromFile(corpus_file)) {
+      TrySampleAndUpdateInMemoryCorpus(
+          Input{std::move(seed)},
+          // Dump the seed to the corpus so that it is present when the corpus
+          // is used in minimization or coverage replay.
+          /*write_to_file=*/true);
+    }
   }
 }
 
@@ -839,13 +889,17 @@ void FuzzTestFuzzerImpl::RunInUnitTestMode(const Configuration& configuration) {
     }
 
     CorpusDatabase corpus_database(configuration);
-    for (const std::string& file :
-         corpus_database.GetRegressionInputs(test_.full_name())) {
-      ReplayInput(file);
-    }
-    for (const std::string& file :
-         corpus_database.GetCoverageInputsIfAny(test_.full_name())) {
-      ReplayInput(file);
+    std::vector<std::string> files_to_replay =
+        corpus_database.GetRegressionInputs(test_.full_name());
+    const std::vector<std::string> coverage_files =
+        corpus_database.GetCoverageInputsIfAny(test_.full_name());
+    files_to_replay.insert(files_to_replay.end(), coverage_files.begin(),
+                           coverage_files.end());
+    if (kCanReplayInSubprocesses && configuration.replay_jobs > 1 &&
+        files_to_replay.size() > 1) {
+      ReplayInputsInSubprocesses(files_to_replay, configuration.replay_jobs);
+    } else {
+      for (const std::string& file : files_to_replay) ReplayInput(file);
     }
 
     runtime_.SetRunMode(RunMode::kUnitTest);
@@ -960,9 +1014,8 @@ void FuzzTestFuzzerImpl::MinimizeNonFatalFailureLocally(absl::BitGenRef prng) {
     // Only run it if it actually is different. Random mutations might
     // not actually change the value, or we have reached a minimum that can't be
     // minimized anymore.
-    if (params_domain_.SerializeCorpus(minimal_non_fatal_counterexample_->args)
-            .ToString() !=
-        params_domain_.SerializeCorpus(copy.args).ToString()) {
+    if (SerializeArgs(minimal_non_fatal_counterexample_->args) !=
+        SerializeArgs(copy.args)) {
       runtime_.SetExternalFailureDetected(false);
       RunOneInput(copy);
       if (runtime_.external_failure_detected()) {
@@ -1080,7 +1133,7 @@ int FuzzTestFuzzerImpl::RunInFuzzingMode(int* /*argc*/, char*** /*argv*/,
           next_init = stats_.runs + kRunsPerInit;
           return {params_domain_.Init(prng)};
         } else {
-          size_t idx = static_cast<size_t>(corpus_distribution_(prng));
+          size_t idx = corpus_sampler_.Sample(prng);
           FUZZTEST_INTERNAL_CHECK(0 <= idx && idx < corpus_.size(),
                                   "Corpus input weights are outdated!\n");
           return corpus_[idx];
@@ -31,13 +31,13 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/functional/function_ref.h"
 #include "absl/random/bit_gen_ref.h"
-#include "absl/random/discrete_distribution.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "./fuzztest/internal/configuration.h"
+#include "./fuzztest/internal/corpus_sampler.h"
 #include "./fuzztest/internal/coverage.h"
 #include "./fuzztest/internal/domains/domain.h"
 #include "./fuzztest/internal/fixture_driver.h"
@@ -274,9 +274,11 @@ class FuzzTestFuzzerImpl : public FuzzTestFuzzer {
 
   std::optional<corpus_type> TryParse(absl::string_view data);
 
-  void MutateValue(Input& input, absl::BitGenRef prng);
+  // Returns the serialized `args` in the binary format, as parsed by
+  // `TryParse()`.
+  std::string SerializeArgs(const corpus_type& args) const;
 
-  void UpdateCorpusDistribution();
+  void MutateValue(Input& input, absl::BitGenRef prng);
 
   void MinimizeNonFatalFailureLocally(absl::BitGenRef prng);
 
@@ -308,9 +310,17 @@ class FuzzTestFuzzerImpl : public FuzzTestFuzzer {
 
   bool ShouldStop();
 
-  std::optional<GenericDomainCorpusType> GetCorpusValueFromFile(
+  // Returns the valid corpus values in the file at `path`, which is either a
+  // single serialized input or a packed corpus file (see io.h).
+  std::vector<GenericDomainCorpusType> GetCorpusValuesFromFile(
       const std::string& path);
+  // Replays the input(s) in the file at `path`, see `ForEachInputInFile()`.
   void ReplayInput(const std::string& path);
+  // Replays `files` in up to `num_jobs` parallel subprocesses and reports the
+  // outcome for each of them. If any of them fails, replays it in this process
+  // to fail the test.
+  void ReplayInputsInSubprocesses(const std::vector<std::string>& files,
+                                  size_t num_jobs);
 
   const FuzzTest& test_;
   std::unique_ptr<UntypedFixtureDriver> fixture_driver_;
@@ -319,10 +329,13 @@ class FuzzTestFuzzerImpl : public FuzzTestFuzzer {
   ExecutionCoverage* execution_coverage_;
   CorpusCoverage corpus_coverage_;
   std::deque<Input> corpus_;
-  // Corpus distribution is only used in Fuzzing mode.
-  absl::discrete_distribution<> corpus_distribution_;
+  // Samples the inputs of `corpus_`. Only used in Fuzzing mode.
+  CorpusSampler corpus_sampler_;
 
   absl::string_view corpus_out_dir_;
+  // If set, `TryWriteCorpusFile()` appends the inputs to a single packed
+  // corpus file in `corpus_out_dir_` instead of writing a file per input.
+  std::optional<PackedCorpusFileWriter> packed_corpus_out_;
   RuntimeStats stats_{};
   std::optional<size_t> runs_limit_;
   absl::Time time_limit_ = absl::InfiniteFuture();
@@ -171,17 +171,6 @@ bool ParseImpl(IRObject& obj, absl::string_view& str, int recursion_depth) {
   }
 }
 
-// NOTE: Binary format assumes the same endianness between producers and
-// consumers - we assume little-endianness for now.
-
-enum class BinaryFormatHeader : char {
-  kEmpty = 0,
-  kUInt64,
-  kDouble,
-  kString,
-  kObject,
-};
-
 struct BinaryOutputVisitor {
   char* buf;
   size_t& offset;
@@ -232,8 +221,6 @@ struct BinaryOutputVisitor {
   }
 };
 
-constexpr absl::string_view kBinaryHeader = "FUZZTESTv1b";
-
 struct BinaryParseBuf {
   const char* str;
   size_t size;
@@ -299,6 +286,47 @@ bool BinaryParse(IRObject& obj, BinaryParseBuf& buf, int recursion_depth) {
   return false;
 }
 
+// Like `BinaryParse()`, but only validates the object and skips over it.
+bool BinarySkip(BinaryParseBuf& buf, int recursion_depth) {
+  if (recursion_depth > kMaxParseRecursionDepth) return false;
+  if (buf.empty()) return false;
+  const auto h = static_cast<BinaryFormatHeader>(buf.str[0]);
+  buf.Advance(1);
+  switch (h) {
+    case BinaryFormatHeader::kEmpty: {
+      return true;
+    }
+    case BinaryFormatHeader::kUInt64:
+    case BinaryFormatHeader::kDouble: {
+      if (buf.size < sizeof(uint64_t)) return false;
+      buf.Advance(sizeof(uint64_t));
+      return true;
+    }
+    case BinaryFormatHeader::kString: {
+      if (buf.size < sizeof(uint64_t)) return false;
+      uint64_t str_size;
+      std::memcpy(&str_size, buf.str, sizeof(str_size));
+      buf.Advance(sizeof(uint64_t));
+      if (buf.size < str_size) return false;
+      buf.Advance(str_size);
+      return true;
+    }
+    case BinaryFormatHeader::kObject: {
+      if (buf.size < sizeof(uint64_t)) return false;
+      uint64_t vec_size;
+      std::memcpy(&vec_size, buf.str, sizeof(vec_size));
+      buf.Advance(sizeof(vec_size));
+      // This could happen for malformed inputs.
+      if (vec_size > buf.size) return false;
+      for (uint64_t i = 0; i < vec_size; ++i) {
+        if (!BinarySkip(buf, recursion_depth + 1)) return false;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
 bool IsInBinaryFormat(absl::string_view str) {
   // Not using absl::string_view or std::memcmp because they could be
   // instrumented and using them could pollute coverage.
@@ -344,4 +372,38 @@ std::optional<IRObject> IRObject::FromString(absl::string_view str) {
   return object;
 }
 
+std::optional<IRObjectView> IRObjectView::FromString(absl::string_view str) {
+  if (!IsInBinaryFormat(str)) return std::nullopt;
+  BinaryParseBuf buf = {str.data(), str.size()};
+  buf.Advance(kBinaryHeader.size());
+  const char* data = buf.str;
+  if (!BinarySkip(buf, /*recursion_depth=*/0) || !buf.empty())
+    return std::nullopt;
+  return IRObjectView(data);
+}
+
+const char* IRObjectView::End() const {
+  // The object was validated in `FromString()`, so it can't go out of bounds.
+  BinaryParseBuf buf = {data_, std::numeric_limits<size_t>::max()};
+  BinarySkip(buf, /*recursion_depth=*/0);
+  return buf.str;
+}
+
+IRObject IRObjectView::ToIRObject() const {
+  const char* end = End();
+  BinaryParseBuf buf = {data_, static_cast<size_t>(end - data_)};
+  IRObject object;
+  BinaryParse(object, buf, /*recursion_depth=*/0);
+  return object;
+}
+
+void IRObjectWriter::Write(const IRObject& object) {
+  size_t offset = out_.size();
+  std::visit(BinaryOutputVisitor{/*buf=*/nullptr, offset}, object.value);
+  const size_t start = out_.size();
+  out_.resize(offset);
+  offset = start;
+  std::visit(BinaryOutputVisitor{out_.data(), offset}, object.value);
+}
+
 }  // namespace fuzztest::internal
@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -306,6 +307,347 @@ struct IRObject {
       RemoveConstFromPair(std::pair<K, V>);
 };
 
+// The binary format of `IRObject::ToString()`: `kBinaryHeader` followed by the
+// object. Every object starts with its header, followed by:
+//   - kEmpty: nothing.
+//   - kUInt64, kDouble: the 8-byte value.
+//   - kString: the 8-byte size, followed by the bytes.
+//   - kObject: the 8-byte number of subs, followed by the subs.
+//
+// NOTE: Binary format assumes the same endianness between producers and
+// consumers - we assume little-endianness for now.
+inline constexpr absl::string_view kBinaryHeader = "FUZZTESTv1b";
+
+enum class BinaryFormatHeader : char {
+  kEmpty = 0,
+  kUInt64,
+  kDouble,
+  kString,
+  kObject,
+};
+
+// A non-owning view of an `IRObject` serialized in the binary format, with the
+// same accessors as `IRObject`. Unlike `IRObject::FromString()`, creating the
+// view doesn't build the `IRObject` tree: the string payloads are views into
+// the buffer, and the subs are decoded lazily while iterating over them. Use it
+// to parse the corpus values directly from the buffer, see
+// `DomainBase::ParseCorpus()`.
+//
+// The buffer must outlive the view and the views of its subs.
+class IRObjectView {
+ public:
+  class SubRange;
+
+  // Returns the view of the object in `str`, or nullopt if `str` is not a valid
+  // object in the binary format. In particular, returns nullopt for the text
+  // format, which should be parsed with `IRObject::FromString()`.
+  //
+  // Validates all of `str`, so that the accessors don't need to.
+  static std::optional<IRObjectView> FromString(absl::string_view str);
+
+  // See `IRObject::GetScalar()`.
+  template <typename T>
+  auto GetScalar() const {
+    if constexpr (std::is_enum_v<T>) {
+      auto inner = GetScalar<std::underlying_type_t<T>>();
+      return inner ? std::optional(static_cast<T>(*inner)) : std::nullopt;
+    } else if constexpr (std::is_integral_v<T>) {
+      return header() == BinaryFormatHeader::kUInt64
+                 ? std::optional(static_cast<T>(ReadUInt64(data_ + 1)))
+                 : std::nullopt;
+    } else if constexpr (std::is_same_v<float, T> ||
+                         std::is_same_v<double, T>) {
+      if (header() != BinaryFormatHeader::kDouble) return std::optional<T>();
+      double d;
+      std::memcpy(&d, data_ + 1, sizeof(d));
+      return std::optional(static_cast<T>(d));
+    } else if constexpr (std::is_same_v<std::string, T>) {
+      std::optional<absl::string_view> out;
+      if (header() == BinaryFormatHeader::kString) {
+        out = absl::string_view(data_ + 1 + sizeof(uint64_t),
+                                ReadUInt64(data_ + 1));
+      }
+      return out;
+    }
+  }
+
+  // See `IRObject::Subs()`.
+  std::optional<SubRange> Subs() const;
+
+  // See `IRObject::ToCorpus()`.
+  template <typename T>
+  std::optional<T> ToCorpus() const;
+
+  // Returns the viewed object as an `IRObject`.
+  IRObject ToIRObject() const;
+
+ private:
+  explicit IRObjectView(const char* data) : data_(data) {}
+
+  static uint64_t ReadUInt64(const char* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+  }
+
+  BinaryFormatHeader header() const {
+    return static_cast<BinaryFormatHeader>(data_[0]);
+  }
+
+  // Returns the end of the viewed object in the buffer.
+  const char* End() const;
+
+  // The start of the viewed object in the buffer.
+  const char* data_;
+};
+
+// The subs of an `IRObjectView`: a forward range of `IRObjectView`s. Moving to
+// the next sub skips over the current one, which takes time proportional to
+// its size if it has subs.
+class IRObjectView::SubRange {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = IRObjectView;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const IRObjectView*;
+    using reference = const IRObjectView&;
+
+    const IRObjectView& operator*() const { return current_; }
+    const IRObjectView* operator->() const { return &current_; }
+
+    Iterator& operator++() {
+      // Avoid skipping over the last sub, which nobody will look at.
+      if (--remaining_ > 0) current_ = IRObjectView(current_.End());
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    // Only iterators of the same range may be compared.
+    friend bool operator==(const Iterator& a, const Iterator& b) {
+      return a.remaining_ == b.remaining_;
+    }
+    friend bool operator!=(const Iterator& a, const Iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    friend class SubRange;
+    Iterator(const char* first, size_t remaining)
+        : current_(first), remaining_(remaining) {}
+
+    IRObjectView current_;
+    size_t remaining_;
+  };
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  Iterator begin() const { return Iterator(first_, size_); }
+  Iterator end() const { return Iterator(first_, 0); }
+
+ private:
+  friend class IRObjectView;
+  SubRange(const char* first, size_t size) : first_(first), size_(size) {}
+
+  const char* first_;
+  size_t size_;
+};
+
+inline std::optional<IRObjectView::SubRange> IRObjectView::Subs() const {
+  switch (header()) {
+    case BinaryFormatHeader::kObject:
+      return SubRange(data_ + 1 + sizeof(uint64_t), ReadUInt64(data_ + 1));
+    // The empty vector is serialized the same way as the monostate: nothing.
+    // Handle that case too.
+    case BinaryFormatHeader::kEmpty:
+      return SubRange(nullptr, 0);
+    default:
+      return std::nullopt;
+  }
+}
+
+template <typename T>
+std::optional<T> IRObjectView::ToCorpus() const {
+  if constexpr (std::is_const_v<T>) {
+    return ToCorpus<std::remove_const_t<T>>();
+  } else if constexpr (is_monostate_v<T>) {
+    if (header() == BinaryFormatHeader::kEmpty) return T{};
+    return std::nullopt;
+  } else if constexpr (std::is_same_v<T, IRObject>) {
+    return ToIRObject();
+  } else if constexpr (std::is_constructible_v<IRObject, T>) {
+    if (auto v = GetScalar<T>()) {
+      return static_cast<T>(*v);
+    }
+    return std::nullopt;
+  } else if constexpr (is_variant_v<T>) {
+    auto elems = Subs();
+    if (!elems || elems->size() != 2) return std::nullopt;
+    auto it = elems->begin();
+    auto index = it->ToCorpus<size_t>();
+    if (!index || *index >= std::variant_size_v<T>) return std::nullopt;
+    ++it;
+    return Switch<std::variant_size_v<T>>(
+        *index, [&](auto I) -> std::optional<T> {
+          auto inner = it->ToCorpus<std::variant_alternative_t<I, T>>();
+          if (inner) return T(std::in_place_index<I>, *std::move(inner));
+          return std::nullopt;
+        });
+  } else if constexpr (std::is_same_v<T, absl::int128> ||
+                       std::is_same_v<T, absl::uint128>) {
+    if (auto res = ToCorpus<std::pair<uint64_t, uint64_t>>()) {
+      return static_cast<T>(absl::MakeUint128(res->first, res->second));
+    }
+    return std::nullopt;
+  } else if constexpr (is_protocol_buffer_v<T>) {
+    auto v = GetScalar<std::string>();
+    T out;
+    if (v && out.ParseFromArray(v->data(), v->size())) return out;
+    return std::nullopt;
+  } else if constexpr (is_dynamic_container_v<T>) {
+    if constexpr (is_bytevector_v<T>) {
+      if (auto v = GetScalar<std::string>()) {
+        T out;
+        out.resize(v->size());
+        std::memcpy(out.data(), v->data(), v->size());
+        return out;
+      }
+    }
+
+    auto elems = Subs();
+    if (!elems) return std::nullopt;
+
+    T out;
+    if constexpr (is_vector_v<T>) out.reserve(elems->size());
+    for (const auto& elem : *elems) {
+      if (auto inner = elem.ToCorpus<typename T::value_type>()) {
+        out.insert(out.end(), *std::move(inner));
+      } else {
+        return std::nullopt;
+      }
+    }
+    return out;
+  } else {
+    // Must be a tuple like object.
+    auto elems = Subs();
+    if (!elems || elems->size() != std::tuple_size_v<T>) return std::nullopt;
+    auto it = elems->begin();
+    auto parts = ApplyIndex<std::tuple_size_v<T>>([&](auto... I) {
+      return std::tuple{it++->ToCorpus<std::tuple_element_t<I, T>>()...};
+    });
+    return std::apply(
+        [&](auto&... part) -> std::optional<T> {
+          if ((!part || ...)) return std::nullopt;
+          return T{*std::move(part)...};
+        },
+        parts);
+  }
+}
+
+// Serializes objects in the binary format directly from the corpus values,
+// without building the intermediate `IRObject`s: for any corpus value `v`,
+// writing `v` with `WriteCorpus()` appends the same bytes as
+// `IRObject::FromCorpus(v).ToString()`. See `DomainBase::SerializeCorpus()`.
+//
+// An object with subs is written with `BeginObject()`, followed by writing the
+// subs.
+class IRObjectWriter {
+ public:
+  // Appends `kBinaryHeader` to `out`, to be followed by exactly one object.
+  // `out` may be reserved by the caller to avoid reallocation.
+  explicit IRObjectWriter(std::string& out) : out_(out) {
+    out_.append(kBinaryHeader.data(), kBinaryHeader.size());
+  }
+
+  void WriteEmpty() { WriteHeader(BinaryFormatHeader::kEmpty); }
+
+  void WriteUInt64(uint64_t value) {
+    WriteHeader(BinaryFormatHeader::kUInt64);
+    WriteRaw(&value, sizeof(value));
+  }
+
+  void WriteDouble(double value) {
+    WriteHeader(BinaryFormatHeader::kDouble);
+    WriteRaw(&value, sizeof(value));
+  }
+
+  void WriteString(absl::string_view value) {
+    WriteHeader(BinaryFormatHeader::kString);
+    const uint64_t size = value.size();
+    WriteRaw(&size, sizeof(size));
+    WriteRaw(value.data(), value.size());
+  }
+
+  // Starts an object with `num_subs` subs, which must be written next.
+  void BeginObject(size_t num_subs) {
+    WriteHeader(BinaryFormatHeader::kObject);
+    const uint64_t size = num_subs;
+    WriteRaw(&size, sizeof(size));
+  }
+
+  void Write(const IRObject& object);
+
+  // Writes `IRObject::FromCorpus(value)`.
+  template <typename T>
+  void WriteCorpus(const T& value) {
+    if constexpr (is_monostate_v<T>) {
+      WriteEmpty();
+    } else if constexpr (std::is_enum_v<T> || std::is_integral_v<T>) {
+      WriteUInt64(static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+      WriteDouble(static_cast<double>(value));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      WriteString(value);
+    } else if constexpr (std::is_constructible_v<IRObject, T>) {
+      Write(IRObject(value));
+    } else if constexpr (is_variant_v<T>) {
+      BeginObject(2);
+      WriteUInt64(value.index());
+      std::visit([this](const auto& v) { WriteCorpus(v); }, value);
+    } else if constexpr (std::is_same_v<T, absl::int128> ||
+                         std::is_same_v<T, absl::uint128>) {
+      WriteCorpus(
+          std::pair(absl::Uint128High64(value), absl::Uint128Low64(value)));
+    } else if constexpr (is_protocol_buffer_v<T>) {
+      WriteString(value.SerializeAsString());
+    } else if constexpr (is_bitvector_v<T>) {
+      BeginObject(value.size());
+      for (bool elem : value) WriteUInt64(elem);
+    } else if constexpr (is_bytevector_v<T>) {
+      WriteString(absl::string_view(
+          reinterpret_cast<const char*>(value.data()), value.size()));
+    } else if constexpr (is_dynamic_container_v<T>) {
+      if constexpr (has_size_v<T>) {
+        BeginObject(value.size());
+      } else {
+        BeginObject(std::distance(value.begin(), value.end()));
+      }
+      for (const auto& elem : value) WriteCorpus(elem);
+    } else {
+      // Must be a tuple like object.
+      BeginObject(std::tuple_size_v<T>);
+      std::apply([this](const auto&... elem) { (WriteCorpus(elem), ...); },
+                 value);
+    }
+  }
+
+ private:
+  void WriteHeader(BinaryFormatHeader header) {
+    out_.push_back(static_cast<char>(header));
+  }
+
+  void WriteRaw(const void* data, size_t size) {
+    out_.append(static_cast<const char*>(data), size);
+  }
+
+  std::string& out_;
+};
+
 }  // namespace fuzztest::internal
 
 #endif  // FUZZTEST_FUZZTEST_INTERNAL_SERIALIZATION_H_
@@ -30,6 +30,8 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
 #include "./fuzztest/internal/test_protobuf.pb.h"
 #include "google/protobuf/text_format.h"
 #include "google/protobuf/util/message_differencer.h"
@@ -475,5 +477,169 @@ TEST(CorpusToIR, FailureConditions) {
 
 // TODO(sbenzaquen): Add tests for failing conditions in the IR->Corpus conversion.
 
+template <typename T>
+std::string WriteCorpus(const T& value) {
+  std::string out;
+  IRObjectWriter writer(out);
+  writer.WriteCorpus(value);
+  return out;
+}
+
+TEST(IRObjectWriter, WritesSameBytesAsIRObject) {
+  const auto expect_same_bytes = [](const auto& v) {
+    EXPECT_EQ(WriteCorpus(v), IRObject::FromCorpus(v).ToString());
+  };
+  expect_same_bytes(std::true_type{});
+  expect_same_bytes('a');
+  expect_same_bytes(true);
+  expect_same_bytes(-1);
+  expect_same_bytes(1.5f);
+  expect_same_bytes(std::string("ABC"));
+  expect_same_bytes(absl::uint128(12345));
+  expect_same_bytes(std::vector<uint8_t>{1, 2, 3});
+  expect_same_bytes(std::vector<bool>{true, false, true});
+  expect_same_bytes(std::vector<int>{});
+  expect_same_bytes(std::vector{std::tuple(1, std::string("A"), 1.4)});
+  expect_same_bytes(std::array<int, 3>{0, 2, 4});
+  expect_same_bytes(std::variant<int, std::string>("ABC"));
+  expect_same_bytes(std::map<int, int>{{1, 2}, {3, 4}});
+  TestProtobuf proto;
+  proto.set_b(true);
+  expect_same_bytes(proto);
+  IRObject obj(1979);
+  obj.MutableSubs().emplace_back("ABC");
+  expect_same_bytes(obj);
+}
+
+TEST(IRObjectWriter, ObjectsCanBeWrittenSubBySub) {
+  std::string out;
+  IRObjectWriter writer(out);
+  writer.BeginObject(3);
+  writer.WriteUInt64(1);
+  writer.WriteString("ABC");
+  writer.WriteEmpty();
+  EXPECT_EQ(out, IRObject::FromCorpus(std::tuple(1, std::string("ABC"),
+                                                 std::monostate{}))
+                     .ToString());
+}
+
+TEST(IRObjectView, ValidRoundTrips) {
+  const auto round_trip = [](auto v) -> std::optional<decltype(v)> {
+    const std::string str = WriteCorpus(v);
+    std::optional<IRObjectView> view = IRObjectView::FromString(str);
+    if (!view) return std::nullopt;
+    return view->template ToCorpus<decltype(v)>();
+  };
+
+  EXPECT_THAT(round_trip(std::true_type{}), Optional(std::true_type{}));
+  EXPECT_THAT(round_trip('a'), Optional('a'));
+  EXPECT_THAT(round_trip(-1), Optional(-1));
+  EXPECT_THAT(round_trip(1.5f), Optional(1.5f));
+  EXPECT_THAT(round_trip(std::string("ABC")), Optional(std::string("ABC")));
+  enum class E { kEnum };
+  EXPECT_THAT(round_trip(E::kEnum), Optional(E::kEnum));
+  EXPECT_THAT(round_trip(absl::int128(-12345)), Optional(absl::int128(-12345)));
+  EXPECT_THAT(round_trip(std::vector<uint8_t>{1, 2, 3}),
+              Optional(ElementsAre(1, 2, 3)));
+  EXPECT_THAT(round_trip(std::vector<bool>{true, false, true, true}),
+              Optional(ElementsAre(true, false, true, true)));
+  EXPECT_THAT(round_trip(std::vector<int>{}), Optional(ElementsAre()));
+  EXPECT_THAT(round_trip(std::vector{std::string("A"), std::string("B")}),
+              Optional(ElementsAre("A", "B")));
+  EXPECT_THAT(round_trip(std::tuple(1, std::string("A"), 1.4)),
+              Optional(FieldsAre(1, "A", 1.4)));
+  EXPECT_THAT(round_trip(std::vector{std::tuple(1, 2), std::tuple(3, 4)}),
+              Optional(ElementsAre(FieldsAre(1, 2), FieldsAre(3, 4))));
+  EXPECT_THAT(round_trip(std::variant<int, std::string>("ABC")),
+              Optional(VariantWith<std::string>("ABC")));
+  EXPECT_THAT(round_trip(std::map<int, int>{{1, 2}, {3, 4}}),
+              Optional(ElementsAre(Pair(1, 2), Pair(3, 4))));
+
+  TestProtobuf proto;
+  proto.set_b(true);
+  const std::optional<TestProtobuf> round_trip_proto = round_trip(proto);
+  EXPECT_TRUE(
+      round_trip_proto.has_value() &&
+      google::protobuf::util::MessageDifferencer::Equals(*round_trip_proto, proto));
+
+  IRObject obj(1979);
+  obj.MutableSubs().emplace_back("ABC");
+  EXPECT_THAT(
+      round_trip(obj).value().Subs(),
+      Optional(ElementsAre(FieldsAre(VariantWith<std::string>("ABC")))));
+}
+
+TEST(IRObjectView, SubsAccessors) {
+  const std::string str = WriteCorpus(
+      std::tuple(std::vector<int>{1, 2}, std::string("ABC"), 1.5));
+  std::optional<IRObjectView> view = IRObjectView::FromString(str);
+  ASSERT_TRUE(view.has_value());
+  EXPECT_FALSE(view->GetScalar<int>().has_value());
+  auto subs = view->Subs();
+  ASSERT_TRUE(subs.has_value());
+  ASSERT_EQ(subs->size(), 3);
+  auto it = subs->begin();
+  EXPECT_THAT(it->ToCorpus<std::vector<int>>(), Optional(ElementsAre(1, 2)));
+  ++it;
+  EXPECT_THAT(it->GetScalar<std::string>(), Optional(absl::string_view("ABC")));
+  ++it;
+  EXPECT_THAT(it->GetScalar<double>(), Optional(1.5));
+  EXPECT_FALSE(it->Subs().has_value());
+  ++it;
+  EXPECT_EQ(it, subs->end());
+}
+
+TEST(IRObjectView, RejectsInvalidInputs) {
+  const std::string str = WriteCorpus(std::tuple(1, std::string("ABC")));
+  EXPECT_TRUE(IRObjectView::FromString(str).has_value());
+  // Truncated.
+  EXPECT_FALSE(
+      IRObjectView::FromString(absl::string_view(str).substr(0, str.size() - 1))
+          .has_value());
+  // Trailing data.
+  EXPECT_FALSE(IRObjectView::FromString(str + "X").has_value());
+  // Text format.
+  EXPECT_FALSE(
+      IRObjectView::FromString(
+          IRObject::FromCorpus(1).ToString(/*binary_format=*/false))
+          .has_value());
+  // Too deep.
+  EXPECT_FALSE(IRObjectView::FromString(CreateRecursiveObject(/*depth=*/150)
+                                            .ToString(/*binary_format=*/true))
+                   .has_value());
+  EXPECT_TRUE(IRObjectView::FromString(CreateRecursiveObject(/*depth=*/100)
+                                           .ToString(/*binary_format=*/true))
+                  .has_value());
+  // Malformed object size.
+  static constexpr char kBadInput[] =
+      "FUZZTESTv1b\x04\xff\xff\xff\xff\xff\xff\xff\xff\x00";
+  EXPECT_FALSE(
+      IRObjectView::FromString({kBadInput, sizeof(kBadInput) - 1}).has_value());
+}
+
+TEST(IRObjectView, FailureConditions) {
+  const auto view_to_corpus = [](const auto& v, auto type) {
+    const std::string str = IRObject::FromCorpus(v).ToString();
+    return IRObjectView::FromString(str)
+        .value()
+        .template ToCorpus<decltype(type)>();
+  };
+  EXPECT_FALSE(view_to_corpus(1, std::true_type{}));
+  EXPECT_FALSE(view_to_corpus(std::string("ABC"), int{}));
+  // Invalid variant index.
+  EXPECT_FALSE(view_to_corpus(std::tuple(2, 1),
+                              std::variant<int, std::string>{}));
+  // Bad variant value.
+  EXPECT_FALSE(view_to_corpus(std::tuple(1, 1),
+                              std::variant<int, std::string>{}));
+  EXPECT_FALSE(view_to_corpus(1, std::vector<int>{}));
+  EXPECT_FALSE(view_to_corpus(std::tuple(1, std::string("ABC")),
+                              std::vector<int>{}));
+  EXPECT_FALSE(view_to_corpus(std::tuple(1, 2, 3),
+                              std::tuple<int, int>{}));
+  EXPECT_FALSE(view_to_corpus(std::tuple(std::string("A"), std::string("B")),
+                              std::tuple<int, std::string>{}));
+}
+
 }  // namespace
 }  // namespace fuzztest::internal